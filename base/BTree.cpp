@@ -1,226 +1,427 @@
 #include "BTree.h"
+#include "manager/dbManager.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+namespace {
+    // 头页：魔数 + 键类型 + 根页号 + 条目数 + 键宽度
+    const char INDEX_MAGIC[8] = { 'B', 'P', 'T', 'I', 'D', 'X', '0', '1' };
+
+    struct IndexHeader {
+        char magic[8];
+        int32_t key_type;
+        uint32_t root;
+        uint64_t count;
+        uint32_t key_width;
+        uint32_t reserved;
+    };
+
+    // 条目中键数据之前的类型、保留、长度字段
+    const size_t KEY_PREFIX = 4;
+
+    // BPT2 格式中的字段值：类型 1 字节 + 数据
+    bool readValue(std::ifstream& in, Value& v) {
+        uint8_t type = 0;
+        if (!in.read(reinterpret_cast<char*>(&type), sizeof(uint8_t))) return false;
+        switch (static_cast<ValueType>(type)) {
+        case ValueType::INT: { int32_t i; in.read(reinterpret_cast<char*>(&i), sizeof(int32_t)); v = Value::fromInt(i); break; }
+        case ValueType::DOUBLE: { double d; in.read(reinterpret_cast<char*>(&d), sizeof(double)); v = Value::fromDouble(d); break; }
+        case ValueType::BOOL: { char b; in.read(&b, sizeof(char)); v = Value::fromBool(b == 1); break; }
+        case ValueType::DATETIME: { int64_t t; in.read(reinterpret_cast<char*>(&t), sizeof(int64_t)); v = Value::fromTime(static_cast<std::time_t>(t)); break; }
+        case ValueType::STRING: {
+            uint32_t len = 0;
+            in.read(reinterpret_cast<char*>(&len), sizeof(uint32_t));
+            std::string s(len, '\0');
+            in.read(&s[0], len);
+            v = Value::fromString(std::move(s));
+            break;
+        }
+        default: v = Value::null(); break;
+        }
+        return static_cast<bool>(in);
+    }
+}
 
 // B树构造
-BTree::BTree(const IndexBlock* indexBlock) : m_index(indexBlock) {
-    root = new BTreeNode(true, nullptr);  // 根节点是叶子节点，父节点为nullptr
+BTree::BTree(const IndexBlock* indexBlock, int keyType, int keyParam)
+    : m_keyType(keyType), m_index(indexBlock), m_file(indexBlock->index_file) {
+    switch (keyType) {
+    case 1: m_keyWidth = sizeof(int32_t); break;
+    case 2: m_keyWidth = sizeof(double); break;
+    case 4: m_keyWidth = sizeof(char); break;
+    case 5: m_keyWidth = sizeof(int64_t); break;
+    case 3: m_keyWidth = keyParam > 0 ? static_cast<size_t>(keyParam) + 2 : 32; break;  // 含引号
+    default: m_keyWidth = 256; break;                                                   // 组合索引
+    }
+    // 数值键在 INT 字段上也可能以 DOUBLE 保存，至少留 8 字节
+    m_keyWidth = std::max<size_t>(m_keyWidth, sizeof(double));
+    m_entrySize = KEY_PREFIX + m_keyWidth + sizeof(uint64_t) + sizeof(uint32_t);
+    degree = static_cast<int>((NODE_SIZE - sizeof(NodeHeader)) / m_entrySize);
+    if (degree < 3) {
+        throw std::runtime_error("索引键过长，无法放入索引页: " + std::string(indexBlock->name));
+    }
 }
 
-// B树析构
+// 节点页都在缓冲池中，由缓冲池负责写回
 BTree::~BTree() {
-    deleteNodes(root);
-
-    //table中方法已删
-    //std::string filename = m_index->index_file;
-    //if (filename.empty()) {
-    //    std::cerr << "文件名为空，无法删除。" << std::endl;
-    //    return;
-    //}
-
-    //if (std::remove(filename.c_str()) == 0) {
-    //    std::cout << "索引数据文件 " << filename << " 删除成功。" << std::endl;
-    //}
-    //else {
-    //    std::perror(("索引数据文件 " + filename + " 删除失败。").c_str());
-    //}
 }
 
+int BTree::compare(const FieldPointer& a, const FieldPointer& b) {
+    int c = Value::compare(a.fieldValue, b.fieldValue);
+    if (c != 0) return c;
+    if (a.recordPtr.row_id == b.recordPtr.row_id) return 0;
+    return a.recordPtr.row_id < b.recordPtr.row_id ? -1 : 1;
+}
 
-// 删除所有节点
-void BTree::deleteNodes(BTreeNode* node) {
-    if (!node) return;
-    for (auto* child : node->children) {
-        deleteNodes(child);
+Value BTree::makeKey(const std::string& fieldValue) const {
+    std::string upper = fieldValue;
+    for (char& c : upper) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    if (upper == "NULL") return Value::null();
+
+    const char* begin = fieldValue.c_str();
+    char* end = nullptr;
+    switch (m_keyType) {
+    case 1: {
+        long long v = std::strtoll(begin, &end, 10);
+        if (end != begin && *end == '\0') return Value::fromInt(static_cast<int32_t>(v));
+        double d = std::strtod(begin, &end);
+        if (end != begin && *end == '\0') return Value::fromDouble(d);
+        break;
     }
-    delete node;
+    case 2: {
+        double d = std::strtod(begin, &end);
+        if (end != begin && *end == '\0') return Value::fromDouble(d);
+        break;
+    }
+    case 4:
+        if (upper == "TRUE" || upper == "FALSE") return Value::fromBool(upper == "TRUE");
+        break;
+    case 5: {
+        std::time_t t;
+        if (parse_datetime(fieldValue, t)) return Value::fromTime(t);
+        break;
+    }
+    default:
+        break;
+    }
+    return Value::fromString(fieldValue);
 }
 
-// 插入字段
-void BTree::insert(const std::string& fieldValue, const RecordPointer& recordPtr) {
-    BTreeNode* r = root;
-    if (r->fields.size() == degree - 1) {
-        BTreeNode* newRoot = new BTreeNode(false, nullptr);
-        newRoot->children.push_back(r);
-        splitChild(newRoot, 0);
-        root = newRoot;
+// 索引页与记录页共用当前数据库的缓冲池；第一次访问时才取，打开数据库时表还没有成为当前数据库
+BufferPool& BTree::pool() {
+    if (!m_pool) {
+        m_pool = &dbManager::getInstance().get_current_database()->getBufferPool();
     }
-
-    FieldPointer fp{ fieldValue, recordPtr };
-    insertNonFull(root, fp);
+    return *m_pool;
 }
 
-#include <QDebug>  // 引入 QDebug
+void BTree::open() {
+    if (m_opened) return;
 
-// 向非满节点插入
-void BTree::insertNonFull(BTreeNode* node, const FieldPointer& fieldPtr) {
-    int i = node->fields.size() - 1;
-
-    // 打印进入 insertNonFull 函数的调试信息
-    qDebug() << "Entering insertNonFull: Node isLeaf=" << node->isLeaf << ", Fields size=" << node->fields.size();
+    BufferPool& bp = pool();
+    IndexHeader h = {};
+    if (bp.fileSize(m_file) >= NODE_SIZE) {
+        bp.read(m_file, 0, reinterpret_cast<char*>(&h), sizeof(h));
+    }
+    if (std::memcmp(h.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0) {
+        if (h.key_width != m_keyWidth) {
+            throw std::runtime_error("索引文件与字段定义不一致: " + std::string(m_index->name));
+        }
+        m_root = h.root;
+        m_size = h.count;
+        m_opened = true;
+        return;
+    }
 
-    // 如果是叶子节点
-    if (node->isLeaf) {
-        qDebug() << "Node is a leaf. Starting search for insert position...";
+    // 新文件或旧格式：读出已有条目后按页重建
+    std::vector<FieldPointer> entries;
+    if (bp.fileSize(m_file) > 0 && !readLegacyEntries(entries)) {
+        throw std::runtime_error("索引文件格式错误！");
+    }
+    std::sort(entries.begin(), entries.end(),
+        [](const FieldPointer& a, const FieldPointer& b) { return compare(a, b) < 0; });
+    size_t pos = 0;
+    bulkLoad([&](FieldPointer& fp) {
+        if (pos == entries.size()) return false;
+        fp = std::move(entries[pos++]);
+        return true;
+        });
+}
 
-        while (i >= 0 && node->fields[i].fieldValue > fieldPtr.fieldValue) {
-       //     qDebug() << "Comparing fieldValue: " << node->fields[i].fieldValue << " > " << fieldPtr.fieldValue;
-            i--;
-        }
+void BTree::writeHeader() {
+    IndexHeader h = {};
+    std::memcpy(h.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    h.key_type = m_keyType;
+    h.root = m_root;
+    h.count = m_size;
+    h.key_width = static_cast<uint32_t>(m_keyWidth);
+    pool().write(m_file, 0, reinterpret_cast<const char*>(&h), sizeof(h));
+}
 
-        // 断言调试
-        assert(node != nullptr);
-        assert(i + 1 >= 0 && i + 1 <= node->fields.size());
+// 在文件末尾追加一个空节点页，返回页号
+uint32_t BTree::allocatePage(bool isLeaf) {
+    char page[NODE_SIZE] = {};
+    header(page)->is_leaf = isLeaf ? 1 : 0;
+    uint64_t offset = pool().append(m_file, page, NODE_SIZE);
+    return static_cast<uint32_t>(offset / NODE_SIZE);
+}
 
-        // 插入到 fields 中
-        //qDebug() << "Inserting field at index " << i + 1 << ": " << fieldPtr.fieldValue;
-        node->fields.insert(node->fields.begin() + i + 1, fieldPtr);
+char* BTree::entryAt(char* data, size_t index) const {
+    return data + sizeof(NodeHeader) + index * m_entrySize;
+}
 
-        // 输出插入后的节点信息
-        qDebug() << "After insertion, fields size: " << node->fields.size();
-        for (const auto& field : node->fields) {
-           // qDebug() << "Field: " << field.fieldValue;
+void BTree::writeEntry(char* slot, const FieldPointer& fieldPtr, uint32_t child) const {
+    const Value& v = fieldPtr.fieldValue;
+    char* key = slot + KEY_PREFIX;
+    uint16_t len = 0;
+    switch (v.type) {
+    case ValueType::INT: len = sizeof(int32_t); std::memcpy(key, &v.i, len); break;
+    case ValueType::DOUBLE: len = sizeof(double); std::memcpy(key, &v.d, len); break;
+    case ValueType::BOOL: len = 1; key[0] = v.b ? 1 : 0; break;
+    case ValueType::DATETIME: { int64_t t = static_cast<int64_t>(v.t); len = sizeof(int64_t); std::memcpy(key, &t, len); break; }
+    case ValueType::STRING:
+        if (v.s.size() > m_keyWidth) {
+            throw std::runtime_error("索引键长度超过索引定义: " + v.s);
         }
+        len = static_cast<uint16_t>(v.s.size());
+        std::memcpy(key, v.s.data(), len);
+        break;
+    default: break;
     }
-    else {
-        // 如果是非叶子节点，进入递归处理子节点
-        qDebug() << "Node is not a leaf. Searching for correct child to insert into...";
+    slot[0] = static_cast<char>(v.type);
+    slot[1] = 0;
+    std::memcpy(slot + 2, &len, sizeof(uint16_t));
 
-        while (i >= 0 && node->fields[i].fieldValue > fieldPtr.fieldValue) {
-           // qDebug() << "Comparing fieldValue: " << node->fields[i].fieldValue << " > " << fieldPtr.fieldValue;
-            i--;
-        }
-
-        i++; // 移动到正确的子节点位置
+    uint64_t row_id = fieldPtr.recordPtr.row_id;
+    std::memcpy(slot + KEY_PREFIX + m_keyWidth, &row_id, sizeof(uint64_t));
+    std::memcpy(slot + KEY_PREFIX + m_keyWidth + sizeof(uint64_t), &child, sizeof(uint32_t));
+}
 
-        qDebug() << "Correct child index for insertion: " << i;
+FieldPointer BTree::readEntry(const char* slot) const {
+    FieldPointer fp;
+    const char* key = slot + KEY_PREFIX;
+    uint16_t len;
+    std::memcpy(&len, slot + 2, sizeof(uint16_t));
+    switch (static_cast<ValueType>(slot[0])) {
+    case ValueType::INT: { int32_t i; std::memcpy(&i, key, sizeof(i)); fp.fieldValue = Value::fromInt(i); break; }
+    case ValueType::DOUBLE: { double d; std::memcpy(&d, key, sizeof(d)); fp.fieldValue = Value::fromDouble(d); break; }
+    case ValueType::BOOL: fp.fieldValue = Value::fromBool(key[0] == 1); break;
+    case ValueType::DATETIME: { int64_t t; std::memcpy(&t, key, sizeof(t)); fp.fieldValue = Value::fromTime(static_cast<std::time_t>(t)); break; }
+    case ValueType::STRING: fp.fieldValue = Value::fromString(std::string(key, len)); break;
+    default: break;
+    }
+    std::memcpy(&fp.recordPtr.row_id, slot + KEY_PREFIX + m_keyWidth, sizeof(uint64_t));
+    return fp;
+}
 
-        // 检查子节点是否需要分裂
-        if (node->children[i]->fields.size() == degree - 1) {
-            qDebug() << "Child node " << i << " is full, splitting...";
-            splitChild(node, i);
+// 内部节点第 index 个子页：0 为最左子页，其余是第 index-1 个分隔键右侧的子页
+uint32_t BTree::childAt(char* data, size_t index) const {
+    if (index == 0) return header(data)->first_child;
+    uint32_t child;
+    std::memcpy(&child, entryAt(data, index - 1) + KEY_PREFIX + m_keyWidth + sizeof(uint64_t), sizeof(uint32_t));
+    return child;
+}
 
-            // 如果需要，更新 i
-            if (fieldPtr.fieldValue > node->fields[i].fieldValue) {
-                qDebug() << "Field value greater than split value, incrementing i.";
-                i++;
-            }
-        }
+// 二分查找，只解码被比较到的条目
+size_t BTree::upperBound(char* data, const FieldPointer& fieldPtr) const {
+    size_t lo = 0, hi = header(data)->count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (compare(readEntry(entryAt(data, mid)), fieldPtr) <= 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
 
-        // 递归调用插入子节点
-        qDebug() << "Inserting into child node at index " << i;
-        insertNonFull(node->children[i], fieldPtr);
+size_t BTree::lowerBound(char* data, const FieldPointer& fieldPtr) const {
+    size_t lo = 0, hi = header(data)->count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (compare(readEntry(entryAt(data, mid)), fieldPtr) < 0) lo = mid + 1;
+        else hi = mid;
     }
+    return lo;
 }
 
-// 分裂子节点
-void BTree::splitChild(BTreeNode* parent, int index) {
-    BTreeNode* fullNode = parent->children[index];
-    BTreeNode* newNode = new BTreeNode(fullNode->isLeaf, nullptr);
+void BTree::insertEntry(char* data, size_t pos, const FieldPointer& fieldPtr, uint32_t child) const {
+    NodeHeader* h = header(data);
+    std::memmove(entryAt(data, pos + 1), entryAt(data, pos), (h->count - pos) * m_entrySize);
+    writeEntry(entryAt(data, pos), fieldPtr, child);
+    h->count++;
+}
 
-    int mid = degree / 2;
-    parent->fields.insert(parent->fields.begin() + index, fullNode->fields[mid]);
-    parent->children.insert(parent->children.begin() + index + 1, newNode);
+// 插入字段
+void BTree::insert(const std::string& fieldValue, const RecordPointer& recordPtr) {
+    insert(FieldPointer{ makeKey(fieldValue), recordPtr });
+}
 
-    for (int i = mid + 1; i < fullNode->fields.size(); ++i) {
-        newNode->fields.push_back(fullNode->fields[i]);
+void BTree::insert(const FieldPointer& fp) {
+    open();
+    FieldPointer separator;
+    uint32_t right = 0;
+    if (insertInto(m_root, fp, separator, right)) {
+        // 根节点分裂，树长高一层
+        uint32_t newRoot = allocatePage(false);
+        BufferPool::Page* page = pool().fetchPage(m_file, newRoot);
+        header(page->data)->first_child = m_root;
+        insertEntry(page->data, 0, separator, right);
+        pool().unpinPage(page, true);
+        m_root = newRoot;
     }
-    fullNode->fields.resize(mid);
+    ++m_size;
+    ++m_changes;
+    writeHeader();
+}
 
-    if (!fullNode->isLeaf) {
-        for (int i = mid + 1; i < fullNode->children.size(); ++i) {
-            newNode->children.push_back(fullNode->children[i]);
+bool BTree::insertInto(uint32_t page_no, const FieldPointer& fieldPtr, FieldPointer& separator, uint32_t& right) {
+    BufferPool& bp = pool();
+    BufferPool::Page* page = bp.fetchPage(m_file, page_no);
+    NodeHeader* h = header(page->data);
+
+    if (h->is_leaf) {
+        // 页已满时先分裂，再插入到对应的一半
+        bool split = false;
+        char* target = page->data;
+        BufferPool::Page* rightPage = nullptr;
+        if (h->count >= static_cast<size_t>(degree)) {
+            right = splitLeaf(page, separator);
+            split = true;
+            if (compare(fieldPtr, separator) >= 0) {
+                rightPage = bp.fetchPage(m_file, right);
+                target = rightPage->data;
+            }
         }
-        fullNode->children.resize(mid + 1);
+        insertEntry(target, upperBound(target, fieldPtr), fieldPtr, 0);
+        if (rightPage) bp.unpinPage(rightPage, true);
+        bp.unpinPage(page, true);
+        return split;
     }
-}
 
-// 扁平化序列化节点
-void BTree::serializeNode(BTreeNode* node, std::vector<BTreeNode*>& nodes) const {
-    if (!node) return;
-    nodes.push_back(node);
-    for (auto* child : node->children) {
-        serializeNode(child, nodes);
+    size_t idx = upperBound(page->data, fieldPtr);
+    FieldPointer childSeparator;
+    uint32_t childRight = 0;
+    if (!insertInto(childAt(page->data, idx), fieldPtr, childSeparator, childRight)) {
+        bp.unpinPage(page, false);
+        return false;
     }
-}
 
-void BTree::saveBTreeIndex() const {
-    std::ofstream out(m_index->index_file, std::ios::binary);
-    if (!out.is_open()) {
-        throw std::runtime_error("无法保存索引文件！");
+    // 子节点分裂：新的分隔键和右子页插入到本节点
+    bool split = false;
+    if (h->count >= static_cast<size_t>(degree)) {
+        right = splitInner(page, separator);
+        split = true;
+        if (compare(childSeparator, separator) > 0) {
+            BufferPool::Page* rightPage = bp.fetchPage(m_file, right);
+            insertEntry(rightPage->data, upperBound(rightPage->data, childSeparator), childSeparator, childRight);
+            bp.unpinPage(rightPage, true);
+            bp.unpinPage(page, true);
+            return split;
+        }
+        idx = upperBound(page->data, childSeparator);
     }
+    insertEntry(page->data, idx, childSeparator, childRight);
+    bp.unpinPage(page, true);
+    return split;
+}
 
-    std::vector<BTreeNode*> nodes;
-    serializeNode(root, nodes);
-
-    size_t total = nodes.size();
-    out.write(reinterpret_cast<const char*>(&total), sizeof(size_t));
-
-    for (auto* node : nodes) {
-        size_t n = node->fields.size();
-        out.write(reinterpret_cast<const char*>(&n), sizeof(size_t));
-        for (auto& fp : node->fields) {
-            size_t len = fp.fieldValue.size();
-            out.write(reinterpret_cast<const char*>(&len), sizeof(size_t));
-            out.write(fp.fieldValue.data(), len);
+// 叶子分裂：后一半移到新叶子，新叶子的第一个条目作为分隔键
+uint32_t BTree::splitLeaf(BufferPool::Page* page, FieldPointer& separator) {
+    NodeHeader* h = header(page->data);
+    size_t n = h->count;
+    size_t mid = n / 2;
+
+    uint32_t right = allocatePage(true);
+    BufferPool::Page* rightPage = pool().fetchPage(m_file, right);
+    NodeHeader* rh = header(rightPage->data);
+    std::memcpy(entryAt(rightPage->data, 0), entryAt(page->data, mid), (n - mid) * m_entrySize);
+    rh->count = static_cast<uint16_t>(n - mid);
+    rh->next = h->next;
+    h->next = right;
+    h->count = static_cast<uint16_t>(mid);
+    separator = readEntry(entryAt(rightPage->data, 0));
+    pool().unpinPage(rightPage, true);
+    return right;
+}
 
-            // 👇 写入 row_id
-            uint64_t row_id = fp.recordPtr.row_id;
-            out.write(reinterpret_cast<const char*>(&row_id), sizeof(uint64_t));
-        }
-        size_t childCount = node->children.size();
-        out.write(reinterpret_cast<const char*>(&childCount), sizeof(size_t));
-    }
+// 内部节点分裂：中间的分隔键上推，它的右子页成为新节点的最左子页
+uint32_t BTree::splitInner(BufferPool::Page* page, FieldPointer& separator) {
+    NodeHeader* h = header(page->data);
+    size_t n = h->count;
+    size_t mid = n / 2;
+
+    uint32_t right = allocatePage(false);
+    BufferPool::Page* rightPage = pool().fetchPage(m_file, right);
+    NodeHeader* rh = header(rightPage->data);
+    separator = readEntry(entryAt(page->data, mid));
+    rh->first_child = childAt(page->data, mid + 1);
+    std::memcpy(entryAt(rightPage->data, 0), entryAt(page->data, mid + 1), (n - mid - 1) * m_entrySize);
+    rh->count = static_cast<uint16_t>(n - mid - 1);
+    h->count = static_cast<uint16_t>(mid);
+    pool().unpinPage(rightPage, true);
+    return right;
+}
 
-    out.close();
+void BTree::saveBTreeIndex() {
+    if (!m_opened) return;
+    pool().flushFile(m_file);
 }
 
 
 void BTree::loadBTreeIndex() {
-    std::ifstream in(m_index->index_file, std::ios::binary);
+    std::ifstream in(m_file, std::ios::binary);
     if (!in.is_open()) {
         throw std::runtime_error("无法打开索引文件！");
     }
+    in.close();
+    m_opened = false;
+}
 
-    deleteNodes(root);
-    root = new BTreeNode(true, nullptr);  // 设置根节点为叶子节点，父节点为空
+// 读取旧版索引文件中的全部条目：BPT2 顺序格式或更早的节点格式
+bool BTree::readLegacyEntries(std::vector<FieldPointer>& entries) {
+    std::ifstream in(m_file, std::ios::binary);
+    if (!in.is_open()) return false;
+
+    char magic[4] = {};
+    in.read(magic, sizeof(magic));
+    if (in && std::memcmp(magic, "BPT2", sizeof(magic)) == 0) {
+        int32_t keyType = 0;
+        uint64_t total = 0;
+        in.read(reinterpret_cast<char*>(&keyType), sizeof(int32_t));
+        in.read(reinterpret_cast<char*>(&total), sizeof(uint64_t));
+        entries.reserve(total);
+        for (uint64_t i = 0; i < total; ++i) {
+            FieldPointer fp;
+            if (!readValue(in, fp.fieldValue)) break;
+            in.read(reinterpret_cast<char*>(&fp.recordPtr.row_id), sizeof(uint64_t));
+            entries.push_back(std::move(fp));
+        }
+        return true;
+    }
 
-    size_t total;
-    in.read(reinterpret_cast<char*>(&total), sizeof(size_t));
-    std::vector<BTreeNode*> nodes(total);
+    // 节点格式：节点数，然后每个节点依次为 条目数、(长度, 字段值, row_id)...、子节点数
+    in.clear();
+    in.seekg(0);
+    size_t total = 0;
+    if (!in.read(reinterpret_cast<char*>(&total), sizeof(size_t))) return true;
 
-    // 加载所有节点
     for (size_t i = 0; i < total; ++i) {
-        nodes[i] = new BTreeNode(true, nullptr);  // 默认为叶子节点，父节点为空
         size_t n;
-        in.read(reinterpret_cast<char*>(&n), sizeof(size_t));
-
+        if (!in.read(reinterpret_cast<char*>(&n), sizeof(size_t))) return false;
         for (size_t j = 0; j < n; ++j) {
             size_t len;
             in.read(reinterpret_cast<char*>(&len), sizeof(size_t));
             std::string field(len, '\0');
             in.read(&field[0], len);
-
             uint64_t row_id;
             in.read(reinterpret_cast<char*>(&row_id), sizeof(uint64_t));
-            nodes[i]->fields.push_back({ field, { row_id } });
-
+            if (!in) return false;
+            // 旧节点预填充了空条目，跳过
+            if (field.empty() && row_id == 0) continue;
+            entries.push_back({ makeKey(field), { row_id } });
         }
-
         size_t childCount;
         in.read(reinterpret_cast<char*>(&childCount), sizeof(size_t));
-        nodes[i]->children.resize(childCount);
     }
-
-    // 恢复父子关系
-    for (size_t i = 0; i < total; ++i) {
-        if (!nodes[i]->isLeaf) {
-            for (size_t j = 0; j < nodes[i]->children.size(); ++j) {
-                nodes[i]->children[j]->parent = nodes[i];  // 设置子节点的父节点
-            }
-        }
-    }
-
-    // 设置根节点
-    root = nodes[0];
-
-    in.close();
+    return true;
 }
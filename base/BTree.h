@@ -9,12 +9,16 @@
 #include <fstream>
 #include <cstdio>
 #include <cassert>
+#include <functional>
+#include <memory>
 
 
 #include "base/block/indexBlock.h"
 #include "base/block/fieldBlock.h"
 #include "base/block/constraintBlock.h"
 #include "base/block/tableBlock.h"
+#include "base/record/row.h"
+#include "base/storage/bufferPool.h"
 
 
 // 指向磁盘中记录的位置
@@ -24,69 +28,166 @@ struct RecordPointer {
 
 
 // 字段值 + 记录指针
+// 树中按 (字段值, row_id) 排序，相同字段值的多条记录各占一个条目，非唯一索引不会丢行
 struct FieldPointer {
-    std::string fieldValue;  // 索引字段的值
+    Value fieldValue;        // 索引字段的值（按字段类型保存）
     RecordPointer recordPtr; // 指向磁盘记录的位置
 };
 
-class BTreeNode {
+// 建索引时对 (键, row_id) 排序：
+// 条目先在内存中累积，超出内存预算时多线程排序后作为一个有序段写入临时文件，
+// 全部加入后对各段多路归并，按顺序逐个取出
+class IndexEntrySorter {
 public:
-    bool isLeaf;
-    std::vector<FieldPointer> fields;
-
-    std::vector<BTreeNode*> children;
-    BTreeNode* parent;  // 新增的父节点指针  
-
-    // B树节点构造  
-    BTreeNode(bool isLeaf, BTreeNode* parent) : isLeaf(isLeaf), parent(parent), fields(3) {
-        for (auto& field : fields) {
-            field.fieldValue = "";
-            field.recordPtr = { 0 };
-        }
-    }
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = 64 * 1024 * 1024;
+
+    // tempPrefix：临时段文件的路径前缀；threads 为 0 时按 CPU 核数
+    explicit IndexEntrySorter(const std::string& tempPrefix,
+        size_t memoryBudget = DEFAULT_MEMORY_BUDGET, unsigned threads = 0);
+    ~IndexEntrySorter();
+
+    IndexEntrySorter(const IndexEntrySorter&) = delete;
+    IndexEntrySorter& operator=(const IndexEntrySorter&) = delete;
+
+    void add(FieldPointer fieldPtr);
+    // 第一次调用时完成排序，之后按顺序返回条目，取完返回 false
+    bool next(FieldPointer& fieldPtr);
+
+    size_t runCount() const { return m_runs.size(); }
+
+private:
+    struct RunReader;
+
+    void sortBuffer();
+    void spill();
+
+    std::string m_prefix;
+    size_t m_budget;
+    unsigned m_threads;
+    size_t m_bytes = 0;                     // 内存中条目的估计大小
+    std::vector<FieldPointer> m_buffer;
+    size_t m_pos = 0;                       // 没有溢出时直接从 m_buffer 读取
+    bool m_finished = false;
+    std::vector<std::string> m_runs;        // 已写出的段文件
+    std::vector<std::unique_ptr<RunReader>> m_readers;
+    std::vector<size_t> m_heap;             // 归并用的小顶堆，元素为 m_readers 下标
+};
+
+// 索引统计信息，访问路径选择时用来估计条件的选择率
+struct IndexStats {
+    uint64_t entries = 0;           // 条目数（含 NULL）
+    uint64_t nulls = 0;             // NULL 键的条目数
+    uint64_t distinct = 0;          // 不同的非 NULL 键数
+    Value min, max;                 // 非 NULL 键的最小、最大值
+    std::vector<Value> histogram;   // 等深直方图：各桶的上界，每桶条目数大致相同
+    uint32_t height = 1;            // 树高（叶子为第 1 层）
 };
+
+// 存放在索引文件中的 B+ 树：
+// 第 0 页为头页（根页号、条目数），其余每页一个节点，节点内是定长条目，
+// 所有页都经过数据库的缓冲池读写，只有被修改的节点页会在刷盘时写回
 class BTree {
+public:
+    // 一个节点占一页
+    static constexpr size_t NODE_SIZE = BufferPool::PAGE_SIZE;
+    static constexpr size_t HISTOGRAM_BUCKETS = 32;
+
 private:
-    int degree = 3;        // B树的度
-    BTreeNode* root;
+    int degree;            // 节点最多保存的条目数，由键宽度和 NODE_SIZE 决定
+    int m_keyType;         // 索引字段的类型代码，决定键的比较方式；组合索引按文本比较
+    size_t m_keyWidth;     // 键的最大字节数
+    size_t m_entrySize;    // 节点中每个条目占用的字节数
     const IndexBlock* m_index;
-
-    void splitChild(BTreeNode* parent, int index);
-    void insertNonFull(BTreeNode* node, const FieldPointer& fieldPtr);
-    void serializeNode(BTreeNode* node, std::vector<BTreeNode*>& nodes) const;
-    void deleteNodes(BTreeNode* node);
-
-    FieldPointer* findInNode(BTreeNode* node, const std::string& fieldValue);
-    void findRangeInNode(BTreeNode* node, const std::string& low, const std::string& high, std::vector<FieldPointer>& result);
-
-    // 删除相关私有辅助函数
-    void removeFromNode(BTreeNode* node, const std::string& fieldValue);
-    void removeFromLeaf(BTreeNode* node, int idx);
-    void removeFromNonLeaf(BTreeNode* node, int idx);
-    std::string getPredecessor(BTreeNode* node, int idx);
-    std::string getSuccessor(BTreeNode* node, int idx);
-    void fill(BTreeNode* node, int idx);
-    void borrowFromPrev(BTreeNode* node, int idx);
-    void borrowFromNext(BTreeNode* node, int idx);
-    void merge(BTreeNode* node, int idx);
+    std::string m_file;    // 索引文件路径
+
+    // 头页内容，第一次访问索引时才读取
+    bool m_opened = false;
+    uint32_t m_root = 0;
+    uint64_t m_size = 0;
+    BufferPool* m_pool = nullptr;
+
+    // 统计信息缓存，修改的条目数超过一定比例后重新收集
+    IndexStats m_stats;
+    bool m_statsValid = false;
+    uint64_t m_changes = 0;
+
+    // 节点页头，之后是 count 个定长条目：
+    // 键（类型 1 字节 + 保留 1 字节 + 长度 2 字节 + 键宽度字节）+ row_id 8 字节 + 右子页号 4 字节（仅内部节点使用）
+    struct NodeHeader {
+        uint8_t is_leaf;
+        uint8_t reserved;
+        uint16_t count;
+        uint32_t next;          // 叶子：右兄弟页号，0 表示没有
+        uint32_t first_child;   // 内部节点：最左子页号
+        uint32_t reserved2;
+    };
+    static NodeHeader* header(char* data) { return reinterpret_cast<NodeHeader*>(data); }
+
+    BufferPool& pool();
+    void open();
+    void writeHeader();
+    uint32_t allocatePage(bool isLeaf);
+
+    // 节点内条目的读写与查找
+    char* entryAt(char* data, size_t index) const;
+    void writeEntry(char* slot, const FieldPointer& fieldPtr, uint32_t child) const;
+    FieldPointer readEntry(const char* slot) const;
+    uint32_t childAt(char* data, size_t index) const;
+    size_t upperBound(char* data, const FieldPointer& fieldPtr) const;
+    size_t lowerBound(char* data, const FieldPointer& fieldPtr) const;
+    void insertEntry(char* data, size_t pos, const FieldPointer& fieldPtr, uint32_t child) const;
+
+    // 插入到以 page_no 为根的子树，节点分裂时返回 true，并给出新的右节点和上推的分隔键
+    bool insertInto(uint32_t page_no, const FieldPointer& fieldPtr, FieldPointer& separator, uint32_t& right);
+    uint32_t splitLeaf(BufferPool::Page* page, FieldPointer& separator);
+    uint32_t splitInner(BufferPool::Page* page, FieldPointer& separator);
+    // 找到第一个不小于 fieldPtr 的条目所在的叶子页
+    uint32_t findLeaf(const FieldPointer& fieldPtr);
+    uint32_t leftmostLeaf();
+    bool readLegacyEntries(std::vector<FieldPointer>& entries);
 
 public:
-    BTree(const IndexBlock* indexBlock);
+    BTree(const IndexBlock* indexBlock, int keyType = 3, int keyParam = 0);
     ~BTree();
 
-	BTreeNode* getRoot() const { return root; }
     //获取索引名
 	std::string getIndexName() const {
 		return m_index->name;
 	}
+    size_t size() { open(); return m_size; }
+    int getDegree() const { return degree; }
+
+    // 条目比较：先按字段值，再按 row_id
+    static int compare(const FieldPointer& a, const FieldPointer& b);
+    // 把 SQL 文本中的值按索引字段类型转换为键
+    Value makeKey(const std::string& fieldValue) const;
 
     void insert(const std::string& fieldValue, const RecordPointer& recordPtr);
+    void insert(const FieldPointer& fieldPtr);
+
+    // 等值查找，返回该值对应的全部记录
+    std::vector<FieldPointer> find(const std::string& fieldValue);
+    // 范围查找，low/high 为空表示该侧无界，沿叶子链表顺序扫描
+    void findRange(const std::string& low, const std::string& high, std::vector<FieldPointer>& result,
+        bool lowInclusive = true, bool highInclusive = true);
+
+    // 按 compare 顺序逐个叶子读取全部条目（NULL 键在最后）：firstLeaf 返回最左叶子的页号，
+    // readLeaf 把一个叶子的条目追加到 out 并返回右兄弟的页号，0 表示已到最后
+    uint32_t firstLeaf();
+    uint32_t readLeaf(uint32_t leaf, std::vector<FieldPointer>& out);
+
+    // 删除一个条目；非唯一索引需要 row_id 才能定位到具体记录
+    void remove(const std::string& fieldValue, const RecordPointer& recordPtr);
 
-    FieldPointer* find(const std::string& fieldValue);
-    void findRange(const std::string& low, const std::string& high, std::vector<FieldPointer>& result);
+    // 清空索引文件，用按 compare 顺序给出的条目自底向上写出叶子层和各内部层，
+    // 每个节点按约 90% 填充；next 返回 false 表示条目结束
+    void bulkLoad(const std::function<bool(FieldPointer&)>& next);
 
-    void remove(const std::string& fieldValue);  // 新增删除接口
+    // 沿叶子链表扫描一遍收集统计信息，结果缓存到索引被大量修改为止
+    const IndexStats& statistics();
 
-    void saveBTreeIndex() const;
+    // 把被修改过的节点页写回磁盘
+    void saveBTreeIndex();
+    // 只检查索引文件，节点在访问时才经缓冲池读入
     void loadBTreeIndex();
 };
@@ -0,0 +1,257 @@
+#include "BTree.h"
+#include <algorithm>
+#include <thread>
+
+namespace {
+    bool entryLess(const FieldPointer& a, const FieldPointer& b) {
+        return BTree::compare(a, b) < 0;
+    }
+
+    // 段文件中的条目：类型 1 字节 + 数据 + row_id
+    void writeRunEntry(std::ofstream& out, const FieldPointer& fp) {
+        const Value& v = fp.fieldValue;
+        uint8_t type = static_cast<uint8_t>(v.type);
+        out.write(reinterpret_cast<const char*>(&type), sizeof(uint8_t));
+        switch (v.type) {
+        case ValueType::INT: out.write(reinterpret_cast<const char*>(&v.i), sizeof(int32_t)); break;
+        case ValueType::DOUBLE: out.write(reinterpret_cast<const char*>(&v.d), sizeof(double)); break;
+        case ValueType::BOOL: { char b = v.b ? 1 : 0; out.write(&b, sizeof(char)); break; }
+        case ValueType::DATETIME: { int64_t t = static_cast<int64_t>(v.t); out.write(reinterpret_cast<const char*>(&t), sizeof(int64_t)); break; }
+        case ValueType::STRING: {
+            uint32_t len = static_cast<uint32_t>(v.s.size());
+            out.write(reinterpret_cast<const char*>(&len), sizeof(uint32_t));
+            out.write(v.s.data(), len);
+            break;
+        }
+        default: break;
+        }
+        out.write(reinterpret_cast<const char*>(&fp.recordPtr.row_id), sizeof(uint64_t));
+    }
+
+    bool readRunEntry(std::ifstream& in, FieldPointer& fp) {
+        uint8_t type = 0;
+        if (!in.read(reinterpret_cast<char*>(&type), sizeof(uint8_t))) return false;
+        Value& v = fp.fieldValue;
+        switch (static_cast<ValueType>(type)) {
+        case ValueType::INT: { int32_t i; in.read(reinterpret_cast<char*>(&i), sizeof(int32_t)); v = Value::fromInt(i); break; }
+        case ValueType::DOUBLE: { double d; in.read(reinterpret_cast<char*>(&d), sizeof(double)); v = Value::fromDouble(d); break; }
+        case ValueType::BOOL: { char b; in.read(&b, sizeof(char)); v = Value::fromBool(b == 1); break; }
+        case ValueType::DATETIME: { int64_t t; in.read(reinterpret_cast<char*>(&t), sizeof(int64_t)); v = Value::fromTime(static_cast<std::time_t>(t)); break; }
+        case ValueType::STRING: {
+            uint32_t len = 0;
+            in.read(reinterpret_cast<char*>(&len), sizeof(uint32_t));
+            std::string s(len, '\0');
+            in.read(&s[0], len);
+            v = Value::fromString(std::move(s));
+            break;
+        }
+        default: v = Value::null(); break;
+        }
+        in.read(reinterpret_cast<char*>(&fp.recordPtr.row_id), sizeof(uint64_t));
+        return static_cast<bool>(in);
+    }
+}
+
+// 顺序读取一个段文件，current 为当前条目
+struct IndexEntrySorter::RunReader {
+    std::ifstream in;
+    FieldPointer current;
+    char buffer[1 << 16];
+
+    explicit RunReader(const std::string& path) {
+        in.rdbuf()->pubsetbuf(buffer, sizeof(buffer));
+        in.open(path, std::ios::binary);
+        if (!in.is_open()) {
+            throw std::runtime_error("无法打开索引排序临时文件: " + path);
+        }
+    }
+    bool advance() { return readRunEntry(in, current); }
+};
+
+IndexEntrySorter::IndexEntrySorter(const std::string& tempPrefix, size_t memoryBudget, unsigned threads)
+    : m_prefix(tempPrefix), m_budget(memoryBudget), m_threads(threads) {
+    if (m_threads == 0) {
+        m_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+IndexEntrySorter::~IndexEntrySorter() {
+    m_readers.clear();
+    for (const auto& run : m_runs) {
+        std::remove(run.c_str());
+    }
+}
+
+void IndexEntrySorter::add(FieldPointer fieldPtr) {
+    m_bytes += sizeof(FieldPointer) + fieldPtr.fieldValue.s.size();
+    m_buffer.push_back(std::move(fieldPtr));
+    if (m_bytes >= m_budget) {
+        spill();
+    }
+}
+
+// 把缓冲区切成若干段由多个线程分别排序，再两两归并
+void IndexEntrySorter::sortBuffer() {
+    size_t n = m_buffer.size();
+    size_t parts = std::min<size_t>(m_threads, n / 4096 + 1);
+    if (parts <= 1) {
+        std::sort(m_buffer.begin(), m_buffer.end(), entryLess);
+        return;
+    }
+
+    std::vector<size_t> bounds;
+    for (size_t k = 0; k <= parts; ++k) {
+        bounds.push_back(n * k / parts);
+    }
+    std::vector<std::thread> workers;
+    for (size_t k = 0; k < parts; ++k) {
+        workers.emplace_back([this, &bounds, k] {
+            std::sort(m_buffer.begin() + bounds[k], m_buffer.begin() + bounds[k + 1], entryLess);
+            });
+    }
+    for (auto& worker : workers) worker.join();
+
+    for (size_t width = 1; width < parts; width *= 2) {
+        workers.clear();
+        for (size_t k = 0; k + width < parts; k += 2 * width) {
+            auto first = m_buffer.begin() + bounds[k];
+            auto middle = m_buffer.begin() + bounds[k + width];
+            auto last = m_buffer.begin() + bounds[std::min(parts, k + 2 * width)];
+            workers.emplace_back([first, middle, last] {
+                std::inplace_merge(first, middle, last, entryLess);
+                });
+        }
+        for (auto& worker : workers) worker.join();
+    }
+}
+
+void IndexEntrySorter::spill() {
+    if (m_buffer.empty()) return;
+    sortBuffer();
+
+    std::string path = m_prefix + ".run" + std::to_string(m_runs.size());
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        throw std::runtime_error("无法创建索引排序临时文件: " + path);
+    }
+    m_runs.push_back(path);
+    for (const auto& fp : m_buffer) {
+        writeRunEntry(out, fp);
+    }
+    out.close();
+    if (!out) {
+        throw std::runtime_error("写入索引排序临时文件失败: " + path);
+    }
+
+    m_buffer.clear();
+    m_buffer.shrink_to_fit();
+    m_bytes = 0;
+}
+
+bool IndexEntrySorter::next(FieldPointer& fieldPtr) {
+    auto greater = [this](size_t a, size_t b) {
+        return entryLess(m_readers[b]->current, m_readers[a]->current);
+    };
+
+    if (!m_finished) {
+        m_finished = true;
+        if (m_runs.empty()) {
+            // 全部条目都在内存中，排序后直接返回
+            sortBuffer();
+        }
+        else {
+            spill();
+            for (const auto& run : m_runs) {
+                m_readers.push_back(std::make_unique<RunReader>(run));
+                if (m_readers.back()->advance()) {
+                    m_heap.push_back(m_readers.size() - 1);
+                }
+            }
+            std::make_heap(m_heap.begin(), m_heap.end(), greater);
+        }
+    }
+
+    if (m_readers.empty()) {
+        if (m_pos == m_buffer.size()) return false;
+        fieldPtr = std::move(m_buffer[m_pos++]);
+        return true;
+    }
+
+    if (m_heap.empty()) return false;
+    std::pop_heap(m_heap.begin(), m_heap.end(), greater);
+    size_t k = m_heap.back();
+    fieldPtr = std::move(m_readers[k]->current);
+    if (m_readers[k]->advance()) {
+        std::push_heap(m_heap.begin(), m_heap.end(), greater);
+    }
+    else {
+        m_heap.pop_back();
+    }
+    return true;
+}
+
+void BTree::bulkLoad(const std::function<bool(FieldPointer&)>& next) {
+    BufferPool& bp = pool();
+    bp.truncate(m_file);
+    char headerPage[NODE_SIZE] = {};
+    bp.append(m_file, headerPage, NODE_SIZE);
+    m_opened = true;
+    m_size = 0;
+    m_statsValid = false;
+
+    // 节点留出约 10% 空间，避免之后的插入立即分裂
+    size_t fill = std::max<size_t>(2, static_cast<size_t>(degree) * 9 / 10);
+
+    // 叶子按顺序追加到文件末尾，每层只记录各节点的页号和子树中的最小条目
+    std::vector<std::pair<uint32_t, FieldPointer>> level;
+    BufferPool::Page* leaf = nullptr;
+    FieldPointer fp;
+    try {
+        while (next(fp)) {
+            if (!leaf || header(leaf->data)->count == fill) {
+                uint32_t page_no = allocatePage(true);
+                if (leaf) {
+                    header(leaf->data)->next = page_no;
+                    bp.unpinPage(leaf, true);
+                    leaf = nullptr;
+                }
+                leaf = bp.fetchPage(m_file, page_no);
+                level.emplace_back(page_no, fp);
+            }
+            NodeHeader* h = header(leaf->data);
+            writeEntry(entryAt(leaf->data, h->count), fp, 0);
+            h->count++;
+            ++m_size;
+        }
+    }
+    catch (...) {
+        if (leaf) bp.unpinPage(leaf, true);
+        throw;
+    }
+    if (leaf) {
+        bp.unpinPage(leaf, true);
+    }
+    if (level.empty()) {
+        level.emplace_back(allocatePage(true), FieldPointer{});
+    }
+
+    // 逐层向上构建内部节点
+    while (level.size() > 1) {
+        std::vector<std::pair<uint32_t, FieldPointer>> parents;
+        for (size_t i = 0; i < level.size(); i += fill + 1) {
+            uint32_t node = allocatePage(false);
+            size_t end = std::min(level.size(), i + fill + 1);
+            BufferPool::Page* page = bp.fetchPage(m_file, node);
+            header(page->data)->first_child = level[i].first;
+            for (size_t j = i + 1; j < end; ++j) {
+                writeEntry(entryAt(page->data, j - i - 1), level[j].second, level[j].first);
+            }
+            header(page->data)->count = static_cast<uint16_t>(end - i - 1);
+            bp.unpinPage(page, true);
+            parents.emplace_back(node, std::move(level[i].second));
+        }
+        level = std::move(parents);
+    }
+    m_root = level.front().first;
+    writeHeader();
+}
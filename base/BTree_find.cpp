@@ -1,48 +1,165 @@
 #include "BTree.h"
+#include <algorithm>
 
-
-void BTree::findRange(const std::string& low, const std::string& high, std::vector<FieldPointer>& result) {
-    findRangeInNode(root, low, high, result);
+uint32_t BTree::findLeaf(const FieldPointer& fieldPtr) {
+    BufferPool& bp = pool();
+    uint32_t page_no = m_root;
+    while (true) {
+        BufferPool::Page* page = bp.fetchPage(m_file, page_no);
+        if (header(page->data)->is_leaf) {
+            bp.unpinPage(page, false);
+            return page_no;
+        }
+        // 分隔键是右子树的最小条目，等于分隔键的条目在右侧
+        uint32_t child = childAt(page->data, upperBound(page->data, fieldPtr));
+        bp.unpinPage(page, false);
+        page_no = child;
+    }
 }
 
-void BTree::findRangeInNode(BTreeNode* node, const std::string& low, const std::string& high, std::vector<FieldPointer>& result) {
-    int i = 0;
-    while (i < node->fields.size() && node->fields[i].fieldValue < low) {
-        i++;
+// 最左叶子：NULL 排在最后，沿最左子页下降即可得到最小的条目
+uint32_t BTree::leftmostLeaf() {
+    BufferPool& bp = pool();
+    uint32_t page_no = m_root;
+    while (true) {
+        BufferPool::Page* page = bp.fetchPage(m_file, page_no);
+        bool isLeaf = header(page->data)->is_leaf != 0;
+        uint32_t child = header(page->data)->first_child;
+        bp.unpinPage(page, false);
+        if (isLeaf) return page_no;
+        page_no = child;
     }
+}
 
-    while (i < node->fields.size() && node->fields[i].fieldValue <= high) {
-        if (!node->isLeaf) {
-            findRangeInNode(node->children[i], low, high, result);
-        }
+uint32_t BTree::firstLeaf() {
+    open();
+    return leftmostLeaf();
+}
 
-        result.push_back(node->fields[i]);
-        i++;
+uint32_t BTree::readLeaf(uint32_t leaf, std::vector<FieldPointer>& out) {
+    BufferPool& bp = pool();
+    BufferPool::Page* page = bp.fetchPage(m_file, leaf);
+    size_t count = header(page->data)->count;
+    out.reserve(out.size() + count);
+    for (size_t i = 0; i < count; ++i) {
+        out.push_back(readEntry(entryAt(page->data, i)));
     }
+    uint32_t next = header(page->data)->next;
+    bp.unpinPage(page, false);
+    return next;
+}
+
+// 查找字段
+std::vector<FieldPointer> BTree::find(const std::string& fieldValue) {
+    open();
+    std::vector<FieldPointer> result;
+    FieldPointer probe{ makeKey(fieldValue), { 0 } };
 
-    if (!node->isLeaf && i < node->children.size()) {
-        findRangeInNode(node->children[i], low, high, result);
+    // 从 (值, 0) 所在叶子开始，沿链表取出所有相同值的条目
+    BufferPool& bp = pool();
+    for (uint32_t leaf = findLeaf(probe); leaf != 0;) {
+        BufferPool::Page* page = bp.fetchPage(m_file, leaf);
+        size_t count = header(page->data)->count;
+        for (size_t i = lowerBound(page->data, probe); i < count; ++i) {
+            FieldPointer fp = readEntry(entryAt(page->data, i));
+            if (Value::compare(fp.fieldValue, probe.fieldValue) != 0) {
+                bp.unpinPage(page, false);
+                return result;
+            }
+            result.push_back(std::move(fp));
+        }
+        leaf = header(page->data)->next;
+        bp.unpinPage(page, false);
     }
+    return result;
 }
 
-// 查找字段
-FieldPointer* BTree::find(const std::string& fieldValue) {
-    return findInNode(root, fieldValue);
+void BTree::findRange(const std::string& low, const std::string& high, std::vector<FieldPointer>& result,
+    bool lowInclusive, bool highInclusive) {
+    open();
+    bool hasLow = !low.empty();
+    bool hasHigh = !high.empty();
+    Value lowKey = hasLow ? makeKey(low) : Value::null();
+    Value highKey = hasHigh ? makeKey(high) : Value::null();
+
+    BufferPool& bp = pool();
+    uint32_t leaf = hasLow ? findLeaf({ lowKey, { 0 } }) : leftmostLeaf();
+
+    while (leaf != 0) {
+        BufferPool::Page* page = bp.fetchPage(m_file, leaf);
+        size_t count = header(page->data)->count;
+        for (size_t i = 0; i < count; ++i) {
+            FieldPointer fp = readEntry(entryAt(page->data, i));
+            // NULL 不参与范围比较
+            bool stop = fp.fieldValue.isNull();
+            if (!stop && hasLow) {
+                int c = Value::compare(fp.fieldValue, lowKey);
+                if (c < 0 || (c == 0 && !lowInclusive)) continue;
+            }
+            if (!stop && hasHigh) {
+                int c = Value::compare(fp.fieldValue, highKey);
+                stop = c > 0 || (c == 0 && !highInclusive);
+            }
+            if (stop) {
+                bp.unpinPage(page, false);
+                return;
+            }
+            result.push_back(std::move(fp));
+        }
+        leaf = header(page->data)->next;
+        bp.unpinPage(page, false);
+    }
 }
 
-// 在节点内查找
-FieldPointer* BTree::findInNode(BTreeNode* node, const std::string& fieldValue) {
-    int i = 0;
-    while (i < node->fields.size() && node->fields[i].fieldValue < fieldValue) {
-        i++;
+const IndexStats& BTree::statistics() {
+    open();
+    if (m_statsValid && m_changes <= std::max<uint64_t>(100, m_stats.entries / 10)) {
+        return m_stats;
     }
-    if (i < node->fields.size() && node->fields[i].fieldValue == fieldValue) {
-        return &node->fields[i];
+
+    IndexStats stats;
+    BufferPool& bp = pool();
+    for (uint32_t page_no = m_root;;) {
+        BufferPool::Page* page = bp.fetchPage(m_file, page_no);
+        bool isLeaf = header(page->data)->is_leaf != 0;
+        uint32_t child = header(page->data)->first_child;
+        bp.unpinPage(page, false);
+        if (isLeaf) break;
+        ++stats.height;
+        page_no = child;
     }
-    if (node->isLeaf) {
-        return nullptr;
+
+    // 条目按键有序，相邻比较即可统计不同键数；每隔 step 个条目记录一个直方图桶的上界
+    uint64_t step = std::max<uint64_t>(1, m_size / HISTOGRAM_BUCKETS);
+    uint64_t seen = 0;
+    Value previous;
+    for (uint32_t leaf = leftmostLeaf(); leaf != 0;) {
+        BufferPool::Page* page = bp.fetchPage(m_file, leaf);
+        size_t count = header(page->data)->count;
+        for (size_t i = 0; i < count; ++i) {
+            FieldPointer fp = readEntry(entryAt(page->data, i));
+            ++stats.entries;
+            if (fp.fieldValue.isNull()) {
+                ++stats.nulls;
+                continue;
+            }
+            if (seen == 0) stats.min = fp.fieldValue;
+            if (seen == 0 || Value::compare(previous, fp.fieldValue) != 0) ++stats.distinct;
+            if (++seen % step == 0) stats.histogram.push_back(fp.fieldValue);
+            previous = std::move(fp.fieldValue);
+        }
+        leaf = header(page->data)->next;
+        bp.unpinPage(page, false);
     }
-    else {
-        return findInNode(node->children[i], fieldValue);
+    if (seen > 0) {
+        stats.max = previous;
+        if (stats.histogram.empty() || Value::compare(stats.histogram.back(), previous) != 0) {
+            stats.histogram.push_back(previous);
+        }
     }
-}
\ No newline at end of file
+
+    m_stats = std::move(stats);
+    m_statsValid = true;
+    m_changes = 0;
+    return m_stats;
+}
@@ -0,0 +1,65 @@
+#include "catalog.h"
+
+#include <fstream>
+#include <stdexcept>
+
+std::atomic<uint64_t> Catalog::s_version{ 1 };
+
+namespace {
+    const char* type_name(int type) {
+        switch (type) {
+        case 1: return "INTEGER";
+        case 2: return "DOUBLE";
+        case 3: return "VARCHAR";
+        case 4: return "BOOL";
+        case 5: return "DATETIME";
+        default: return "UNKNOWN";
+        }
+    }
+}
+
+Catalog::Catalog(const std::string& db_path) : m_db_path(db_path) {}
+
+std::shared_ptr<const TableSchema> Catalog::find(const std::string& table_name) {
+    uint64_t current = version();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_tables.find(table_name);
+        if (it != m_tables.end() && it->second.version == current) return it->second.schema;
+    }
+
+    // 读文件时不持锁；读取期间版本变化的话，记下的是旧版本，下次使用时会再读一次
+    std::shared_ptr<const TableSchema> schema = load(table_name, current);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tables[table_name] = { current, schema };
+    return schema;
+}
+
+std::shared_ptr<const TableSchema> Catalog::get(const std::string& table_name) {
+    std::shared_ptr<const TableSchema> schema = find(table_name);
+    if (!schema) {
+        throw std::runtime_error("无法打开表定义文件: " + m_db_path + "/" + table_name + ".tdf");
+    }
+    return schema;
+}
+
+std::shared_ptr<const TableSchema> Catalog::load(const std::string& table_name, uint64_t version) const {
+    std::ifstream tdf(m_db_path + "/" + table_name + ".tdf", std::ios::binary);
+    if (!tdf) return nullptr;
+
+    auto schema = std::make_shared<TableSchema>();
+    schema->version = version;
+    FieldBlock field;
+    while (tdf.read(reinterpret_cast<char*>(&field), sizeof(FieldBlock))) {
+        schema->ordinals.emplace(field.name, schema->fields.size());
+        schema->structure[field.name] = type_name(field.type);
+        schema->fields.push_back(field);
+    }
+
+    std::ifstream tic(m_db_path + "/" + table_name + ".tic", std::ios::binary);
+    ConstraintBlock constraint;
+    while (tic && tic.read(reinterpret_cast<char*>(&constraint), sizeof(ConstraintBlock))) {
+        schema->constraints.push_back(constraint);
+    }
+    return schema;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#ifndef CATALOG_H
+#define CATALOG_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <unordered_map>
+#include "base/block/fieldBlock.h"
+#include "base/block/constraintBlock.h"
+
+// 一张表的结构：字段定义(.tdf) 和约束(.tic)，以及按字段名查找的哈希表
+struct TableSchema {
+    std::vector<FieldBlock> fields;
+    std::vector<ConstraintBlock> constraints;
+    std::unordered_map<std::string, size_t> ordinals;           // 字段名 -> 字段序号
+    std::unordered_map<std::string, std::string> structure;     // 字段名 -> 类型名（INTEGER、VARCHAR 等）
+    uint64_t version = 0;                                       // 读取时的目录版本
+
+    // 字段序号，不存在返回 -1
+    int ordinal(const std::string& field) const {
+        auto it = ordinals.find(field);
+        return it == ordinals.end() ? -1 : static_cast<int>(it->second);
+    }
+};
+
+// 数据库的表结构缓存：表结构第一次使用时从 .tdf/.tic 读取，之后直接使用内存中的副本（表不存在也会记住）。
+// 写表结构的操作（建表、删表、改字段、改约束）调用 bumpVersion()，版本变化后各表在下次使用时重新读取。
+// 返回的结构不可修改，持有者在表结构变化后仍可安全使用旧版本
+class Catalog {
+public:
+    explicit Catalog(const std::string& db_path);
+
+    // 表不存在（没有 .tdf 文件）时返回 nullptr
+    std::shared_ptr<const TableSchema> find(const std::string& table_name);
+    // 同 find，表不存在时抛出异常
+    std::shared_ptr<const TableSchema> get(const std::string& table_name);
+
+    // 所有数据库共用一个版本号，DDL 写表结构文件后调用
+    static void bumpVersion() { s_version++; }
+    static uint64_t version() { return s_version; }
+
+private:
+    struct Entry {
+        uint64_t version;
+        std::shared_ptr<const TableSchema> schema;
+    };
+
+    std::shared_ptr<const TableSchema> load(const std::string& table_name, uint64_t version) const;
+
+    std::string m_db_path;
+    std::mutex m_mutex;
+    std::unordered_map<std::string, Entry> m_tables;
+    static std::atomic<uint64_t> s_version;
+};
+
+#endif // CATALOG_H
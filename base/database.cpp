@@ -11,12 +11,22 @@
 // 构造函数：加载数据库√
 Database::Database(const std::string& db_name) {
     loadDatabase(db_name);
+    m_catalog = std::make_unique<Catalog>(m_db_path);
     loadTables();
 }
 
-// 析构函数：保存数据库√
+// 析构函数：写回各表延迟保存的元数据，之后缓冲池析构时刷回数据和索引的脏页
 Database::~Database() {
-   
+    for (auto& pair : m_tables) {
+        try {
+            pair.second->flushMetadata();
+        }
+        catch (const std::exception& e) {
+            std::cerr << "保存表 " << pair.first << " 的元数据失败: " << e.what() << std::endl;
+        }
+        delete pair.second;
+    }
+    m_tables.clear();
 }
 
 void Database::loadDatabase(const std::string& db_name)
@@ -234,6 +244,19 @@ std::string Database::getDBPath() const
 	return m_db_path;
 }
 
+HeapFile& Database::getHeapFile(const std::string& trd_path, size_t legacy_record_size) {
+    auto it = m_heap_files.find(trd_path);
+    if (it == m_heap_files.end()) {
+        it = m_heap_files.emplace(trd_path, std::make_unique<HeapFile>(m_buffer_pool, trd_path, legacy_record_size)).first;
+    }
+    return *it->second;
+}
+
+void Database::closeHeapFile(const std::string& trd_path) {
+    m_heap_files.erase(trd_path);
+    m_buffer_pool.discardFile(trd_path);
+}
+
 bool Database::tableExistsOnDisk(const std::string& table_name) const {
 	std::string file_path = m_db_path + "/" + table_name + ".tdf";
 	return std::filesystem::exists(file_path);
@@ -4,8 +4,13 @@
 #define DATABASE_H
 
 #include <base/table/table.h>
+#include "base/storage/bufferPool.h"
+#include "base/storage/heapFile.h"
+#include "base/catalog.h"
 #include <string>
 #include <map>
+#include <memory>
+#include <unordered_map>
 #include <fstream>
 
 
@@ -43,6 +48,20 @@ public:
 		return m_db_name;
 	}
 
+    // 记录文件共用的缓冲池
+    BufferPool& getBufferPool() {
+        return m_buffer_pool;
+    }
+
+    // 取得记录文件对应的堆文件，首次访问时打开（旧格式文件在此转换）
+    HeapFile& getHeapFile(const std::string& trd_path, size_t legacy_record_size);
+    void closeHeapFile(const std::string& trd_path);
+
+    // 表结构缓存，查询和增删改从这里取字段定义和约束
+    Catalog& getCatalog() {
+        return *m_catalog;
+    }
+
 private:
     std::string m_db_name;   // 数据库名称
     std::string m_db_path;//数据库路径;应该到数据库文件夹为止
@@ -52,6 +71,9 @@ private:
     //TransactionManager m_transaction_manager;  // 事务管理器
     std::ofstream m_log_file; // 操作日志文件
     time_t m_create_time; // 创建时间
+    BufferPool m_buffer_pool; // 页式缓冲池，析构时刷回所有脏页
+    std::unordered_map<std::string, std::unique_ptr<HeapFile>> m_heap_files; // .trd 路径 -> 堆文件
+    std::unique_ptr<Catalog> m_catalog; // 表结构缓存
 };
 
 #endif // DATABASE_H
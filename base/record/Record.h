@@ -3,20 +3,29 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <memory>
+#include <functional>
 #include"base/BTree.h"
 #include "base/block/fieldBlock.h"
 #include "base/block/constraintBlock.h"
+#include "base/catalog.h"
 #include"transaction/TransactionManager.h"
 
 #include "base/block/tableBlock.h"
 #include"base/table/table.h"
 #include"log/logManager.h"
+#include "base/storage/heapFile.h"
+#include "predicate.h"
+#include "accessPath.h"
+#include "queryProfile.h"
+#include "executor.h"
 #include <filesystem> 
 #include <fstream>
 #include <sstream>
 #include <algorithm>
 #include <regex>
 #include <map>
+#include <set>
 
 struct JoinPair {
     std::string left_table;
@@ -29,6 +38,12 @@ struct JoinInfo {
     std::vector<JoinPair> joins;       // 变成多组条件
 };
 
+// SELECT 的 LIMIT n [OFFSET m]
+struct LimitClause {
+    uint64_t count = 0;
+    uint64_t offset = 0;
+};
+
 struct ExpressionNode {
     std::string value;
     ExpressionNode* left = nullptr;
@@ -36,20 +51,56 @@ struct ExpressionNode {
     ExpressionNode(const std::string& val) : value(val) {}
 };
 
+// LOAD DATA 的结果：读取的数据行数、载入和拒绝的行数，以及前几条被拒绝行的原因
+struct LoadResult {
+    size_t lines = 0;
+    size_t loaded = 0;
+    size_t rejected = 0;
+    double seconds = 0;
+    std::vector<std::string> errors;
+};
+
 class Record {
+    // 执行器的扫描算子直接按页解码记录
+    friend class ScanOperator;
+    friend class IndexScanOperator;
+    friend class IndexOrderScanOperator;
+    friend class ParallelScanOperator;
+    // 日志中的列值按 .trd 的字段编码写入，恢复时直接按记录格式重做
+    friend class LogManager;
 private:
-    static bool read_record_from_file(std::ifstream& file, const std::vector<FieldBlock>& fields,
+    // 按 row_id 从堆文件中读取一条记录并解码
+    static bool read_record(HeapFile& heap, uint64_t row_id, const std::vector<FieldBlock>& fields,
+        std::unordered_map<std::string, std::string>& record_data, bool skip_deleted);
+    static bool decode_record(const char* data, const std::vector<FieldBlock>& fields,
         std::unordered_map<std::string, std::string>& record_data, uint64_t& row_id, bool skip_deleted);
+    // 解码为类型行，decode_record 也基于它实现
+    static bool decode_row(const char* data, const std::vector<FieldBlock>& fields, Row& row, bool skip_deleted);
+    // 字段列表对应的行结构，prefix 非空时列名为 "prefix.字段名"
+    static RowSchema row_schema(const std::vector<FieldBlock>& fields, const std::string& prefix = "");
+    static std::unordered_map<std::string, std::string> row_to_map(const Row& row, const RowSchema& schema);
     static ExpressionNode* build_expression_tree(const std::vector<std::string>& tokens);
     std::string table_name;
     std::vector<std::string> columns;
     std::vector<std::string> values;
     std::unordered_map<std::string, std::string> table_structure; // 列名 -> 数据类型
+    // 插入时使用的表对象及其字段，取自数据库中缓存的表，一条语句内只取一次
+    Table* target_table = nullptr;
+    std::vector<FieldBlock> table_fields;
+    // 唯一性检查用：本语句已接受的键，以及没有索引的字段一次扫描得到的已有键
+    size_t batch_size = 1;
+    std::map<std::string, std::set<Value>> pending_keys;
+    std::map<std::string, std::set<Value>> scanned_keys;
     static std::vector<FieldBlock> read_field_blocks(const std::string& table_name);
+    // 当前数据库表结构缓存中的表结构，表不存在时抛出异常
+    static std::shared_ptr<const TableSchema> catalog_schema(const std::string& table_name);
     // 条件解析相关
     std::string full_condition;
+    // 编译后的 WHERE 条件，第一次匹配时生成，parse_condition 时失效
+    mutable std::shared_ptr<Predicate> compiled_condition;
+    mutable bool compiled_use_prefix = false;
     void parse_condition(const std::string& condition);
-    bool matches_condition(const std::unordered_map<std::string, std::string>& record_data, bool use_prefix = false) const;
+    bool matches_condition(const Row& row, const RowSchema& schema, bool use_prefix = false) const;
 
     // 解析列名和值
     void parse_columns(const std::string& cols);
@@ -79,6 +130,13 @@ private:
         std::string& value);
     bool check_auto_increment_constraint(const ConstraintBlock& constraint,
         std::string& value);
+    // 当前表中是否已有未删除的记录在 field_name 上取值 value：
+    // 有该字段的单字段索引时按索引查找并回表确认，否则顺序扫描到第一条匹配为止
+    bool key_exists(const std::string& field_name, const std::string& value);
+    // 记下本语句已接受的唯一键，同一批次的后续行不能重复
+    void remember_key(const std::string& field_name, const std::string& value);
+    // 把 SQL 文本中的值按字段类型转换为类型值，与记录解码后的值可直接比较
+    static Value field_value(const FieldBlock& field, const std::string& value);
 
     // 检查引用完整性
     bool check_references_before_delete(const std::string& table_name,
@@ -99,28 +157,78 @@ public:
     bool validate_field_block(const std::string& value, const FieldBlock& field);
     // 表操作相关函数
     static std::vector<std::pair<uint64_t, std::unordered_map<std::string, std::string>>>read_records(const std::string& table_name);
+    // 读取表中所有未删除的记录为类型行，schema 返回列结构
+    static std::vector<Row> read_rows(const std::string& table_name, RowSchema& schema);
+    // 按页顺序逐行解码，不整表物化；visit 返回 false 时提前结束
+    static void scan_rows(const std::string& table_name, RowSchema& schema, const std::function<bool(Row&)>& visit);
+    // 表的列结构，不读取记录
+    static RowSchema table_schema(const std::string& table_name);
     void insert_record(const std::string& table_name, const std::string& cols, const std::string& vals);
 
     // 写入一个字段，包括 null_flag + 数据 + padding
     static void write_field(std::ofstream& out, const FieldBlock& field, const std::string& value);
-    void insert_into();
-    static std::vector<Record> select(
+    static void encode_field(std::string& out, const FieldBlock& field, const std::string& value);
+    // 编码整条记录：row_id + delete_flag + 各字段
+    static std::string encode_record(uint64_t row_id, char delete_flag, const std::vector<FieldBlock>& fields,
+        const std::vector<std::string>& values);
+    static std::string encode_record(uint64_t row_id, char delete_flag, const std::vector<FieldBlock>& fields,
+        const std::unordered_map<std::string, std::string>& record);
+    // 一条记录在 .trd 中占用的字节数
+    static size_t get_record_size(const std::vector<FieldBlock>& fields);
+    static std::string get_trd_path(const std::string& table_name);
+    // 表对应的槽页堆文件，fields 用于旧格式文件的一次性转换
+    static HeapFile& heap_file(const std::string& table_name, const std::vector<FieldBlock>& fields);
+    // 多行插入：先逐行检查约束，全部通过后一次写入堆文件、索引、日志和元数据
+    // value_lists 为各行括号内的值列表，返回插入的行数
+    size_t insert_records(const std::string& table_name, const std::string& cols, const std::vector<std::string>& value_lists);
+    // 由 columns/values 生成完整的一行（含 DEFAULT 和自增值）并检查约束
+    std::vector<std::string> prepare_row();
+    // 写入已检查过的行并记日志，返回各行的位置；由调用者在更新索引后提交
+    std::vector<RecordPointer> write_rows(const std::vector<std::vector<std::string>>& rows);
+    // 从 CSV 文件批量导入：分块读入，多线程解析、转换和编码，约束按批检查，
+    // 不合格的行跳过并计数；导入量大时整体重建索引
+    LoadResult load_data(const std::string& table_name, const std::string& file_path,
+        char delimiter = ',', size_t skip_lines = 0);
+    static ResultSet select(
+        const std::string& columns,
+        const std::string& table_name,
+        const std::string& condition,
+        const std::string& group_by,
+        const std::string& order_by,
+        const std::string& having,
+        const JoinInfo* join_info=nullptr,
+        const LimitClause* limit=nullptr,
+        QueryProfile* profile=nullptr);
+    // 按批产出查询结果而不物化结果集：先以输出列的结构调用 on_schema，再对每批调用 emit，
+    // emit 返回 false 时提前结束。扫描、过滤、连接探测、投影逐批进行，只有分组和排序需要读完输入；
+    // 有 LIMIT 时取够行数即停止读表，排序只保留前 offset + count 行
+    static void select_each(
         const std::string& columns,
         const std::string& table_name,
         const std::string& condition,
         const std::string& group_by,
         const std::string& order_by,
         const std::string& having,
-        const JoinInfo* join_info=nullptr);
+        const JoinInfo* join_info,
+        const LimitClause* limit,
+        const std::function<void(const RowSchema&)>& on_schema,
+        const std::function<bool(const RowBatch&)>& emit);
     int update(const std::string& tableName, const std::string& setClause, const std::string& condition);
 
     int delete_(const std::string& tableName, const std::string& condition);
     //int delete_by_rowid(const std::string& table_name, uint64_t rowID);
+    // 回收带删除标记的记录：删除索引项并释放槽位。只访问标记过的记录，耗时与表的大小无关
     int delete_by_flag(const std::string& table_name);
+    // 检查点时是否该回收：标记删除的记录至少 VACUUM_MIN_TOMBSTONES 条，且占表中记录的 1/VACUUM_TOMBSTONE_RATIO 以上
+    static constexpr size_t VACUUM_MIN_TOMBSTONES = 1024;
+    static constexpr size_t VACUUM_TOMBSTONE_RATIO = 4;
+    static bool needs_vacuum(const std::string& table_name);
 
     int rollback_update_by_rowid(const std::string& table_name, const std::vector<std::pair<uint64_t, std::vector<std::pair<std::string, std::string>>>>& undo_list);
     int rollback_delete_by_rowid(const std::string& tableName, uint64_t rowId);
     int rollback_insert_by_rowid(const std::string& tableName, uint64_t rowId);
+    // 删除批量导入的连续 row_id（直接释放槽位，不更新索引），返回删除的行数
+    int rollback_insert_range(const std::string& tableName, uint64_t firstRowId, uint64_t count);
 
     void insertByRowid(uint64_t rowId, const std::vector<std::pair<std::string, std::string>>& values);
     void updateByRowid(uint64_t rowId, const std::vector<std::pair<std::string, std::string>>& newValues);
@@ -129,6 +237,7 @@ public:
     static std::vector<std::string> tokenize(const std::string& expr);
     static bool table_exists(const std::string& table_name);
     static std::unordered_map<std::string, std::string> read_table_structure_static(const std::string& table_name);
+    static std::unordered_map<std::string, std::string> table_structure_of(const std::vector<FieldBlock>& fields);
     static std::vector<std::string> parse_column_list(const std::string& columns);
     static std::string get_type_string(int type);
     // Setter 和 Getter 方法
@@ -141,18 +250,16 @@ public:
 
 	//索引相关函数
 
-    std::vector<std::pair<uint64_t, std::unordered_map<std::string, std::string>>>
-        selectByIndex(
-            const std::unordered_map<uint64_t, std::unordered_map<std::string, std::string>>& filtered,
-            const std::vector<std::shared_ptr<Table>>& tables,
-            const std::unordered_map<std::string, std::string>& combined_structure,
-            bool has_join
-        );
+    // 按访问计划回表读取索引命中的行，并用完整条件过滤
+    // fetched 返回回表读取的候选行数
+    std::vector<Row> selectByIndex(const AccessPlan& plan, const std::string& table_name, RowSchema& schema,
+        size_t* fetched = nullptr);
     //更新索引操作
-    void updateIndexesAfterInsert(const std::string& table_name);
+    // rows 为按表字段顺序的完整行，各索引的新条目排序后依次插入
+    void updateIndexesAfterInsert(const std::string& table_name, const std::vector<std::vector<std::string>>& rows,
+        const std::vector<RecordPointer>& recordPtrs);
     void updateIndexesAfterDelete(const std::string& table_name, const std::vector<std::string>& deletedValues, const RecordPointer& recordPtr);
     void updateIndexesAfterUpdate(const std::string& table_name, const std::vector<std::string>& oldValues, const std::vector<std::string>& newValues, const RecordPointer& recordPtr);
-    RecordPointer get_last_inserted_record_pointer(const std::string& table_name);
 
     static std::string read_field(std::ifstream& file, const FieldBlock& field);
 
@@ -161,7 +268,5 @@ public:
 };
 
 std::tm custom_strptime(const std::string& datetime_str, const std::string& format);
-std::unordered_map<uint64_t, std::unordered_map<std::string, std::string>>
-vectorToMap(const std::vector<std::pair<uint64_t, std::unordered_map<std::string, std::string>>>& vec);
 
 #endif // RECORD_H
\ No newline at end of file
@@ -0,0 +1,231 @@
+#include "accessPath.h"
+#include "Record.h"
+#include "predicate.h"
+#include "manager/dbManager.h"
+
+#include <algorithm>
+#include <map>
+#include <regex>
+
+namespace {
+    // 同一字段上合并后的条件
+    struct FieldBound {
+        bool has_point = false;
+        std::string point;
+        std::string low, high;
+        bool low_inclusive = true, high_inclusive = true;
+    };
+
+    std::string strip_parens(std::string s) {
+        while (s.size() >= 2 && s.front() == '(' && s.back() == ')') {
+            s = s.substr(1, s.size() - 2);
+            s.erase(0, s.find_first_not_of(" \t"));
+            s.erase(s.find_last_not_of(" \t") + 1);
+        }
+        return s;
+    }
+
+    // 直方图中小于 key 的条目比例
+    double fraction_below(const IndexStats& stats, const Value& key) {
+        if (stats.histogram.empty()) return 0.5;
+        size_t below = 0;
+        for (const auto& bound : stats.histogram) {
+            if (Value::compare(bound, key) < 0) ++below;
+        }
+        return static_cast<double>(below) / stats.histogram.size();
+    }
+
+    void estimate(IndexProbe& probe) {
+        const IndexStats& stats = probe.btree->statistics();
+        double nonnull = static_cast<double>(stats.entries - stats.nulls);
+        double buckets = static_cast<double>(std::max<size_t>(1, stats.histogram.size()));
+        if (nonnull <= 0) {
+            probe.selectivity = 0;
+        }
+        else if (probe.point) {
+            // 均匀分布下为 1/不同键数；同一个键占了多个桶的上界时按它占的桶数估计
+            Value key = probe.btree->makeKey(probe.value);
+            size_t equal = std::count_if(stats.histogram.begin(), stats.histogram.end(),
+                [&](const Value& bound) { return Value::compare(bound, key) == 0; });
+            probe.selectivity = 1.0 / std::max<uint64_t>(1, stats.distinct);
+            if (equal > 1) probe.selectivity = std::max(probe.selectivity, (equal - 1) / buckets);
+            if (Value::compare(key, stats.min) < 0 || Value::compare(key, stats.max) > 0) probe.selectivity = 0;
+        }
+        else {
+            double low = probe.low.empty() ? 0.0 : fraction_below(stats, probe.btree->makeKey(probe.low));
+            double high = probe.high.empty() ? 1.0 : fraction_below(stats, probe.btree->makeKey(probe.high));
+            // 边界落在桶内部，按半个桶补偿
+            double sel = high - low + 0.5 / buckets;
+            if (!probe.low.empty() && Value::compare(probe.btree->makeKey(probe.low), stats.max) > 0) sel = 0;
+            if (!probe.high.empty() && Value::compare(probe.btree->makeKey(probe.high), stats.min) < 0) sel = 0;
+            probe.selectivity = std::min(1.0, std::max(0.0, sel));
+        }
+        // 至少估计为一行，避免代价为 0 的计划掩盖了下降的开销
+        probe.selectivity = std::max(probe.selectivity, nonnull > 0 ? 1.0 / nonnull : 0.0);
+        probe.cost = stats.height * AccessPlanner::INDEX_PAGE_COST
+            + probe.selectivity * nonnull * AccessPlanner::INDEX_ENTRY_COST;
+    }
+
+    std::string probe_text(const IndexProbe& probe) {
+        if (probe.point) return probe.field + " = " + probe.value;
+        std::string text;
+        if (!probe.low.empty()) text += probe.field + (probe.low_inclusive ? " >= " : " > ") + probe.low;
+        if (!probe.high.empty()) {
+            if (!text.empty()) text += " AND ";
+            text += probe.field + (probe.high_inclusive ? " <= " : " < ") + probe.high;
+        }
+        return text;
+    }
+}
+
+const char* AccessPlanner::methodName(AccessMethod method) {
+    switch (method) {
+    case AccessMethod::INDEX_POINT: return "INDEX LOOKUP";
+    case AccessMethod::INDEX_RANGE: return "INDEX RANGE SCAN";
+    case AccessMethod::INDEX_INTERSECTION: return "INDEX INTERSECTION";
+    default: return "FULL SCAN";
+    }
+}
+
+std::string AccessPlan::describe() const {
+    std::string text = AccessPlanner::methodName(method);
+    for (size_t i = 0; i < probes.size(); ++i) {
+        text += (i == 0 ? " " : ", ") + probes[i].index_name + " (" + probe_text(probes[i]) + ")";
+    }
+    return text;
+}
+
+AccessPlan AccessPlanner::plan(const std::string& table_name, const std::string& condition) {
+    Database* db = dbManager::getInstance().get_current_database();
+    Table* table = db->getTable(table_name);
+
+    AccessPlan full;
+    full.table_rows = db->getHeapFile(Record::get_trd_path(table_name), Record::get_record_size(table->getFields())).size();
+    full.estimated_rows = static_cast<double>(full.table_rows);
+    full.cost = full.table_rows * SEQ_ROW_COST;
+    if (condition.empty() || table->getIndexes().empty()) return full;
+
+    // 收集每个有单字段索引的字段上的条件；顶层含 OR 时整体只有一个子条件，不会匹配
+    static const std::regex compare(R"(^([\w.]+)\s*(=|>=|<=|>|<)\s*(.+)$)");
+    static const std::regex literal(R"(^(-?\s*\d+(\.\d+)?|'[^']*'|TRUE|FALSE)$)", std::regex::icase);
+    std::map<std::string, FieldBound> bounds;
+    std::map<std::string, std::pair<const IndexBlock*, BTree*>> indexed;
+    for (const auto& index : table->getIndexes()) {
+        if (index.field_num != 1) continue;
+        BTree* btree = table->getBTreeByIndexName(index.name);
+        if (btree && !indexed.count(index.field[0])) indexed[index.field[0]] = { &index, btree };
+    }
+
+    for (const auto& conjunct : Predicate::splitConjuncts(condition)) {
+        std::string expr = strip_parens(conjunct);
+        std::smatch m;
+        if (!std::regex_match(expr, m, compare)) continue;
+        std::string field = m[1], op = m[2], value = m[3];
+        value.erase(value.find_last_not_of(" \t") + 1);
+        if (!std::regex_match(value, literal)) continue;
+        size_t dot = field.find('.');
+        if (dot != std::string::npos) field = field.substr(dot + 1);
+        if (value.front() != '\'') value.erase(std::remove(value.begin(), value.end(), ' '), value.end());
+
+        auto it = indexed.find(field);
+        if (it == indexed.end()) continue;
+        BTree* btree = it->second.second;
+        FieldBound& bound = bounds[field];
+        Value key = btree->makeKey(value);
+
+        if (op == "=") {
+            if (!bound.has_point) { bound.has_point = true; bound.point = value; }
+        }
+        else if (op == ">" || op == ">=") {
+            int c = bound.low.empty() ? 1 : Value::compare(key, btree->makeKey(bound.low));
+            if (c > 0 || (c == 0 && op == ">")) { bound.low = value; bound.low_inclusive = op == ">="; }
+        }
+        else {
+            int c = bound.high.empty() ? -1 : Value::compare(key, btree->makeKey(bound.high));
+            if (c < 0 || (c == 0 && op == "<")) { bound.high = value; bound.high_inclusive = op == "<="; }
+        }
+    }
+
+    std::vector<IndexProbe> probes;
+    for (const auto& [field, bound] : bounds) {
+        IndexProbe probe;
+        probe.btree = indexed[field].second;
+        probe.index_name = indexed[field].first->name;
+        probe.field = field;
+        probe.point = bound.has_point;
+        probe.value = bound.point;
+        probe.low = bound.low;
+        probe.high = bound.high;
+        probe.low_inclusive = bound.low_inclusive;
+        probe.high_inclusive = bound.high_inclusive;
+        estimate(probe);
+        probes.push_back(std::move(probe));
+    }
+    if (probes.empty()) return full;
+
+    std::sort(probes.begin(), probes.end(),
+        [](const IndexProbe& a, const IndexProbe& b) { return a.selectivity < b.selectivity; });
+
+    // 单个索引：读索引 + 按命中行回表
+    AccessPlan best = full;
+    double rows = static_cast<double>(full.table_rows);
+    for (const auto& probe : probes) {
+        double estimated = probe.selectivity * rows;
+        double cost = probe.cost + estimated * RANDOM_FETCH_COST;
+        if (cost < best.cost) {
+            best.method = probe.point ? AccessMethod::INDEX_POINT : AccessMethod::INDEX_RANGE;
+            best.probes = { probe };
+            best.estimated_rows = estimated;
+            best.cost = cost;
+        }
+    }
+
+    // 多个索引求交：按选择率从小到大加入，只要少回表的收益超过多读一个索引的代价
+    if (probes.size() > 1) {
+        AccessPlan merged = full;
+        merged.method = AccessMethod::INDEX_INTERSECTION;
+        double selectivity = 1.0, index_cost = 0;
+        for (const auto& probe : probes) {
+            double next_cost = index_cost + probe.cost + selectivity * probe.selectivity * rows * RANDOM_FETCH_COST;
+            if (!merged.probes.empty() && next_cost >= merged.cost) break;
+            merged.probes.push_back(probe);
+            selectivity *= probe.selectivity;
+            index_cost += probe.cost;
+            merged.estimated_rows = selectivity * rows;
+            merged.cost = next_cost;
+        }
+        if (merged.probes.size() > 1 && merged.cost < best.cost) best = std::move(merged);
+    }
+    best.table_rows = full.table_rows;
+    return best;
+}
+
+std::vector<uint64_t> AccessPlanner::candidates(const AccessPlan& plan) {
+    std::vector<uint64_t> ids;
+    for (size_t i = 0; i < plan.probes.size(); ++i) {
+        const IndexProbe& probe = plan.probes[i];
+        std::vector<FieldPointer> result;
+        if (probe.point) {
+            result = probe.btree->find(probe.value);
+        }
+        else {
+            probe.btree->findRange(probe.low, probe.high, result, probe.low_inclusive, probe.high_inclusive);
+        }
+
+        std::vector<uint64_t> found;
+        found.reserve(result.size());
+        for (const auto& fp : result) found.push_back(fp.recordPtr.row_id);
+        std::sort(found.begin(), found.end());
+
+        if (i == 0) {
+            ids = std::move(found);
+        }
+        else {
+            std::vector<uint64_t> both;
+            std::set_intersection(ids.begin(), ids.end(), found.begin(), found.end(), std::back_inserter(both));
+            ids = std::move(both);
+        }
+        if (ids.empty()) break;
+    }
+    return ids;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#ifndef ACCESSPATH_H
+#define ACCESSPATH_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "base/BTree.h"
+
+// 单表查询的访问路径选择：
+// WHERE 按顶层 AND 拆分后，把 "字段 比较符 常量" 形式的子条件按字段合并成索引上的等值或范围访问，
+// 用索引统计信息（条目数、不同键数、最值、直方图）估计选择率和代价，
+// 在全表扫描、索引等值查找、索引范围扫描、多个索引结果求交之间选代价最小的一种
+
+enum class AccessMethod { FULL_SCAN, INDEX_POINT, INDEX_RANGE, INDEX_INTERSECTION };
+
+// 一次索引访问：等值查找或范围扫描
+struct IndexProbe {
+    BTree* btree = nullptr;
+    std::string index_name;
+    std::string field;
+    bool point = false;
+    std::string value;                  // 等值查找的常量
+    std::string low, high;              // 范围扫描的上下界，空表示该侧无界
+    bool low_inclusive = true;
+    bool high_inclusive = true;
+    double selectivity = 1.0;           // 估计命中的比例
+    double cost = 0;                    // 读索引的代价（不含回表）
+};
+
+struct AccessPlan {
+    AccessMethod method = AccessMethod::FULL_SCAN;
+    std::vector<IndexProbe> probes;     // 求交时按选择率从小到大排列
+    uint64_t table_rows = 0;
+    double estimated_rows = 0;
+    double cost = 0;
+
+    bool usesIndex() const { return method != AccessMethod::FULL_SCAN; }
+    // 计划的文字描述，如 "INDEX RANGE SCAN IG (G >= 5 AND G < 10)"
+    std::string describe() const;
+};
+
+class AccessPlanner {
+public:
+    // 代价单位：顺序读一行为 1
+    static constexpr double SEQ_ROW_COST = 1.0;
+    static constexpr double RANDOM_FETCH_COST = 4.0;    // 按 row_id 回表读一行
+    static constexpr double INDEX_PAGE_COST = 4.0;      // 索引下降时每层一页
+    static constexpr double INDEX_ENTRY_COST = 0.2;     // 在叶子中顺序读一个条目
+
+    static AccessPlan plan(const std::string& table_name, const std::string& condition);
+    // 执行计划中的索引访问，返回升序排列的候选 row_id（多个索引时为交集）
+    static std::vector<uint64_t> candidates(const AccessPlan& plan);
+
+    static const char* methodName(AccessMethod method);
+};
+
+#endif // ACCESSPATH_H
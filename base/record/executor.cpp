@@ -0,0 +1,1002 @@
+#include "executor.h"
+#include "Record.h"
+#include "spillFile.h"
+#include "workerPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+namespace {
+    template <typename T>
+    void subtract(T& total, T part) {
+        total = total > part ? total - part : 0;
+    }
+}
+
+// ==================== Operator ====================
+
+Operator::Operator(const std::string& name, const std::string& detail, double estimated_rows) {
+    m_stage.name = name;
+    m_stage.detail = detail;
+    m_stage.estimated_rows = estimated_rows;
+}
+
+bool Operator::next(RowBatch& batch) {
+    batch.clear();
+    if (!m_profiling) {
+        return produce(batch);
+    }
+    ProfileSnapshot start = ProfileSnapshot::take();
+    bool more = produce(batch);
+    start.addTo(m_stage, ProfileSnapshot::take());
+    m_stage.rows_out += batch.size();
+    return more;
+}
+
+bool Operator::pull(Operator& child, RowBatch& batch) {
+    bool more = child.next(batch);
+    countInput(batch.size());
+    return more;
+}
+
+void Operator::enableProfiling() {
+    m_profiling = true;
+    for (Operator* child : m_children) child->enableProfiling();
+}
+
+void Operator::report(QueryProfile* profile) const {
+    if (!profile) return;
+    for (const Operator* child : m_children) child->report(profile);
+
+    StageProfile stage = m_stage;
+    for (const Operator* child : m_children) {
+        subtract(stage.elapsed_ms, child->m_stage.elapsed_ms);
+        subtract(stage.pages, child->m_stage.pages);
+        subtract(stage.bytes_read, child->m_stage.bytes_read);
+    }
+    profile->addStage(std::move(stage));
+}
+
+// ==================== Scan ====================
+
+ScanOperator::ScanOperator(const std::string& table_name, const std::string& prefix, const std::string& detail,
+    double estimated_rows) : Operator("Scan " + table_name, detail, estimated_rows), m_table(table_name) {
+    m_fields = Record::read_field_blocks(table_name);
+    m_schema = Record::row_schema(m_fields, prefix);
+}
+
+bool ScanOperator::produce(RowBatch& batch) {
+    HeapFile& heap = Record::heap_file(m_table, m_fields);
+    while (batch.size() < BATCH_SIZE && m_next_page < heap.pageCount()) {
+        heap.scanPages(m_next_page, m_next_page + 1, [&](uint64_t, const char* data, size_t) {
+            Row row;
+            if (Record::decode_row(data, m_fields, row, /*skip_deleted=*/true)) {
+                batch.push_back(std::move(row));
+            }
+            return true;
+            });
+        ++m_next_page;
+    }
+    countInput(batch.size());
+    return !batch.empty();
+}
+
+ParallelScanOperator::ParallelScanOperator(const std::string& table_name, const std::string& prefix,
+    unsigned workers, const std::string& detail, double estimated_rows)
+    : Operator("Parallel Scan " + table_name, detail + ", " + std::to_string(workers) + " WORKERS", estimated_rows),
+    m_table(table_name), m_workers(std::max(1u, workers)) {
+    m_fields = Record::read_field_blocks(table_name);
+    m_schema = Record::row_schema(m_fields, prefix);
+    m_heap = &Record::heap_file(table_name, m_fields);
+}
+
+ParallelScanOperator::~ParallelScanOperator() {
+    // 提前结束（如 LIMIT 已满足）时等在运行的工作任务退出
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_stop = true;
+    m_cv.wait(lock, [this] { return m_active == 0; });
+}
+
+unsigned ParallelScanOperator::plannedWorkers(const std::string& table_name) {
+    unsigned workers = WorkerPool::maxParallelWorkers();
+    if (workers <= 1) return 0;
+    uint32_t pages = Record::heap_file(table_name, Record::read_field_blocks(table_name)).pageCount();
+    uint32_t morsels = (pages + MORSEL_PAGES - 1) / MORSEL_PAGES;
+    if (morsels < 2 * workers) workers = morsels / 2;
+    return workers > 1 ? workers : 0;
+}
+
+void ParallelScanOperator::pushFilter(const std::string& condition, bool use_prefix) {
+    m_predicate = std::make_unique<Predicate>(Predicate::compile(condition, m_schema, use_prefix));
+    m_stage.detail += ", FILTER " + condition;
+}
+
+void ParallelScanOperator::readMorsel(uint32_t morsel, Morsel& out) const {
+    uint32_t first = 1 + morsel * MORSEL_PAGES;
+    m_heap->scanPages(first, first + MORSEL_PAGES, [&](uint64_t, const char* data, size_t) {
+        Row row;
+        if (!Record::decode_row(data, m_fields, row, /*skip_deleted=*/true)) return true;
+        ++out.decoded;
+        if (!m_predicate || m_predicate->evaluate(row)) out.rows.push_back(std::move(row));
+        return true;
+        });
+}
+
+void ParallelScanOperator::launch() {
+    // 只为输出窗口内尚未领取的块启动任务
+    uint32_t limit = std::min(m_morsels, m_emitted + static_cast<uint32_t>(m_workers * WINDOW_PER_WORKER));
+    uint32_t unclaimed = m_next < limit ? limit - m_next : 0;
+    while (!m_stop && m_active < m_workers && m_active < unclaimed) {
+        ++m_active;
+        WorkerPool::instance().submit([this] { work(); });
+    }
+}
+
+void ParallelScanOperator::work() {
+    uint32_t window = static_cast<uint32_t>(m_workers * WINDOW_PER_WORKER);
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stop && !m_error && m_next < m_morsels && m_next < m_emitted + window) {
+        uint32_t morsel = m_next++;
+        lock.unlock();
+        Morsel result;
+        std::exception_ptr error;
+        try {
+            readMorsel(morsel, result);
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+        lock.lock();
+        if (error && !m_error) m_error = error;
+        m_done.emplace(morsel, std::move(result));
+        m_cv.notify_all();
+    }
+    --m_active;
+    m_cv.notify_all();
+}
+
+void ParallelScanOperator::rethrow() {
+    if (m_error) std::rethrow_exception(m_error);
+}
+
+bool ParallelScanOperator::produce(RowBatch& batch) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_started) {
+        m_started = true;
+        m_page_count = m_heap->pageCount();
+        m_morsels = m_page_count > 1 ? (m_page_count - 1 + MORSEL_PAGES - 1) / MORSEL_PAGES : 0;
+    }
+
+    while (m_emitted < m_morsels) {
+        launch();
+        m_cv.wait(lock, [this] { return m_error || m_done.count(m_emitted) || m_active == 0; });
+        rethrow();
+        auto it = m_done.find(m_emitted);
+        if (it == m_done.end()) continue;   // 工作任务因窗口已满退出，重新提交
+        Morsel morsel = std::move(it->second);
+        m_done.erase(it);
+        ++m_emitted;
+        countInput(morsel.decoded);
+        if (!morsel.rows.empty()) {
+            batch = std::move(morsel.rows);
+            launch();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ParallelScanOperator::drain(const std::function<void(unsigned worker, RowBatch& rows)>& sink) {
+    ProfileSnapshot start = ProfileSnapshot::take();
+    uint32_t page_count = m_heap->pageCount();
+    uint32_t morsels = page_count > 1 ? (page_count - 1 + MORSEL_PAGES - 1) / MORSEL_PAGES : 0;
+
+    std::atomic<uint32_t> next{ 0 };
+    std::atomic<uint64_t> decoded{ 0 }, produced{ 0 };
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_started = true;
+        m_active = m_workers;
+    }
+    for (unsigned w = 0; w < m_workers; ++w) {
+        WorkerPool::instance().submit([&, w] {
+            try {
+                for (uint32_t morsel = next++; morsel < morsels && !m_stop; morsel = next++) {
+                    Morsel result;
+                    readMorsel(morsel, result);
+                    decoded += result.decoded;
+                    produced += result.rows.size();
+                    if (!result.rows.empty()) sink(w, result.rows);
+                }
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_error) m_error = std::current_exception();
+                m_stop = true;
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_active;
+            m_cv.notify_all();
+            });
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this] { return m_active == 0; });
+    m_emitted = m_morsels = morsels;
+    rethrow();
+    countInput(decoded);
+    if (profiling()) {
+        start.addTo(m_stage, ProfileSnapshot::take());
+        m_stage.rows_out += produced;
+    }
+}
+
+IndexScanOperator::IndexScanOperator(const std::string& table_name, const AccessPlan& plan, const std::string& condition)
+    : Operator("Scan " + table_name, plan.describe(), plan.estimated_rows), m_table(table_name), m_plan(plan) {
+    m_fields = Record::read_field_blocks(table_name);
+    m_schema = Record::row_schema(m_fields);
+    if (!condition.empty()) {
+        m_predicate = std::make_unique<Predicate>(Predicate::compile(condition, m_schema, false));
+    }
+}
+
+bool IndexScanOperator::produce(RowBatch& batch) {
+    if (!m_started) {
+        m_ids = AccessPlanner::candidates(m_plan);
+        m_started = true;
+    }
+    HeapFile& heap = Record::heap_file(m_table, m_fields);
+    std::string raw;
+    while (batch.size() < BATCH_SIZE && m_position < m_ids.size()) {
+        Row row;
+        uint64_t row_id = m_ids[m_position++];
+        countInput(1);
+        if (!heap.read(row_id, raw) || !Record::decode_row(raw.data(), m_fields, row, /*skip_deleted=*/true)) continue;
+        if (!m_predicate || m_predicate->evaluate(row)) {
+            batch.push_back(std::move(row));
+        }
+    }
+    return !batch.empty();
+}
+
+IndexOrderScanOperator::IndexOrderScanOperator(const std::string& table_name, BTree* btree,
+    const std::string& index_name, const std::string& condition)
+    : Operator("Scan " + table_name, "INDEX ORDER SCAN " + index_name), m_table(table_name), m_btree(btree) {
+    m_fields = Record::read_field_blocks(table_name);
+    m_schema = Record::row_schema(m_fields);
+    if (!condition.empty()) {
+        m_predicate = std::make_unique<Predicate>(Predicate::compile(condition, m_schema, false));
+    }
+}
+
+bool IndexOrderScanOperator::produce(RowBatch& batch) {
+    if (!m_started) {
+        m_leaf = m_btree->firstLeaf();
+        m_started = true;
+    }
+    HeapFile& heap = Record::heap_file(m_table, m_fields);
+    std::string raw;
+    // 一次只处理一个叶子，有输出就返回：LIMIT 较小时不会多回表读取一整批
+    while (batch.empty() && m_leaf != 0) {
+        m_entries.clear();
+        m_leaf = m_btree->readLeaf(m_leaf, m_entries);
+        countInput(m_entries.size());
+        for (const auto& entry : m_entries) {
+            Row row;
+            if (!heap.read(entry.recordPtr.row_id, raw) ||
+                !Record::decode_row(raw.data(), m_fields, row, /*skip_deleted=*/true)) continue;
+            if (!m_predicate || m_predicate->evaluate(row)) {
+                batch.push_back(std::move(row));
+            }
+        }
+    }
+    return !batch.empty();
+}
+
+// ==================== Filter / Project ====================
+
+FilterOperator::FilterOperator(std::unique_ptr<Operator> child, std::function<bool(const Row&)> predicate,
+    const std::string& name, const std::string& detail)
+    : Operator(name, detail), m_child(std::move(child)), m_predicate(std::move(predicate)) {
+    m_schema = m_child->schema();
+    addChild(m_child.get());
+}
+
+std::unique_ptr<Operator> FilterOperator::where(std::unique_ptr<Operator> child, const std::string& condition,
+    bool use_prefix) {
+    auto predicate = std::make_shared<Predicate>(Predicate::compile(condition, child->schema(), use_prefix));
+    return std::make_unique<FilterOperator>(std::move(child),
+        [predicate](const Row& row) { return predicate->evaluate(row); }, "Filter", condition);
+}
+
+bool FilterOperator::produce(RowBatch& batch) {
+    while (pull(*m_child, m_input)) {
+        for (auto& row : m_input) {
+            if (m_predicate(row)) batch.push_back(std::move(row));
+        }
+        if (!batch.empty()) return true;
+    }
+    return false;
+}
+
+ProjectOperator::ProjectOperator(std::unique_ptr<Operator> child, const std::vector<std::string>& columns,
+    const std::string& detail) : Operator("Project", detail), m_child(std::move(child)) {
+    const RowSchema& input = m_child->schema();
+    m_projection.reserve(columns.size());
+    for (const auto& col : columns) {
+        int index = input.find(col);
+        m_projection.push_back(index);
+        m_schema.add(col, index >= 0 ? input.types[index] : 0);
+    }
+    addChild(m_child.get());
+}
+
+bool ProjectOperator::produce(RowBatch& batch) {
+    if (!pull(*m_child, m_input)) return false;
+    batch.reserve(m_input.size());
+    for (const auto& row : m_input) {
+        Row out;
+        out.row_id = row.row_id;
+        out.values.reserve(m_projection.size());
+        for (int index : m_projection) {
+            out.values.push_back(index >= 0 ? row.values[index] : Value::null());
+        }
+        batch.push_back(std::move(out));
+    }
+    return true;
+}
+
+// ==================== Join ====================
+
+JoinOperator::JoinOperator(std::unique_ptr<Operator> left, std::unique_ptr<Operator> right,
+    std::vector<JoinKey> keys, bool resolvable, const std::string& detail)
+    : Operator(resolvable ? join_method_name(choose_join_method(left->schema(), right->schema(), keys)) : "Empty Join",
+        resolvable ? detail : "JOIN 条件中的字段不存在"),
+    m_left(std::move(left)), m_right(std::move(right)), m_keys(std::move(keys)), m_resolvable(resolvable) {
+    m_schema = m_left->schema();
+    const RowSchema& right_schema = m_right->schema();
+    m_schema.names.insert(m_schema.names.end(), right_schema.names.begin(), right_schema.names.end());
+    m_schema.types.insert(m_schema.types.end(), right_schema.types.begin(), right_schema.types.end());
+    addChild(m_left.get());
+    addChild(m_right.get());
+}
+
+bool JoinOperator::produce(RowBatch& batch) {
+    if (!m_resolvable) return false;
+
+    // 构建侧：右表全部读入
+    if (!m_join) {
+        std::vector<Row> right_rows;
+        while (pull(*m_right, m_input)) {
+            std::move(m_input.begin(), m_input.end(), std::back_inserter(right_rows));
+        }
+        m_join = std::make_unique<StreamJoin>(std::move(right_rows), m_left->schema(), m_right->schema(), m_keys);
+    }
+
+    // 探测侧：左侧逐批
+    bool more = false;
+    while (pull(*m_left, m_input)) {
+        for (const auto& row : m_input) m_join->probe(row, batch);
+        if (!batch.empty()) {
+            more = true;
+            break;
+        }
+    }
+    m_stage.name = join_method_name(m_join->method());
+    return more;
+}
+
+// ==================== Aggregate ====================
+
+namespace {
+    constexpr size_t SPILL_PARTITIONS = 16;
+    constexpr unsigned MAX_SPILL_DEPTH = 3;     // 超过这个层数的分区不再细分，允许超出预算
+
+    std::string trim_copy(const std::string& s) {
+        size_t begin = s.find_first_not_of(" \t");
+        if (begin == std::string::npos) return "";
+        return s.substr(begin, s.find_last_not_of(" \t") - begin + 1);
+    }
+
+    int compare_keys(const std::vector<Value>& a, const std::vector<Value>& b) {
+        for (size_t i = 0; i < a.size(); ++i) {
+            int c = Value::compare(a[i], b[i]);
+            if (c != 0) return c;
+        }
+        return 0;
+    }
+
+    size_t value_bytes(const Value& v) {
+        return sizeof(Value) + v.s.size();
+    }
+}
+
+struct AggregateOperator::Partition {
+    unsigned depth;
+    RowSpillFile file;
+    explicit Partition(unsigned d) : depth(d), file("agg") {}
+};
+
+size_t AggregateOperator::KeyHash::operator()(const std::vector<Value>& key) const {
+    size_t h = 0;
+    for (const auto& v : key) {
+        h ^= ValueHash()(v) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    }
+    return h;
+}
+
+bool AggregateOperator::KeyEqual::operator()(const std::vector<Value>& a, const std::vector<Value>& b) const {
+    return compare_keys(a, b) == 0;
+}
+
+AggregateOperator::AggregateOperator(std::unique_ptr<Operator> child, const std::string& group_by,
+    const std::string& columns, size_t memory_budget)
+    : Operator("Hash Aggregate", group_by), m_child(std::move(child)), m_budget(memory_budget) {
+    const RowSchema& input = m_child->schema();
+    std::vector<std::string> group_columns;
+    for (const auto& col : Record::parse_column_list(group_by)) {
+        int index = input.find(col);
+        if (index < 0) {
+            throw std::runtime_error("GROUP BY 字段 '" + col + "' 不存在于记录中");
+        }
+        group_columns.push_back(col);
+        m_group_indexes.push_back(index);
+        m_schema.add(col, input.types[index]);
+    }
+
+    std::vector<std::string> agg_cols = columns == "*" ? input.names : Record::parse_column_list(columns);
+    for (const auto& col : agg_cols) {
+        if (col.find("(") == std::string::npos || col.back() != ')') continue;
+        if (m_schema.find(col) >= 0) continue;
+        std::string name = trim_copy(col.substr(0, col.find("(")));
+        std::string arg = trim_copy(col.substr(col.find("(") + 1, col.length() - col.find("(") - 2));
+        bool distinct = arg.compare(0, 9, "DISTINCT ") == 0;
+        if (distinct) arg = trim_copy(arg.substr(9));
+
+        Aggregate aggregate{ Function::COUNT, arg == "*" ? -1 : input.find(arg) };
+        int type = 2;
+        if (name == "COUNT") {
+            aggregate.function = arg == "*" ? Function::COUNT_ROWS : (distinct ? Function::COUNT_DISTINCT : Function::COUNT);
+            type = 1;
+        }
+        else if (distinct) throw std::runtime_error("DISTINCT 只能用于 COUNT: " + col);
+        else if (name == "SUM") aggregate.function = Function::SUM;
+        else if (name == "AVG") aggregate.function = Function::AVG;
+        else if (name == "MIN" || name == "MAX") {
+            aggregate.function = name == "MIN" ? Function::MIN : Function::MAX;
+            if (aggregate.field >= 0) type = input.types[aggregate.field];
+        }
+        else throw std::runtime_error("不支持的聚合函数: " + col);
+
+        m_schema.add(col, type);
+        m_aggregates.push_back(aggregate);
+    }
+    addChild(m_child.get());
+}
+
+AggregateOperator::~AggregateOperator() = default;
+
+bool AggregateOperator::accumulate(GroupTable& groups, size_t& bytes, size_t budget, const Row& row,
+    std::vector<Value>& key) const {
+    key.clear();
+    for (int index : m_group_indexes) key.push_back(row.values[index]);
+
+    auto it = groups.find(key);
+    if (it == groups.end()) {
+        if (bytes >= budget && m_depth < MAX_SPILL_DEPTH) return false;
+        bytes += 64 + m_aggregates.size() * sizeof(Accumulator);
+        for (const auto& v : key) bytes += value_bytes(v);
+        it = groups.emplace(key, std::vector<Accumulator>(m_aggregates.size())).first;
+    }
+
+    std::vector<Accumulator>& accs = it->second;
+    for (size_t i = 0; i < m_aggregates.size(); ++i) {
+        const Aggregate& aggregate = m_aggregates[i];
+        Accumulator& acc = accs[i];
+        if (aggregate.function == Function::COUNT_ROWS) {
+            ++acc.count;
+            continue;
+        }
+        if (aggregate.field < 0) continue;
+        const Value& v = row.values[aggregate.field];
+        if (v.isNull()) continue;
+
+        switch (aggregate.function) {
+        case Function::COUNT:
+            ++acc.count;
+            break;
+        case Function::COUNT_DISTINCT:
+            if (acc.distinct.insert(v).second) bytes += value_bytes(v) + 16;
+            break;
+        case Function::SUM:
+        case Function::AVG: {
+            double current = 0;
+            if (!v.toNumber(current)) break;    // 跳过非数值
+            acc.sum += current;
+            ++acc.count;
+            break;
+        }
+        case Function::MIN:
+            if (acc.extreme.isNull() || Value::compare(v, acc.extreme) < 0) acc.extreme = v;
+            break;
+        case Function::MAX:
+            if (acc.extreme.isNull() || Value::compare(v, acc.extreme) > 0) acc.extreme = v;
+            break;
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
+void AggregateOperator::merge(std::vector<Accumulator>& into, std::vector<Accumulator>& from) const {
+    for (size_t i = 0; i < m_aggregates.size(); ++i) {
+        Accumulator& a = into[i];
+        Accumulator& b = from[i];
+        a.count += b.count;
+        a.sum += b.sum;
+        if (!b.extreme.isNull()) {
+            int c = a.extreme.isNull() ? 0 : Value::compare(b.extreme, a.extreme);
+            bool take = a.extreme.isNull() || (m_aggregates[i].function == Function::MIN ? c < 0 : c > 0);
+            if (take) a.extreme = std::move(b.extreme);
+        }
+        if (a.distinct.size() < b.distinct.size()) a.distinct.swap(b.distinct);
+        a.distinct.insert(b.distinct.begin(), b.distinct.end());
+    }
+}
+
+void AggregateOperator::spillRow(const Row& row, const std::vector<Value>& key) {
+    if (m_spilling.empty()) {
+        for (size_t i = 0; i < SPILL_PARTITIONS; ++i) {
+            m_spilling.push_back(std::make_unique<Partition>(m_depth + 1));
+        }
+    }
+    // 每层用不同的位，同一分区的组在下一层能被继续分开
+    uint64_t h = static_cast<uint64_t>(KeyHash()(key)) * 0x9e3779b97f4a7c15ULL;
+    size_t index = static_cast<size_t>(h >> (64 - 4 * (m_depth + 1))) % SPILL_PARTITIONS;
+    m_spilling[index]->file.write(row);
+}
+
+void AggregateOperator::consume(const std::function<bool(Row&)>& next) {
+    Row row;
+    std::vector<Value> key;
+    while (next(row)) {
+        if (!accumulate(m_groups, m_bytes, m_budget, row, key)) spillRow(row, key);
+    }
+}
+
+void AggregateOperator::consumeParallel(ParallelScanOperator& scan) {
+    unsigned workers = scan.workers();
+    size_t budget = m_budget / workers;
+    std::vector<GroupTable> locals(workers);
+    std::vector<size_t> bytes(workers, 0);
+    std::vector<std::unique_ptr<RowSpillFile>> overflow(workers);
+    std::vector<size_t> input_rows(workers, 0);
+
+    scan.drain([&](unsigned worker, RowBatch& rows) {
+        input_rows[worker] += rows.size();
+        std::vector<Value> key;
+        for (const auto& row : rows) {
+            if (accumulate(locals[worker], bytes[worker], budget, row, key)) continue;
+            if (!overflow[worker]) overflow[worker] = std::make_unique<RowSpillFile>("agg");
+            overflow[worker]->write(row);
+        }
+        });
+
+    // 局部组表各自不超过预算的一份，合并后不超过总预算
+    for (unsigned w = 0; w < workers; ++w) {
+        countInput(input_rows[w]);
+        for (auto& [key, accs] : locals[w]) {
+            auto it = m_groups.find(key);
+            if (it == m_groups.end()) m_groups.emplace(key, std::move(accs));
+            else merge(it->second, accs);
+        }
+        m_bytes += bytes[w];
+        GroupTable().swap(locals[w]);
+    }
+    for (auto& file : overflow) {
+        if (!file) continue;
+        file->rewind();
+        consume([&](Row& row) { return file->read(row); });
+    }
+}
+
+void AggregateOperator::finishInput() {
+    for (auto& partition : m_spilling) {
+        if (partition->file.rows() == 0) continue;
+        partition->file.rewind();
+        m_pending.push_back(std::move(partition));
+    }
+    m_spilling.clear();
+
+    m_output.reserve(m_groups.size());
+    for (auto it = m_groups.begin(); it != m_groups.end(); ++it) m_output.push_back(it);
+    std::sort(m_output.begin(), m_output.end(), [](const GroupTable::iterator& a, const GroupTable::iterator& b) {
+        return compare_keys(a->first, b->first) < 0;
+        });
+}
+
+Value AggregateOperator::result(const Aggregate& aggregate, const Accumulator& acc) const {
+    if (aggregate.function == Function::COUNT_ROWS) return Value::fromInt(static_cast<int32_t>(acc.count));
+    if (aggregate.field < 0) return Value::null();
+    switch (aggregate.function) {
+    case Function::COUNT: return Value::fromInt(static_cast<int32_t>(acc.count));
+    case Function::COUNT_DISTINCT: return Value::fromInt(static_cast<int32_t>(acc.distinct.size()));
+    case Function::SUM: return acc.count ? Value::fromDouble(acc.sum) : Value::null();
+    case Function::AVG: return acc.count ? Value::fromDouble(acc.sum / acc.count) : Value::null();
+    default: return acc.extreme;
+    }
+}
+
+bool AggregateOperator::produce(RowBatch& batch) {
+    if (!m_started) {
+        m_started = true;
+        if (auto* scan = dynamic_cast<ParallelScanOperator*>(m_child.get())) {
+            consumeParallel(*scan);
+        }
+        else {
+            RowBatch input;
+            size_t position = 0;
+            consume([&](Row& row) {
+                while (position == input.size()) {
+                    if (!pull(*m_child, input)) return false;
+                    position = 0;
+                }
+                row = std::move(input[position++]);
+                return true;
+                });
+        }
+        finishInput();
+    }
+
+    while (batch.size() < BATCH_SIZE) {
+        if (m_position == m_output.size()) {
+            // 当前组表已输出完，换下一个分区
+            m_output.clear();
+            m_groups.clear();
+            m_position = 0;
+            m_bytes = 0;
+            if (m_pending.empty()) break;
+            std::unique_ptr<Partition> partition = std::move(m_pending.back());
+            m_pending.pop_back();
+            m_depth = partition->depth;
+            consume([&](Row& row) { return partition->file.read(row); });
+            finishInput();
+            continue;
+        }
+
+        GroupTable::iterator group = m_output[m_position++];
+        Row row;
+        row.values = group->first;
+        for (size_t i = 0; i < m_aggregates.size(); ++i) {
+            row.values.push_back(result(m_aggregates[i], group->second[i]));
+        }
+        batch.push_back(std::move(row));
+    }
+    return !batch.empty();
+}
+
+// ==================== Sort / Limit ====================
+
+namespace {
+    template <typename T>
+    void append_big_endian(std::string& key, T bits) {
+        for (int shift = (sizeof(T) - 1) * 8; shift >= 0; shift -= 8) {
+            key.push_back(static_cast<char>((bits >> shift) & 0xFF));
+        }
+    }
+
+    // 一个非 NULL 值的规范化编码，按字节（无符号）比较的顺序与 Value::compare 一致：
+    // 第一个字节是类型类别（同一列中类型不同的值按类别分开），INT 和 DOUBLE 同属数值，
+    // 都转成 double 再把位模式变成可按字节比较的无符号整数；字符串中的 0 字节转义，以 00 00 结尾
+    void append_sort_value(std::string& key, const Value& v) {
+        switch (v.type) {
+        case ValueType::INT:
+        case ValueType::DOUBLE: {
+            double d = v.type == ValueType::INT ? v.i : v.d;
+            if (d == 0) d = 0;  // -0.0 与 0.0 相等
+            uint64_t bits;
+            std::memcpy(&bits, &d, sizeof(bits));
+            bits = (bits & 0x8000000000000000ULL) ? ~bits : bits | 0x8000000000000000ULL;
+            key.push_back(1);
+            append_big_endian(key, bits);
+            break;
+        }
+        case ValueType::BOOL:
+            key.push_back(2);
+            key.push_back(v.b ? 1 : 0);
+            break;
+        case ValueType::DATETIME:
+            key.push_back(3);
+            append_big_endian(key, static_cast<uint64_t>(static_cast<int64_t>(v.t)) ^ 0x8000000000000000ULL);
+            break;
+        default:
+            key.push_back(4);
+            for (char c : v.s) {
+                key.push_back(c);
+                if (c == 0) key.push_back(static_cast<char>(0xFF));
+            }
+            key.push_back(0);
+            key.push_back(0);
+            break;
+        }
+    }
+
+    // 归并堆的顺序：键大的在后，键相同时后面的段在后
+    struct CursorAfter {
+        template <typename Cursor>
+        bool operator()(const Cursor& a, const Cursor& b) const {
+            int c = a.key.compare(b.key);
+            return c != 0 ? c > 0 : a.run > b.run;
+        }
+    };
+
+    size_t row_bytes(const Row& row) {
+        size_t bytes = sizeof(Row) + sizeof(std::string);     // 另计排序时的键
+        for (const auto& v : row.values) bytes += value_bytes(v);
+        return bytes;
+    }
+}
+
+// 已排序的段：内存中的行（带键），或写入临时文件的行（读出时重新编码键）
+struct SortOperator::Run {
+    std::vector<Row> rows;
+    std::vector<std::string> keys;
+    size_t position = 0;
+    std::unique_ptr<RowSpillFile> file;
+
+    bool next(const SortOperator& sort, Row& row, std::string& key) {
+        if (file) {
+            if (!file->read(row)) return false;
+            sort.encodeKey(row, key);
+            return true;
+        }
+        if (position == rows.size()) return false;
+        row = std::move(rows[position]);
+        key = std::move(keys[position]);
+        ++position;
+        return true;
+    }
+};
+
+// 归并时每个段的当前行
+struct SortOperator::Cursor {
+    std::string key;
+    Row row;
+    size_t run;
+};
+
+SortOperator::SortOperator(std::unique_ptr<Operator> child, std::vector<SortKey> keys, const std::string& detail,
+    uint64_t top_n, size_t memory_budget)
+    : Operator(top_n && top_n <= MAX_TOP_N ? "Top-N Sort" : "Sort", detail), m_child(std::move(child)),
+    m_keys(std::move(keys)), m_top_n(top_n), m_budget(memory_budget) {
+    m_schema = m_child->schema();
+    addChild(m_child.get());
+}
+
+SortOperator::~SortOperator() = default;
+
+void SortOperator::encodeKey(const Row& row, std::string& key) const {
+    key.clear();
+    for (const auto& sort_key : m_keys) {
+        const Value& v = row.values[sort_key.column];
+        // NULL 值放在最后（升序降序都一样）
+        if (v.isNull()) {
+            key.push_back(1);
+            continue;
+        }
+        key.push_back(0);
+        size_t start = key.size();
+        append_sort_value(key, v);
+        if (sort_key.desc) {
+            for (size_t i = start; i < key.size(); ++i) key[i] = static_cast<char>(~key[i]);
+        }
+    }
+}
+
+void SortOperator::sortBuffer(bool spill) {
+    size_t count = m_rows.size();
+    if (count == 0) return;
+
+    unsigned workers = WorkerPool::maxParallelWorkers();
+    size_t parts = std::max<size_t>(1, std::min<size_t>(workers, count / MIN_RUN_ROWS));
+    std::vector<std::unique_ptr<Run>> runs(parts);
+    WorkerPool::instance().runAll(parts, workers, [&](size_t part) {
+        size_t begin = count * part / parts;
+        size_t end = count * (part + 1) / parts;
+        struct Item {
+            std::string key;
+            size_t index;
+        };
+        std::vector<Item> items(end - begin);
+        for (size_t i = begin; i < end; ++i) {
+            items[i - begin].index = i;
+            encodeKey(m_rows[i], items[i - begin].key);
+        }
+        std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) {
+            int c = a.key.compare(b.key);
+            return c != 0 ? c < 0 : a.index < b.index;
+            });
+
+        auto run = std::make_unique<Run>();
+        run->rows.reserve(items.size());
+        run->keys.reserve(items.size());
+        for (auto& item : items) {
+            run->rows.push_back(std::move(m_rows[item.index]));
+            run->keys.push_back(std::move(item.key));
+        }
+        runs[part] = std::move(run);
+        });
+    m_rows.clear();
+    m_bytes = 0;
+
+    if (!spill) {
+        for (auto& run : runs) m_runs.push_back(std::move(run));
+        return;
+    }
+    auto file_run = std::make_unique<Run>();
+    file_run->file = std::make_unique<RowSpillFile>("sort");
+    if (parts == 1) {
+        for (const auto& row : runs[0]->rows) file_run->file->write(row);
+    }
+    else {
+        mergeTo(std::move(runs), *file_run);
+    }
+    file_run->file->rewind();
+    m_runs.push_back(std::move(file_run));
+    ++m_spilled_runs;
+}
+
+void SortOperator::startMerge(std::vector<std::unique_ptr<Run>> runs) {
+    m_merging = std::move(runs);
+    m_heap.clear();
+    for (size_t i = 0; i < m_merging.size(); ++i) {
+        Cursor cursor;
+        cursor.run = i;
+        if (m_merging[i]->next(*this, cursor.row, cursor.key)) m_heap.push_back(std::move(cursor));
+    }
+    std::make_heap(m_heap.begin(), m_heap.end(), CursorAfter());
+}
+
+bool SortOperator::nextMerged(Row& row) {
+    if (m_heap.empty()) return false;
+    std::pop_heap(m_heap.begin(), m_heap.end(), CursorAfter());
+    Cursor& cursor = m_heap.back();
+    row = std::move(cursor.row);
+    if (m_merging[cursor.run]->next(*this, cursor.row, cursor.key)) {
+        std::push_heap(m_heap.begin(), m_heap.end(), CursorAfter());
+    }
+    else {
+        m_heap.pop_back();
+    }
+    return true;
+}
+
+void SortOperator::mergeTo(std::vector<std::unique_ptr<Run>> runs, Run& out) {
+    startMerge(std::move(runs));
+    Row row;
+    while (nextMerged(row)) out.file->write(row);
+    m_merging.clear();
+}
+
+void SortOperator::sortAll() {
+    RowBatch input;
+    while (pull(*m_child, input)) {
+        for (auto& row : input) {
+            m_bytes += row_bytes(row);
+            m_rows.push_back(std::move(row));
+        }
+        if (m_bytes >= m_budget) sortBuffer(true);
+    }
+    sortBuffer(false);
+
+    // 段数超过一次归并的上限时，先把相邻的段分组归并成更大的文件段
+    while (m_runs.size() > MAX_MERGE_RUNS) {
+        std::vector<std::unique_ptr<Run>> merged;
+        for (size_t begin = 0; begin < m_runs.size(); begin += MAX_MERGE_RUNS) {
+            size_t end = std::min(m_runs.size(), begin + MAX_MERGE_RUNS);
+            if (end - begin == 1) {
+                merged.push_back(std::move(m_runs[begin]));
+                continue;
+            }
+            std::vector<std::unique_ptr<Run>> group(std::make_move_iterator(m_runs.begin() + begin),
+                std::make_move_iterator(m_runs.begin() + end));
+            auto run = std::make_unique<Run>();
+            run->file = std::make_unique<RowSpillFile>("sort");
+            mergeTo(std::move(group), *run);
+            run->file->rewind();
+            merged.push_back(std::move(run));
+            ++m_spilled_runs;
+        }
+        m_runs = std::move(merged);
+    }
+    startMerge(std::move(m_runs));
+    m_runs.clear();
+}
+
+void SortOperator::keepTop() {
+    // 堆顶是当前保留的行中排在最后的一行；键相同时先到的行排在前面，结果与稳定排序后取前 top_n 行一致
+    struct Entry {
+        std::string key;
+        uint64_t seq;
+        Row row;
+    };
+    auto earlier = [](const Entry& a, const Entry& b) {
+        int c = a.key.compare(b.key);
+        return c != 0 ? c < 0 : a.seq < b.seq;
+    };
+
+    std::vector<Entry> heap;
+    uint64_t seq = 0;
+    std::string key;
+    RowBatch input;
+    while (pull(*m_child, input)) {
+        for (auto& row : input) {
+            encodeKey(row, key);
+            if (heap.size() < m_top_n) {
+                heap.push_back({ key, seq++, std::move(row) });
+                std::push_heap(heap.begin(), heap.end(), earlier);
+            }
+            else if (key < heap.front().key) {
+                std::pop_heap(heap.begin(), heap.end(), earlier);
+                heap.back() = { key, seq++, std::move(row) };
+                std::push_heap(heap.begin(), heap.end(), earlier);
+            }
+        }
+    }
+    std::sort_heap(heap.begin(), heap.end(), earlier);
+
+    auto run = std::make_unique<Run>();
+    run->rows.reserve(heap.size());
+    run->keys.reserve(heap.size());
+    for (auto& entry : heap) {
+        run->rows.push_back(std::move(entry.row));
+        run->keys.push_back(std::move(entry.key));
+    }
+    std::vector<std::unique_ptr<Run>> runs;
+    runs.push_back(std::move(run));
+    startMerge(std::move(runs));
+}
+
+bool SortOperator::produce(RowBatch& batch) {
+    if (!m_sorted) {
+        if (m_top_n && m_top_n <= MAX_TOP_N) keepTop();
+        else sortAll();
+        m_sorted = true;
+        if (m_spilled_runs) m_stage.detail += ", SPILLED " + std::to_string(m_spilled_runs) + " RUNS";
+    }
+
+    Row row;
+    while (batch.size() < BATCH_SIZE && nextMerged(row)) {
+        batch.push_back(std::move(row));
+    }
+    if (m_heap.empty()) m_merging.clear();
+    return !batch.empty();
+}
+
+LimitOperator::LimitOperator(std::unique_ptr<Operator> child, uint64_t limit, uint64_t offset)
+    : Operator("Limit", "LIMIT " + std::to_string(limit) + (offset ? " OFFSET " + std::to_string(offset) : "")),
+    m_child(std::move(child)), m_limit(limit), m_offset(offset) {
+    m_schema = m_child->schema();
+    addChild(m_child.get());
+}
+
+bool LimitOperator::produce(RowBatch& batch) {
+    RowBatch input;
+    while (m_emitted < m_limit && pull(*m_child, input)) {
+        for (auto& row : input) {
+            if (m_skipped < m_offset) {
+                ++m_skipped;
+                continue;
+            }
+            if (m_emitted == m_limit) break;
+            batch.push_back(std::move(row));
+            ++m_emitted;
+        }
+        if (!batch.empty()) return true;
+    }
+    return false;
+}
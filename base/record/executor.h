@@ -0,0 +1,357 @@
+#pragma once
+
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <unordered_map>
+#include <unordered_set>
+#include "row.h"
+#include "join.h"
+#include "accessPath.h"
+#include "queryProfile.h"
+#include "predicate.h"
+#include "base/block/fieldBlock.h"
+
+class HeapFile;
+
+// 拉取式(pull)执行器：SELECT 编译为算子树，上层算子每次向子算子要一批行。
+// 扫描、过滤、投影、连接的探测侧和 LIMIT 逐批处理，内存只与批大小有关；
+// 聚合和排序需要看到全部输入，第一次取数时读完子算子，再按批输出
+
+constexpr size_t BATCH_SIZE = 1024;
+using RowBatch = std::vector<Row>;
+
+class Operator {
+public:
+    Operator(const std::string& name, const std::string& detail = "", double estimated_rows = -1);
+    virtual ~Operator() = default;
+
+    // 取下一批行（不为空），没有更多行时返回 false
+    bool next(RowBatch& batch);
+    const RowSchema& schema() const { return m_schema; }
+
+    // 开启 EXPLAIN ANALYZE 的统计（包括所有子算子）
+    void enableProfiling();
+    // 按执行顺序（子算子在前）把各算子写入 profile，耗时等开销只计算子自身，不含子算子
+    void report(QueryProfile* profile) const;
+
+protected:
+    virtual bool produce(RowBatch& batch) = 0;
+    // 从子算子取一批，计入本算子的输入行数
+    bool pull(Operator& child, RowBatch& batch);
+    void addChild(Operator* child) { m_children.push_back(child); }
+    void countInput(size_t rows) { m_stage.rows_in += rows; }
+    bool profiling() const { return m_profiling; }
+
+    RowSchema m_schema;
+    StageProfile m_stage;               // 名称、说明、估计行数，以及执行时累计的开销（含子算子）
+
+private:
+    std::vector<Operator*> m_children;
+    bool m_profiling = false;
+};
+
+// 顺序扫描：按页解码，每次至少读满一批或读完；prefix 非空时列名为 "表名.字段名"
+class ScanOperator : public Operator {
+public:
+    ScanOperator(const std::string& table_name, const std::string& prefix, const std::string& detail,
+        double estimated_rows);
+
+protected:
+    bool produce(RowBatch& batch) override;
+
+private:
+    std::string m_table;
+    std::vector<FieldBlock> m_fields;
+    uint32_t m_next_page = 1;
+};
+
+// 并行全表扫描（按块调度）：表按连续的页范围切成块，共用线程池中的工作线程各自领取块，
+// 解码并按下推的条件过滤。结果按块的顺序输出，行顺序与 ScanOperator 相同；
+// 已完成未输出的块数有上限，上层不再取数时工作线程领不到新块即停止
+class ParallelScanOperator : public Operator {
+public:
+    static constexpr uint32_t MORSEL_PAGES = 16;
+    static constexpr size_t WINDOW_PER_WORKER = 4;
+
+    ParallelScanOperator(const std::string& table_name, const std::string& prefix, unsigned workers,
+        const std::string& detail, double estimated_rows);
+    ~ParallelScanOperator();
+
+    // 表至少有两倍于工作线程数的块且 max_parallel_workers 大于 1 时返回使用的线程数，否则返回 0
+    static unsigned plannedWorkers(const std::string& table_name);
+
+    // 在工作线程中按条件过滤；use_prefix 为 false 时字段名可以不带表名
+    void pushFilter(const std::string& condition, bool use_prefix);
+    unsigned workers() const { return m_workers; }
+    // 不保持顺序地读完全部块，sink 在工作线程上调用，worker 为 0 ~ workers()-1，
+    // 同一个 worker 的调用不会并发；不能与 next 混用
+    void drain(const std::function<void(unsigned worker, RowBatch& rows)>& sink);
+
+protected:
+    bool produce(RowBatch& batch) override;
+
+private:
+    struct Morsel {
+        RowBatch rows;
+        uint64_t decoded = 0;       // 过滤前的行数
+    };
+    // 解码一块并过滤
+    void readMorsel(uint32_t morsel, Morsel& out) const;
+    // 按输出窗口补足在运行的工作任务，调用时持有 m_mutex
+    void launch();
+    void work();
+    void rethrow();
+
+    std::string m_table;
+    std::vector<FieldBlock> m_fields;
+    // 在构造时（查询线程上）取得：数据库中的堆文件表不是线程安全的，工作线程只使用这个指针
+    HeapFile* m_heap;
+    std::unique_ptr<Predicate> m_predicate;
+    unsigned m_workers;
+    uint32_t m_page_count = 0;
+    uint32_t m_morsels = 0;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    uint32_t m_next = 0;                    // 下一个待领取的块
+    uint32_t m_emitted = 0;                 // 下一个待输出的块
+    unsigned m_active = 0;                  // 正在运行的工作任务数
+    bool m_stop = false;
+    bool m_started = false;
+    std::map<uint32_t, Morsel> m_done;      // 已完成、等待按序输出的块
+    std::exception_ptr m_error;
+};
+
+// 索引访问：先取得候选 row_id（已升序），再按批回表读取，并用完整条件过滤
+class IndexScanOperator : public Operator {
+public:
+    IndexScanOperator(const std::string& table_name, const AccessPlan& plan, const std::string& condition);
+
+protected:
+    bool produce(RowBatch& batch) override;
+
+private:
+    std::string m_table;
+    std::vector<FieldBlock> m_fields;
+    AccessPlan m_plan;
+    std::unique_ptr<Predicate> m_predicate;
+    std::vector<uint64_t> m_ids;
+    size_t m_position = 0;
+    bool m_started = false;
+};
+
+// 按索引顺序读表：沿 B+ 树叶子链表逐个叶子取 row_id 回表读取，输出按索引字段升序（NULL 在最后）。
+// 用于 ORDER BY 索引字段 + LIMIT，取够行数后上层不再取数，不必读完整张表再排序
+class IndexOrderScanOperator : public Operator {
+public:
+    IndexOrderScanOperator(const std::string& table_name, BTree* btree, const std::string& index_name,
+        const std::string& condition);
+
+protected:
+    bool produce(RowBatch& batch) override;
+
+private:
+    std::string m_table;
+    std::vector<FieldBlock> m_fields;
+    BTree* m_btree;
+    std::unique_ptr<Predicate> m_predicate;
+    std::vector<FieldPointer> m_entries;    // 当前叶子的条目
+    uint32_t m_leaf = 0;                    // 下一个要读的叶子，0 表示已读完
+    bool m_started = false;
+};
+
+class FilterOperator : public Operator {
+public:
+    FilterOperator(std::unique_ptr<Operator> child, std::function<bool(const Row&)> predicate,
+        const std::string& name, const std::string& detail);
+    // WHERE 条件编译为谓词程序；use_prefix 为 false 时字段名可以不带表名
+    static std::unique_ptr<Operator> where(std::unique_ptr<Operator> child, const std::string& condition,
+        bool use_prefix);
+
+protected:
+    bool produce(RowBatch& batch) override;
+
+private:
+    std::unique_ptr<Operator> m_child;
+    std::function<bool(const Row&)> m_predicate;
+    RowBatch m_input;
+};
+
+// 列名不存在时输出 NULL
+class ProjectOperator : public Operator {
+public:
+    ProjectOperator(std::unique_ptr<Operator> child, const std::vector<std::string>& columns,
+        const std::string& detail);
+
+protected:
+    bool produce(RowBatch& batch) override;
+
+private:
+    std::unique_ptr<Operator> m_child;
+    std::vector<int> m_projection;
+    RowBatch m_input;
+};
+
+// 右侧第一次取数时全部读入，左侧逐批探测；resolvable 为 false 时（连接字段不存在）结果为空
+class JoinOperator : public Operator {
+public:
+    JoinOperator(std::unique_ptr<Operator> left, std::unique_ptr<Operator> right,
+        std::vector<JoinKey> keys, bool resolvable, const std::string& detail);
+
+protected:
+    bool produce(RowBatch& batch) override;
+
+private:
+    std::unique_ptr<Operator> m_left;
+    std::unique_ptr<Operator> m_right;
+    std::vector<JoinKey> m_keys;
+    bool m_resolvable;
+    std::unique_ptr<StreamJoin> m_join;
+    RowBatch m_input;
+};
+
+// 哈希分组：按一个或多个字段的类型值分组，各组只保留聚合的中间状态，不保留行。
+// 输出列为各分组字段和 columns 中的聚合列：COUNT(*)、COUNT(字段)、COUNT(DISTINCT 字段) 为整数，
+// SUM/AVG 为浮点，MIN/MAX 与源字段类型相同。
+// 组的状态超过内存预算后，尚未出现的组的行按键哈希写入磁盘分区，内存中的组输出后再逐个分区聚合
+// （分区仍放不下时再次按不同的哈希细分）。没有溢出时输出按分组值升序，溢出时每个分区内升序
+class AggregateOperator : public Operator {
+public:
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = 64 * 1024 * 1024;
+
+    AggregateOperator(std::unique_ptr<Operator> child, const std::string& group_by, const std::string& columns,
+        size_t memory_budget = DEFAULT_MEMORY_BUDGET);
+    ~AggregateOperator();
+
+protected:
+    bool produce(RowBatch& batch) override;
+
+private:
+    enum class Function { COUNT_ROWS, COUNT, COUNT_DISTINCT, SUM, AVG, MIN, MAX };
+    struct Aggregate {
+        Function function;
+        int field;                  // 源字段序号，COUNT(*) 为 -1
+    };
+    struct Accumulator {
+        int64_t count = 0;          // COUNT(*) 为行数，其余为非 NULL 值的个数
+        double sum = 0;
+        Value extreme;              // MIN/MAX 当前值
+        std::unordered_set<Value, ValueHash> distinct;
+    };
+    struct KeyHash {
+        size_t operator()(const std::vector<Value>& key) const;
+    };
+    struct KeyEqual {
+        bool operator()(const std::vector<Value>& a, const std::vector<Value>& b) const;
+    };
+    using GroupTable = std::unordered_map<std::vector<Value>, std::vector<Accumulator>, KeyHash, KeyEqual>;
+    struct Partition;
+
+    // 把一行聚合到 groups，组不在表中且 bytes 已达到 budget 时返回 false
+    bool accumulate(GroupTable& groups, size_t& bytes, size_t budget, const Row& row, std::vector<Value>& key) const;
+    // 合并同一组在另一张组表中的中间状态
+    void merge(std::vector<Accumulator>& into, std::vector<Accumulator>& from) const;
+    void spillRow(const Row& row, const std::vector<Value>& key);
+    // 读完一个输入（子算子或一个分区）的全部行
+    void consume(const std::function<bool(Row&)>& next);
+    // 子算子是并行扫描时：各工作线程先在自己的组表中局部聚合（各占预算的一份），
+    // 再合并到 m_groups；局部组表放不下的行写入临时文件，之后按普通输入处理
+    void consumeParallel(ParallelScanOperator& scan);
+    // 一个输入读完后：溢出的分区排队，当前组表按分组值排序准备输出
+    void finishInput();
+    Value result(const Aggregate& aggregate, const Accumulator& acc) const;
+
+    std::unique_ptr<Operator> m_child;
+    std::vector<int> m_group_indexes;
+    std::vector<Aggregate> m_aggregates;
+    size_t m_budget;
+
+    GroupTable m_groups;
+    size_t m_bytes = 0;                                 // 组状态的估计大小
+    unsigned m_depth = 0;                               // 当前输入的分区层数，决定分区哈希
+    std::vector<std::unique_ptr<Partition>> m_spilling; // 当前输入溢出的分区
+    std::vector<std::unique_ptr<Partition>> m_pending;  // 等待聚合的分区
+    std::vector<GroupTable::iterator> m_output;         // 当前组表按分组值排序后的输出顺序
+    size_t m_position = 0;
+    bool m_started = false;
+};
+
+// ORDER BY 的一个排序列：列序号和方向
+struct SortKey {
+    int column;
+    bool desc;
+};
+
+// 按一个或多个列稳定排序，各列的 NULL 都排在最后。
+// 每行的排序列先编码成一个字节串（规范化键），之后只按字节比较，比较时不再看值的类型。
+// 输入按内存预算分块：一块切成若干段由工作线程并行编码、排序，超过预算的块合并成一个有序段写入
+// 临时文件，最后对所有段做多路归并（段数过多时先分组归并），内存只与预算有关。
+// top_n 不为 0 且不太大时（LIMIT）只用大小为 top_n 的堆保留排在最前的行，不必对全部输入排序
+class SortOperator : public Operator {
+public:
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = 64 * 1024 * 1024;
+    static constexpr uint64_t MAX_TOP_N = 100000;       // 超过时按完整排序处理，由 LIMIT 截断
+    static constexpr size_t MIN_RUN_ROWS = 16384;       // 并行排序时每段至少的行数
+    static constexpr size_t MAX_MERGE_RUNS = 64;        // 一次归并最多同时打开的段数
+
+    SortOperator(std::unique_ptr<Operator> child, std::vector<SortKey> keys, const std::string& detail,
+        uint64_t top_n = 0, size_t memory_budget = DEFAULT_MEMORY_BUDGET);
+    ~SortOperator();
+
+protected:
+    bool produce(RowBatch& batch) override;
+
+private:
+    struct Run;
+    struct Cursor;
+
+    void encodeKey(const Row& row, std::string& key) const;
+    void sortAll();
+    void keepTop();
+    // 把 m_rows 切成若干段并行排序，spill 时把这些段合并写成一个临时文件段
+    void sortBuffer(bool spill);
+    // 按段的先后顺序多路归并，键相同时先出现的段在前，保持稳定
+    void mergeTo(std::vector<std::unique_ptr<Run>> runs, Run& out);
+    void startMerge(std::vector<std::unique_ptr<Run>> runs);
+    bool nextMerged(Row& row);
+
+    std::unique_ptr<Operator> m_child;
+    std::vector<SortKey> m_keys;
+    uint64_t m_top_n;
+    size_t m_budget;
+
+    std::vector<Row> m_rows;                        // 当前块的输入行
+    size_t m_bytes = 0;                             // 当前块的估计大小
+    std::vector<std::unique_ptr<Run>> m_runs;       // 已排序的段，按输入顺序
+    uint64_t m_spilled_runs = 0;
+    std::vector<std::unique_ptr<Run>> m_merging;    // 正在归并输出的段
+    std::vector<Cursor> m_heap;
+    bool m_sorted = false;
+};
+
+// 跳过前 offset 行，输出 limit 行后不再向子算子取数
+class LimitOperator : public Operator {
+public:
+    LimitOperator(std::unique_ptr<Operator> child, uint64_t limit, uint64_t offset);
+
+protected:
+    bool produce(RowBatch& batch) override;
+
+private:
+    std::unique_ptr<Operator> m_child;
+    uint64_t m_limit;
+    uint64_t m_offset;
+    uint64_t m_emitted = 0;
+    uint64_t m_skipped = 0;
+};
+
+#endif // EXECUTOR_H
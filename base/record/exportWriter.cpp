@@ -0,0 +1,123 @@
+#include "exportWriter.h"
+
+#include <stdexcept>
+#include <cstring>
+
+namespace {
+    // 去掉字符串和日期输出文本外层的单引号
+    std::string unquote(const std::string& s) {
+        if (s.size() >= 2 && (s.front() == '\'' || s.front() == '"') && s.back() == s.front()) {
+            return s.substr(1, s.size() - 2);
+        }
+        return s;
+    }
+
+    void append_csv_field(std::string& out, const Value& value) {
+        if (value.isNull()) return;
+        std::string text = unquote(value.toString());
+        bool needs_quotes = text.empty() || text.find_first_of(",\"\r\n") != std::string::npos;
+        if (!needs_quotes) {
+            out += text;
+            return;
+        }
+        out += '"';
+        for (char c : text) {
+            if (c == '"') out += '"';
+            out += c;
+        }
+        out += '"';
+    }
+
+    template <typename T>
+    void append_raw(std::string& out, T value) {
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        out.append(bytes, sizeof(T));
+    }
+
+    class CsvExportWriter : public ExportWriter {
+    public:
+        CsvExportWriter(const std::string& path, const RowSchema& schema, bool header) : ExportWriter(path) {
+            if (!header) return;
+            for (size_t i = 0; i < schema.size(); ++i) {
+                if (i > 0) m_buffer += ',';
+                append_csv_field(m_buffer, Value::fromString(schema.names[i]));
+            }
+            m_buffer += '\n';
+        }
+
+        void write(const Row& row) override {
+            for (size_t i = 0; i < row.values.size(); ++i) {
+                if (i > 0) m_buffer += ',';
+                append_csv_field(m_buffer, row.values[i]);
+            }
+            m_buffer += '\n';
+            ++m_rows;
+            flushIfFull();
+        }
+    };
+
+    class BinaryExportWriter : public ExportWriter {
+    public:
+        BinaryExportWriter(const std::string& path, const RowSchema& schema) : ExportWriter(path) {
+            m_buffer.append("DBMSBIN1", 8);
+            append_raw<uint32_t>(m_buffer, static_cast<uint32_t>(schema.size()));
+            for (size_t i = 0; i < schema.size(); ++i) {
+                append_raw<uint16_t>(m_buffer, static_cast<uint16_t>(schema.names[i].size()));
+                m_buffer += schema.names[i];
+                append_raw<uint8_t>(m_buffer, static_cast<uint8_t>(schema.types[i]));
+            }
+        }
+
+        void write(const Row& row) override {
+            for (const auto& value : row.values) {
+                append_raw<uint8_t>(m_buffer, static_cast<uint8_t>(value.type));
+                switch (value.type) {
+                case ValueType::INT: append_raw<int32_t>(m_buffer, value.i); break;
+                case ValueType::DOUBLE: append_raw<double>(m_buffer, value.d); break;
+                case ValueType::BOOL: append_raw<uint8_t>(m_buffer, value.b ? 1 : 0); break;
+                case ValueType::DATETIME: append_raw<int64_t>(m_buffer, static_cast<int64_t>(value.t)); break;
+                case ValueType::STRING: {
+                    std::string text = unquote(value.s);
+                    append_raw<uint32_t>(m_buffer, static_cast<uint32_t>(text.size()));
+                    m_buffer += text;
+                    break;
+                }
+                default: break;
+                }
+            }
+            ++m_rows;
+            flushIfFull();
+        }
+    };
+}
+
+std::unique_ptr<ExportWriter> ExportWriter::open(const std::string& path, ExportFormat format,
+    const RowSchema& schema, bool header) {
+    if (format == ExportFormat::BINARY) {
+        return std::make_unique<BinaryExportWriter>(path, schema);
+    }
+    return std::make_unique<CsvExportWriter>(path, schema, header);
+}
+
+ExportWriter::ExportWriter(const std::string& path) : m_out(path, std::ios::binary | std::ios::trunc) {
+    if (!m_out) {
+        throw std::runtime_error("无法创建导出文件: " + path);
+    }
+    m_buffer.reserve(BUFFER_BYTES + 4096);
+}
+
+void ExportWriter::flush() {
+    if (m_buffer.empty()) return;
+    m_out.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+    if (!m_out) {
+        throw std::runtime_error("写入导出文件失败");
+    }
+    m_bytes += m_buffer.size();
+    m_buffer.clear();
+}
+
+void ExportWriter::close() {
+    flush();
+    m_out.close();
+}
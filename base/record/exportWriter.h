@@ -0,0 +1,51 @@
+#pragma once
+
+#ifndef EXPORTWRITER_H
+#define EXPORTWRITER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <cstdint>
+#include "row.h"
+
+// COPY ... TO 使用的结果写出器：行逐条追加到内存缓冲，缓冲满时整块写入文件，
+// 内存占用与结果行数无关
+//
+// CSV：分隔符为逗号，字符串和日期去掉外层单引号，含分隔符、双引号或换行时用双引号包围，
+//      NULL 写为空字段，空字符串写为 ""，与 LOAD DATA 的读取规则一致
+// BINARY：文件头 "DBMSBIN1" + u32 列数 + 各列 (u16 名称长度, 名称, u8 类型代码)，
+//      之后每个值为 u8 ValueType 标记加数据：INT 4 字节，DOUBLE 8 字节，BOOL 1 字节，
+//      DATETIME 8 字节，STRING u32 长度 + 内容；整数均为小端
+
+enum class ExportFormat { CSV, BINARY };
+
+class ExportWriter {
+public:
+    // 打开文件并写入文件头（CSV 时 header 为 true 写列名行），失败时抛出异常
+    static std::unique_ptr<ExportWriter> open(const std::string& path, ExportFormat format,
+        const RowSchema& schema, bool header);
+    virtual ~ExportWriter() = default;
+
+    virtual void write(const Row& row) = 0;
+    // 写出剩余缓冲并关闭文件
+    void close();
+
+    uint64_t rows() const { return m_rows; }
+    uint64_t bytes() const { return m_bytes; }
+
+protected:
+    static constexpr size_t BUFFER_BYTES = 1 << 20;
+
+    ExportWriter(const std::string& path);
+    void flushIfFull() { if (m_buffer.size() >= BUFFER_BYTES) flush(); }
+    void flush();
+
+    std::ofstream m_out;
+    std::string m_buffer;
+    uint64_t m_rows = 0;
+    uint64_t m_bytes = 0;
+};
+
+#endif // EXPORTWRITER_H
@@ -0,0 +1,120 @@
+#include "join.h"
+#include <unordered_map>
+#include <functional>
+
+namespace {
+    // 字段类型代码归类：数值类型之间可以直接比较
+    int type_class(int type) {
+        return (type == 1 || type == 2) ? 1 : type;
+    }
+
+    Row concat_rows(const Row& left, const Row& right, uint64_t row_id) {
+        Row combined;
+        combined.row_id = row_id;
+        combined.values.reserve(left.values.size() + right.values.size());
+        combined.values.insert(combined.values.end(), left.values.begin(), left.values.end());
+        combined.values.insert(combined.values.end(), right.values.begin(), right.values.end());
+        return combined;
+    }
+
+    bool keys_equal(const Row& l, const Row& r, const std::vector<JoinKey>& keys) {
+        for (const auto& key : keys) {
+            const Value& a = l.values[key.left];
+            const Value& b = r.values[key.right];
+            if (a.isNull() || b.isNull() || Value::compare(a, b) != 0) return false;
+        }
+        return true;
+    }
+
+    // 按列非递减且不含 NULL
+    bool sorted_on(const std::vector<Row>& rows, size_t column) {
+        for (size_t i = 0; i < rows.size(); ++i) {
+            if (rows[i].values[column].isNull()) return false;
+            if (i > 0 && Value::compare(rows[i - 1].values[column], rows[i].values[column]) > 0) return false;
+        }
+        return true;
+    }
+}
+
+JoinMethod choose_join_method(const RowSchema& left_schema, const RowSchema& right_schema,
+    const std::vector<JoinKey>& keys) {
+    if (keys.empty()) return JoinMethod::NESTED_LOOP;
+    for (const auto& key : keys) {
+        if (type_class(left_schema.types[key.left]) != type_class(right_schema.types[key.right])) {
+            return JoinMethod::NESTED_LOOP;
+        }
+    }
+    return JoinMethod::HASH;
+}
+
+StreamJoin::StreamJoin(std::vector<Row> right, const RowSchema& left_schema, const RowSchema& right_schema,
+    std::vector<JoinKey> keys) : m_right(std::move(right)), m_keys(std::move(keys)) {
+    m_method = choose_join_method(left_schema, right_schema, m_keys);
+    if (m_method == JoinMethod::HASH && m_keys.size() == 1 && sorted_on(m_right, m_keys[0].right)) {
+        m_method = JoinMethod::MERGE;
+    }
+    if (m_method == JoinMethod::HASH) buildHashTable();
+}
+
+bool StreamJoin::hashKeys(const Row& row, bool is_left, size_t& h) const {
+    h = 0;
+    for (const auto& key : m_keys) {
+        const Value& v = row.values[is_left ? key.left : key.right];
+        if (v.isNull()) return false;
+        h ^= ValueHash()(v) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    }
+    return true;
+}
+
+void StreamJoin::buildHashTable() {
+    m_buckets.reserve(m_right.size());
+    for (size_t i = 0; i < m_right.size(); ++i) {
+        size_t h;
+        if (hashKeys(m_right[i], false, h)) m_buckets[h].push_back(i);
+    }
+}
+
+void StreamJoin::probe(const Row& left, std::vector<Row>& out) {
+    if (m_method == JoinMethod::NESTED_LOOP) {
+        for (const auto& r : m_right) {
+            if (keys_equal(left, r, m_keys)) out.push_back(concat_rows(left, r, m_next_row_id++));
+        }
+        return;
+    }
+
+    if (m_method == JoinMethod::MERGE) {
+        const JoinKey& key = m_keys[0];
+        const Value& lv = left.values[key.left];
+        if (lv.isNull()) return;
+        if (m_last_key.isNull() || Value::compare(m_last_key, lv) <= 0) {
+            while (m_cursor < m_right.size() && Value::compare(m_right[m_cursor].values[key.right], lv) < 0) ++m_cursor;
+            // 左侧键重复时从同一位置重新扫描相等的一段
+            for (size_t k = m_cursor; k < m_right.size() && Value::compare(m_right[k].values[key.right], lv) == 0; ++k) {
+                out.push_back(concat_rows(left, m_right[k], m_next_row_id++));
+            }
+            m_last_key = lv;
+            return;
+        }
+        // 左侧不再有序，之后改为哈希探测，输出顺序不变
+        m_method = JoinMethod::HASH;
+        buildHashTable();
+    }
+
+    size_t h;
+    if (!hashKeys(left, true, h)) return;
+    auto it = m_buckets.find(h);
+    if (it == m_buckets.end()) return;
+    for (size_t index : it->second) {
+        if (keys_equal(left, m_right[index], m_keys)) {
+            out.push_back(concat_rows(left, m_right[index], m_next_row_id++));
+        }
+    }
+}
+
+std::string join_method_name(JoinMethod method) {
+    switch (method) {
+    case JoinMethod::HASH: return "Hash Join";
+    case JoinMethod::MERGE: return "Merge Join";
+    default: return "Nested Loop";
+    }
+}
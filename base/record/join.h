@@ -0,0 +1,58 @@
+#pragma once
+
+#ifndef JOIN_H
+#define JOIN_H
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include "row.h"
+
+// JOIN 算子：输入为已经按下推条件过滤过的类型行，
+// 输出为左右两侧值拼接后的行，顺序与嵌套循环一致（左侧顺序为主，右侧匹配按右表顺序）
+
+// 连接键：left 为左侧（已连接结果）中的列序号，right 为右表中的列序号
+struct JoinKey {
+    size_t left;
+    size_t right;
+};
+
+enum class JoinMethod {
+    NESTED_LOOP,    // 无连接键或键类型不兼容
+    HASH,           // 右表建哈希表，左侧逐行探测
+    MERGE           // 右侧按单个连接键有序，左侧按同一键有序到达（如按主键顺序插入或经索引有序）
+};
+
+// 只根据连接键选择（EXPLAIN 不读取数据时使用），不判断有序性，不会选择 MERGE
+JoinMethod choose_join_method(const RowSchema& left_schema, const RowSchema& right_schema,
+    const std::vector<JoinKey>& keys);
+
+// 流式连接：右侧（构建侧）一次读入，左侧逐行探测，不物化左侧。
+// 单个连接键且右侧按该键有序时先按归并方式推进右侧游标，左侧键出现逆序时改为哈希探测；
+// 新行的 row_id 从 1 开始编号；NULL 不与任何值相等
+class StreamJoin {
+public:
+    StreamJoin(std::vector<Row> right, const RowSchema& left_schema, const RowSchema& right_schema,
+        std::vector<JoinKey> keys);
+
+    // 探测一行左侧行，匹配结果追加到 out
+    void probe(const Row& left, std::vector<Row>& out);
+    // 到目前为止实际使用的算法
+    JoinMethod method() const { return m_method; }
+
+private:
+    void buildHashTable();
+    bool hashKeys(const Row& row, bool is_left, size_t& h) const;
+
+    std::vector<Row> m_right;
+    std::vector<JoinKey> m_keys;
+    JoinMethod m_method;
+    std::unordered_map<size_t, std::vector<size_t>> m_buckets;  // 右表按连接键分桶，桶内保持右表顺序
+    size_t m_cursor = 0;                                        // 归并时右侧的位置
+    Value m_last_key;                                           // 归并时上一个左侧键
+    uint64_t m_next_row_id = 1;
+};
+
+std::string join_method_name(JoinMethod method);
+
+#endif // JOIN_H
@@ -0,0 +1,392 @@
+#include "predicate.h"
+#include <stdexcept>
+#include <string_view>
+#include <cctype>
+#include <cstdlib>
+
+namespace {
+
+    enum class TokenType { IDENT, NUMBER, STRING, OP, LPAREN, RPAREN, AND, OR, END };
+
+    struct Token {
+        TokenType type;
+        std::string text;
+    };
+
+    std::string upper(std::string s) {
+        for (char& c : s) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        return s;
+    }
+
+    // 去掉尾部的 '\0' 和不可打印字符
+    std::string_view normalize(std::string_view s) {
+        while (!s.empty() && (s.back() == '\0' || !std::isprint(static_cast<unsigned char>(s.back())))) {
+            s.remove_suffix(1);
+        }
+        return s;
+    }
+
+    bool parseNumber(const std::string& text, double& value) {
+        const char* begin = text.c_str();
+        char* end = nullptr;
+        value = std::strtod(begin, &end);
+        return end != begin;
+    }
+
+    std::vector<Token> lex(const std::string& cond) {
+        std::vector<Token> tokens;
+        size_t i = 0;
+        while (i < cond.size()) {
+            char c = cond[i];
+            if (std::isspace(static_cast<unsigned char>(c))) { ++i; continue; }
+
+            if (c == '(') { tokens.push_back({ TokenType::LPAREN, "(" }); ++i; continue; }
+            if (c == ')') { tokens.push_back({ TokenType::RPAREN, ")" }); ++i; continue; }
+
+            if (c == '\'' || c == '"') {
+                size_t end = cond.find(c, i + 1);
+                if (end == std::string::npos) throw std::runtime_error("WHERE 条件中引号不匹配: " + cond);
+                tokens.push_back({ TokenType::STRING, cond.substr(i, end - i + 1) });
+                i = end + 1;
+                continue;
+            }
+
+            if (c == '=' || c == '!' || c == '<' || c == '>') {
+                std::string op(1, c);
+                if (i + 1 < cond.size() && (cond[i + 1] == '=' || (c == '<' && cond[i + 1] == '>'))) {
+                    op += cond[i + 1];
+                }
+                if (op == "!") throw std::runtime_error("WHERE 条件中存在无法识别的运算符: " + cond);
+                i += op.size();
+                if (op == "<>") op = "!=";
+                tokens.push_back({ TokenType::OP, op });
+                continue;
+            }
+
+            // 数值常量，运算符之后允许带符号
+            bool signed_number = (c == '-' || c == '+') && !tokens.empty() && tokens.back().type == TokenType::OP &&
+                i + 1 < cond.size() && std::isdigit(static_cast<unsigned char>(cond[i + 1]));
+            if (std::isdigit(static_cast<unsigned char>(c)) || signed_number) {
+                size_t start = i++;
+                while (i < cond.size() && (std::isalnum(static_cast<unsigned char>(cond[i])) || cond[i] == '.' || cond[i] == '_')) ++i;
+                tokens.push_back({ TokenType::NUMBER, cond.substr(start, i - start) });
+                continue;
+            }
+
+            if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+                size_t start = i;
+                while (i < cond.size() && (std::isalnum(static_cast<unsigned char>(cond[i])) || cond[i] == '_' || cond[i] == '.')) ++i;
+                std::string word = cond.substr(start, i - start);
+                std::string up = upper(word);
+                if (up == "AND") tokens.push_back({ TokenType::AND, up });
+                else if (up == "OR") tokens.push_back({ TokenType::OR, up });
+                else tokens.push_back({ TokenType::IDENT, word });
+                continue;
+            }
+
+            throw std::runtime_error("WHERE 条件中存在无法识别的字符: " + cond);
+        }
+        tokens.push_back({ TokenType::END, "" });
+        return tokens;
+    }
+
+    CompareOp toCompareOp(const std::string& op) {
+        if (op == "=") return CompareOp::EQ;
+        if (op == "!=") return CompareOp::NE;
+        if (op == "<") return CompareOp::LT;
+        if (op == ">") return CompareOp::GT;
+        if (op == "<=") return CompareOp::LE;
+        return CompareOp::GE;
+    }
+
+    template <typename T>
+    bool applyOp(CompareOp op, const T& a, const T& b) {
+        switch (op) {
+        case CompareOp::EQ: return a == b;
+        case CompareOp::NE: return a != b;
+        case CompareOp::LT: return a < b;
+        case CompareOp::GT: return a > b;
+        case CompareOp::LE: return a <= b;
+        case CompareOp::GE: return a >= b;
+        }
+        return false;
+    }
+
+    // 递归下降：expr := and_expr {OR and_expr}；and_expr := primary {AND primary}
+    class Compiler {
+    public:
+        Compiler(const std::vector<Token>& tokens,
+            const RowSchema& schema,
+            bool use_prefix,
+            std::vector<PredicateTerm>& terms,
+            std::vector<PredicateInstr>& program)
+            : m_tokens(tokens), m_schema(schema), m_use_prefix(use_prefix),
+            m_terms(terms), m_program(program) {}
+
+        void compile(const std::string& cond) {
+            parseOr();
+            if (peek().type != TokenType::END) {
+                throw std::runtime_error("WHERE 条件语法错误: " + cond);
+            }
+        }
+
+    private:
+        const Token& peek() const { return m_tokens[m_pos]; }
+        const Token& next() {
+            const Token& token = m_tokens[m_pos];
+            if (token.type != TokenType::END) ++m_pos;
+            return token;
+        }
+
+        void parseOr() {
+            parseAnd();
+            while (peek().type == TokenType::OR) {
+                next();
+                parseAnd();
+                m_program.push_back({ PredicateInstr::OR, 0 });
+            }
+        }
+
+        void parseAnd() {
+            parsePrimary();
+            while (peek().type == TokenType::AND) {
+                next();
+                parsePrimary();
+                m_program.push_back({ PredicateInstr::AND, 0 });
+            }
+        }
+
+        void parsePrimary() {
+            if (peek().type == TokenType::LPAREN) {
+                next();
+                parseOr();
+                if (next().type != TokenType::RPAREN) throw std::runtime_error("WHERE 条件中括号不匹配");
+                return;
+            }
+
+            const Token& left = next();
+            if (left.type != TokenType::IDENT) {
+                throw std::runtime_error("WHERE 条件左侧应为字段名: " + left.text);
+            }
+            const Token& op = next();
+            if (op.type != TokenType::OP) {
+                throw std::runtime_error("WHERE 条件缺少比较运算符: " + left.text);
+            }
+            const Token& right = next();
+            if (right.type != TokenType::IDENT && right.type != TokenType::NUMBER && right.type != TokenType::STRING) {
+                throw std::runtime_error("WHERE 条件右侧缺少比较值: " + left.text + " " + op.text);
+            }
+
+            m_program.push_back({ PredicateInstr::TERM, m_terms.size() });
+            m_terms.push_back(buildTerm(left.text, op.text, right));
+        }
+
+        PredicateTerm buildTerm(const std::string& left, const std::string& op, const Token& right) const {
+            PredicateTerm term;
+            int left_index = m_schema.find(left, !m_use_prefix);
+            if (left_index < 0) {
+                throw std::runtime_error("字段 '" + left + "' 无法匹配到记录中");
+            }
+            term.left = static_cast<size_t>(left_index);
+            term.op = toCompareOp(op);
+
+            // 右侧是字段（只按完整列名匹配）
+            if (right.type == TokenType::IDENT) {
+                int right_index = m_schema.find(right.text, false);
+                if (right_index >= 0) {
+                    term.right = static_cast<size_t>(right_index);
+                    term.kind = CompareKind::FIELD;
+                    return term;
+                }
+            }
+
+            term.right_text = right.text;
+            if (right.type == TokenType::IDENT && upper(right.text) == "NULL") {
+                if (term.op == CompareOp::EQ) term.kind = CompareKind::IS_NULL;
+                else if (term.op == CompareOp::NE) term.kind = CompareKind::NOT_NULL;
+                else term.kind = CompareKind::NEVER;
+                return term;
+            }
+
+            switch (m_schema.types[term.left]) {
+            case 1:
+            case 2:
+                term.kind = parseNumber(right.text, term.right_number) ? CompareKind::NUMBER : CompareKind::NEVER;
+                break;
+            case 3:
+                term.kind = CompareKind::TEXT;
+                term.right_text = std::string(normalize(term.right_text));
+                break;
+            case 4: {
+                term.kind = (term.op == CompareOp::EQ || term.op == CompareOp::NE) ? CompareKind::BOOL : CompareKind::NEVER;
+                std::string up = upper(right.text);
+                term.right_bool_ok = (up == "TRUE" || up == "FALSE");
+                term.right_bool = (up == "TRUE");
+                break;
+            }
+            case 5:
+                term.kind = parse_datetime(right.text, term.right_time) ? CompareKind::DATETIME : CompareKind::NEVER;
+                break;
+            default:
+                term.kind = CompareKind::NEVER;
+                break;
+            }
+            return term;
+        }
+
+        const std::vector<Token>& m_tokens;
+        const RowSchema& m_schema;
+        bool m_use_prefix;
+        std::vector<PredicateTerm>& m_terms;
+        std::vector<PredicateInstr>& m_program;
+        size_t m_pos = 0;
+    };
+}
+
+Predicate Predicate::compile(const std::string& condition, const RowSchema& schema, bool use_prefix) {
+    Predicate predicate;
+    std::vector<Token> tokens = lex(condition);
+    if (tokens.size() == 1) return predicate;   // 空条件
+
+    Compiler compiler(tokens, schema, use_prefix, predicate.m_terms, predicate.m_program);
+    compiler.compile(condition);
+    return predicate;
+}
+
+std::vector<std::string> Predicate::splitConjuncts(const std::string& condition) {
+    std::vector<Token> tokens = lex(condition);
+    tokens.pop_back();  // END
+    if (tokens.empty()) return {};
+
+    // 去掉包住整个条件的括号
+    auto enclosed = [&](size_t begin, size_t end) {
+        if (end - begin < 2 || tokens[begin].type != TokenType::LPAREN || tokens[end - 1].type != TokenType::RPAREN) return false;
+        int depth = 0;
+        for (size_t i = begin; i < end; ++i) {
+            if (tokens[i].type == TokenType::LPAREN) ++depth;
+            else if (tokens[i].type == TokenType::RPAREN) --depth;
+            if (depth == 0 && i + 1 < end) return false;
+        }
+        return true;
+    };
+    size_t begin = 0, end = tokens.size();
+    while (enclosed(begin, end)) { ++begin; --end; }
+
+    auto text = [&](size_t from, size_t to) {
+        std::string out;
+        for (size_t i = from; i < to; ++i) {
+            if (!out.empty()) out += ' ';
+            out += tokens[i].text;
+        }
+        return out;
+    };
+
+    std::vector<std::string> parts;
+    int depth = 0;
+    size_t start = begin;
+    for (size_t i = begin; i < end; ++i) {
+        switch (tokens[i].type) {
+        case TokenType::LPAREN: ++depth; break;
+        case TokenType::RPAREN: --depth; break;
+        case TokenType::OR:
+            if (depth == 0) return { text(begin, end) };
+            break;
+        case TokenType::AND:
+            if (depth == 0) {
+                parts.push_back(text(start, i));
+                start = i + 1;
+            }
+            break;
+        default: break;
+        }
+    }
+    parts.push_back(text(start, end));
+    return parts;
+}
+
+std::vector<std::string> Predicate::identifiers(const std::string& condition) {
+    std::vector<std::string> names;
+    for (const auto& token : lex(condition)) {
+        if (token.type != TokenType::IDENT) continue;
+        std::string up = upper(token.text);
+        if (up == "NULL" || up == "TRUE" || up == "FALSE") continue;
+        names.push_back(token.text);
+    }
+    return names;
+}
+
+bool Predicate::evaluateTerm(const PredicateTerm& term, const Row& row) const {
+    const Value& left = row.values[term.left];
+
+    switch (term.kind) {
+    case CompareKind::IS_NULL:
+        return left.isNull();
+    case CompareKind::NOT_NULL:
+        return !left.isNull();
+    case CompareKind::NEVER:
+        return false;
+    default:
+        break;
+    }
+    if (left.isNull()) return false;
+
+    switch (term.kind) {
+    case CompareKind::NUMBER: {
+        double a = 0;
+        if (!left.toNumber(a)) return false;
+        return applyOp(term.op, a, term.right_number);
+    }
+    case CompareKind::TEXT:
+        if (left.type != ValueType::STRING) return applyOp(term.op, left.toString(), term.right_text);
+        return applyOp(term.op, normalize(left.s), std::string_view(term.right_text));
+    case CompareKind::DATETIME:
+        if (left.type != ValueType::DATETIME) return false;
+        return applyOp(term.op, left.t, term.right_time);
+    case CompareKind::BOOL: {
+        bool equal = term.right_bool_ok && left.type == ValueType::BOOL
+            ? left.b == term.right_bool
+            : left.toString() == term.right_text;
+        return term.op == CompareOp::EQ ? equal : !equal;
+    }
+    case CompareKind::FIELD: {
+        const Value& right = row.values[term.right];
+        if (right.isNull()) return false;
+        return applyOp(term.op, Value::compare(left, right), 0);
+    }
+    default:
+        return false;
+    }
+}
+
+bool Predicate::evaluate(const Row& row) const {
+    if (m_program.empty()) return true;
+
+    // 程序很短，用定长栈避免逐行分配
+    bool stack[64];
+    std::vector<bool> overflow;
+    size_t top = 0;
+    auto push = [&](bool v) {
+        if (top < 64) stack[top] = v;
+        else overflow.push_back(v);
+        ++top;
+    };
+    auto pop = [&]() -> bool {
+        --top;
+        if (top < 64) return stack[top];
+        bool v = overflow.back();
+        overflow.pop_back();
+        return v;
+    };
+
+    for (const auto& instr : m_program) {
+        if (instr.kind == PredicateInstr::TERM) {
+            push(evaluateTerm(m_terms[instr.term], row));
+        }
+        else {
+            bool b = pop();
+            bool a = pop();
+            push(instr.kind == PredicateInstr::AND ? (a && b) : (a || b));
+        }
+    }
+    return pop();
+}
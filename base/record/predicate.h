@@ -0,0 +1,68 @@
+#pragma once
+
+#ifndef PREDICATE_H
+#define PREDICATE_H
+
+#include <string>
+#include <vector>
+#include <ctime>
+#include "row.h"
+
+// WHERE 条件编译后的谓词程序：
+// 每条语句只解析一次条件，字段名解析为列序号，常量预先转换成对应类型，
+// 比较运算按字段类型绑定，之后逐行执行时不再做正则匹配和字符串查找
+
+enum class CompareOp { EQ, NE, LT, GT, LE, GE };
+
+// 按左侧字段类型选择的比较方式
+enum class CompareKind {
+    NUMBER,     // INTEGER / DOUBLE：按 double 比较
+    BOOL,       // 只支持 = 和 !=
+    TEXT,       // VARCHAR：去掉尾部不可见字符后按字符串比较
+    DATETIME,   // 按 time_t 比较
+    FIELD,      // 右侧也是字段：按 Value::compare 比较
+    IS_NULL,    // 与 NULL 常量比较：= NULL
+    NOT_NULL,   // != NULL
+    NEVER       // 类型未知或常量无法转换，恒为 false
+};
+
+struct PredicateTerm {
+    size_t left = 0;            // 左侧字段的列序号
+    CompareOp op = CompareOp::EQ;
+    CompareKind kind = CompareKind::NEVER;
+
+    size_t right = 0;           // 右侧为字段时的列序号
+    std::string right_text;     // 右侧常量原文（含引号）
+    double right_number = 0;    // 预解析的常量
+    bool right_bool = false;
+    bool right_bool_ok = false;
+    std::time_t right_time = 0;
+};
+
+// 逆波兰形式的指令：TERM 计算一个比较并压栈，AND/OR 弹出两个结果
+struct PredicateInstr {
+    enum Kind { TERM, AND, OR } kind;
+    size_t term = 0;
+};
+
+class Predicate {
+public:
+    // use_prefix 为 false 时允许用不带表名的字段名匹配 "表名.字段名"
+    static Predicate compile(const std::string& condition, const RowSchema& schema, bool use_prefix);
+
+    bool evaluate(const Row& row) const;
+    bool empty() const { return m_program.empty(); }
+
+    // 按顶层 AND 拆分条件；顶层含 OR 时整体作为一个子条件返回
+    static std::vector<std::string> splitConjuncts(const std::string& condition);
+    // 条件中出现的字段名（不含 NULL/TRUE/FALSE）
+    static std::vector<std::string> identifiers(const std::string& condition);
+
+private:
+    bool evaluateTerm(const PredicateTerm& term, const Row& row) const;
+
+    std::vector<PredicateTerm> m_terms;
+    std::vector<PredicateInstr> m_program;
+};
+
+#endif // PREDICATE_H
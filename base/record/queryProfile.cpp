@@ -0,0 +1,80 @@
+#include "queryProfile.h"
+#include "manager/dbManager.h"
+
+namespace {
+    void buffer_pool_counters(uint64_t& pages, uint64_t& misses) {
+        BufferPool::Stats stats = dbManager::getInstance().get_current_database()->getBufferPool().getStats();
+        pages = stats.hits + stats.misses;
+        misses = stats.misses;
+    }
+}
+
+ResultSet QueryProfile::toResultSet() const {
+    ResultSet result;
+    result.columns = { "阶段", "说明", "估计行数" };
+    if (m_analyze) {
+        result.columns.insert(result.columns.end(),
+            { "输入行数", "输出行数", "耗时(ms)", "访问页数", "磁盘读取(字节)", "内存分配次数" });
+    }
+
+    for (const auto& stage : m_stages) {
+        Row row;
+        row.values.push_back(Value::fromString(stage.name));
+        row.values.push_back(Value::fromString(stage.detail));
+        row.values.push_back(stage.estimated_rows < 0 ? Value::fromString("-")
+            : Value::fromInt(static_cast<int32_t>(stage.estimated_rows + 0.5)));
+        if (m_analyze) {
+            row.values.push_back(Value::fromInt(static_cast<int32_t>(stage.rows_in)));
+            row.values.push_back(Value::fromInt(static_cast<int32_t>(stage.rows_out)));
+            row.values.push_back(Value::fromDouble(stage.elapsed_ms));
+            row.values.push_back(Value::fromInt(static_cast<int32_t>(stage.pages)));
+            row.values.push_back(Value::fromString(std::to_string(stage.bytes_read)));
+            // 不统计内存分配：替换全局 operator new 会让所有分配都承担计数的开销
+            row.values.push_back(Value::fromString("-"));
+        }
+        result.rows.push_back(std::move(row));
+    }
+    return result;
+}
+
+StageTimer::StageTimer(QueryProfile* profile, const std::string& name, const std::string& detail,
+    double estimated_rows) : m_profile(profile) {
+    if (!m_profile) return;
+
+    StageProfile stage;
+    stage.name = name;
+    stage.detail = detail;
+    stage.estimated_rows = estimated_rows;
+    m_profile->m_stages.push_back(std::move(stage));
+    m_stage = m_profile->m_stages.size() - 1;
+
+    if (m_profile->m_analyze) {
+        m_start = ProfileSnapshot::take();
+    }
+}
+
+void StageTimer::setDetail(const std::string& detail) {
+    if (m_profile) m_profile->m_stages[m_stage].detail = detail;
+}
+
+void StageTimer::finish(uint64_t rows_in, uint64_t rows_out) {
+    if (!m_profile || !m_profile->m_analyze) return;
+
+    StageProfile& stage = m_profile->m_stages[m_stage];
+    stage.rows_in = rows_in;
+    stage.rows_out = rows_out;
+    m_start.addTo(stage, ProfileSnapshot::take());
+}
+
+ProfileSnapshot ProfileSnapshot::take() {
+    ProfileSnapshot snapshot;
+    buffer_pool_counters(snapshot.pages, snapshot.misses);
+    snapshot.time = std::chrono::steady_clock::now();
+    return snapshot;
+}
+
+void ProfileSnapshot::addTo(StageProfile& stage, const ProfileSnapshot& later) const {
+    stage.elapsed_ms += std::chrono::duration_cast<std::chrono::microseconds>(later.time - time).count() / 1000.0;
+    stage.pages += later.pages - pages;
+    stage.bytes_read += (later.misses - misses) * BufferPool::PAGE_SIZE;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#ifndef QUERYPROFILE_H
+#define QUERYPROFILE_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include "row.h"
+
+// EXPLAIN / EXPLAIN ANALYZE 使用的查询剖析信息：
+// 查询按执行顺序记录为若干阶段（读表、连接、过滤、分组、排序、投影），
+// 只做 EXPLAIN 时不读取数据，只记录每个阶段选择的算法和估计行数
+
+struct StageProfile {
+    std::string name;               // 阶段，如 "Scan T"、"Hash Join"
+    std::string detail;             // 访问路径、连接键、条件等
+    double estimated_rows = -1;     // 优化器估计的输出行数，-1 表示没有估计
+    uint64_t rows_in = 0;
+    uint64_t rows_out = 0;
+    double elapsed_ms = 0;
+    uint64_t pages = 0;             // 经缓冲池访问的页数
+    uint64_t bytes_read = 0;        // 缓冲池未命中时从磁盘读取的字节数
+};
+
+// 某一时刻的累计计数，两次快照之差即这段执行的耗时、访问页数和磁盘读取
+struct ProfileSnapshot {
+    std::chrono::steady_clock::time_point time;
+    uint64_t pages = 0;
+    uint64_t misses = 0;
+
+    static ProfileSnapshot take();
+    // 把 [*this, later) 之间的开销累加到 stage
+    void addTo(StageProfile& stage, const ProfileSnapshot& later) const;
+};
+
+class QueryProfile {
+public:
+    explicit QueryProfile(bool analyze) : m_analyze(analyze) {}
+
+    // false 时只生成计划，各阶段不读取数据
+    bool analyze() const { return m_analyze; }
+    const std::vector<StageProfile>& stages() const { return m_stages; }
+
+    // 按阶段输出为结果集，交给 Output 按查询结果的格式打印
+    ResultSet toResultSet() const;
+    // 追加一个已统计好的阶段（执行器的算子在查询结束后按执行顺序写入）
+    void addStage(StageProfile stage) { m_stages.push_back(std::move(stage)); }
+
+private:
+    friend class StageTimer;
+
+    bool m_analyze;
+    std::vector<StageProfile> m_stages;
+};
+
+// 记录一个阶段：构造时开始计时并记下缓冲池计数，finish 时给出输入输出行数
+// profile 为空时不做任何事，正常查询没有额外开销
+class StageTimer {
+public:
+    StageTimer(QueryProfile* profile, const std::string& name, const std::string& detail = "",
+        double estimated_rows = -1);
+
+    void setDetail(const std::string& detail);
+    void finish(uint64_t rows_in, uint64_t rows_out);
+
+private:
+    QueryProfile* m_profile;
+    size_t m_stage = 0;
+    ProfileSnapshot m_start;
+};
+
+#endif // QUERYPROFILE_H
@@ -155,17 +155,8 @@ bool Record::check_table_level_constraint(const ConstraintBlock& constraint, con
 }
 
 std::vector<ConstraintBlock> Record::read_constraints(const std::string& table_name) {
-    std::vector<ConstraintBlock> constraints;
-    std::string tic_filename = dbManager::getInstance().get_current_database()->getDBPath() + "/" + table_name + ".tic";
-    std::ifstream file(tic_filename, std::ios::binary);
-    if (!file) return constraints;
-
-    ConstraintBlock constraint;
-    while (file.read(reinterpret_cast<char*>(&constraint), sizeof(ConstraintBlock))) {
-        constraints.push_back(constraint);
-    }
-    file.close();
-    return constraints;
+    auto schema = dbManager::getInstance().get_current_database()->getCatalog().find(table_name);
+    return schema ? schema->constraints : std::vector<ConstraintBlock>();
 }
 
 bool Record::check_constraints(const std::vector<std::string>& columns,
@@ -244,12 +235,12 @@ bool Record::check_primary_key_constraint(const ConstraintBlock& constraint, con
         std::cerr << "主键不能为NULL: " << constraint.field << std::endl;
         return false;
     }
-    std::string condition = std::string(constraint.field) + " = " + value;
     try {
-        if (!select("*", table_name, condition,"","","").empty()) {
+        if (key_exists(constraint.field, value)) {
             std::cerr << "主键重复: " << constraint.field << " = " << value << std::endl;
             return false;
         }
+        remember_key(constraint.field, value);
     }
     catch (...) {
         return false;
@@ -280,12 +271,12 @@ bool Record::check_foreign_key_constraint(const ConstraintBlock& constraint, con
 
 bool Record::check_unique_constraint(const ConstraintBlock& constraint, const std::string& value) {
     if (is_null(value)) return true;
-    std::string condition = std::string(constraint.field) + " = " + value ;
     try {
-        if (!select("*", table_name, condition,"","","").empty()) {
+        if (key_exists(constraint.field, value)) {
             std::cerr << "唯一约束违反: " << constraint.field << " = " << value << std::endl;
             return false;
         }
+        remember_key(constraint.field, value);
     }
     catch (...) {
         return false;
@@ -311,7 +302,7 @@ bool Record::check_check_constraint(const ConstraintBlock& constraint, const std
         double numeric_value = std::stod(clean_value);
 
         // 1. BETWEEN x AND y
-        std::regex between_regex(R"(BETWEEN\s+(\d+)\s+AND\s+(\d+))", std::regex_constants::icase);
+        static const std::regex between_regex(R"(BETWEEN\s+(\d+)\s+AND\s+(\d+))", std::regex_constants::icase);
         std::smatch matches;
         if (std::regex_search(check_expr, matches, between_regex)) {
             double lower = std::stod(matches[1]);
@@ -320,7 +311,7 @@ bool Record::check_check_constraint(const ConstraintBlock& constraint, const std
         }
 
         // 2. IN (x, y, z, ...)
-        std::regex in_regex(R"(IN\s*\(([^)]+)\))", std::regex_constants::icase);
+        static const std::regex in_regex(R"(IN\s*\(([^)]+)\))", std::regex_constants::icase);
         if (std::regex_search(check_expr, matches, in_regex)) {
             std::unordered_set<std::string> in_values;
             std::stringstream ss(matches[1]);
@@ -365,23 +356,32 @@ bool Record::check_default_constraint(const ConstraintBlock& constraint, std::st
     return true;
 }
 
+// 自增字段的当前最大值缓存在表对象中，只在第一次使用时扫描一遍表
 bool Record::check_auto_increment_constraint(const ConstraintBlock& constraint, std::string& value) {
-    if (is_null(value)) {
+    Table* table = target_table ? target_table : dbManager::getInstance().get_current_database()->getTable(table_name);
+    long long max_val = 0;
+    if (!table->getAutoIncrement(constraint.field, max_val)) {
         try {
-            auto records = select(constraint.field, table_name, "","","","");
-            int max_val = 0;
-            for (const auto& rec : records) {
-                const auto& vals = rec.get_values();
-                if (!vals.empty() && !is_null(vals[0])) {
-                    int v = std::stoi(vals[0]);
-                    max_val = std::max(max_val, v);
+            RowSchema schema;
+            int pos = -1;
+            scan_rows(table_name, schema, [&](Row& row) {
+                if (pos < 0) pos = schema.find(constraint.field);
+                double v = 0;
+                if (pos >= 0 && row.values[pos].toNumber(v)) {
+                    max_val = std::max(max_val, static_cast<long long>(v));
                 }
-            }
-            value = std::to_string(max_val + 1);
+                return true;
+                });
         }
         catch (...) {
             return false;
         }
+        table->setAutoIncrement(constraint.field, max_val);
+    }
+
+    // 缓存在记录写入成功后才推进，违反其它约束的插入不占用自增值
+    if (is_null(value)) {
+        value = std::to_string(max_val + 1);
     }
     else {
         try {
@@ -395,6 +395,81 @@ bool Record::check_auto_increment_constraint(const ConstraintBlock& constraint,
     return true;
 }
 
+Value Record::field_value(const FieldBlock& field, const std::string& value) {
+    // 与写入时走同一套编码，再按存储格式解码
+    std::vector<FieldBlock> single{ field };
+    std::string raw = encode_record(0, 0, single, std::vector<std::string>{ value });
+    Row row;
+    decode_row(raw.data(), single, row, /*skip_deleted=*/false);
+    return row.values.empty() ? Value::null() : row.values[0];
+}
+
+bool Record::key_exists(const std::string& field_name, const std::string& value) {
+    Table* table = target_table ? target_table : dbManager::getInstance().get_current_database()->getTable(table_name);
+    const std::vector<FieldBlock>& fields = table->getFields();
+    auto field_it = std::find_if(fields.begin(), fields.end(),
+        [&](const FieldBlock& f) { return field_name == f.name; });
+    if (field_it == fields.end()) return false;
+    size_t pos = field_it - fields.begin();
+    Value key = field_value(*field_it, value);
+
+    // 同一语句中先前的行还没有写入，单独记录
+    auto pending = pending_keys.find(field_name);
+    if (pending != pending_keys.end() && pending->second.count(key)) return true;
+
+    for (const auto& index : table->getIndexes()) {
+        if (index.field_num != 1 || field_name != index.field[0]) continue;
+        BTree* btree = table->getBTreeByIndexName(index.name);
+        if (!btree) continue;
+
+        // 索引中的条目可能指向待删除的记录，回表确认
+        HeapFile& heap = heap_file(table_name, fields);
+        std::string raw;
+        Row row;
+        for (const auto& fieldPtr : btree->find(value)) {
+            if (heap.read(fieldPtr.recordPtr.row_id, raw) &&
+                decode_row(raw.data(), fields, row, /*skip_deleted=*/true) &&
+                row.values[pos] == key) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 没有索引：多行插入时扫描一遍收集已有的键，单行插入扫描到第一条匹配为止
+    if (batch_size > 1) {
+        auto scanned = scanned_keys.find(field_name);
+        if (scanned == scanned_keys.end()) {
+            scanned = scanned_keys.emplace(field_name, std::set<Value>()).first;
+            RowSchema schema;
+            scan_rows(table_name, schema, [&](Row& row) {
+                if (!row.values[pos].isNull()) scanned->second.insert(std::move(row.values[pos]));
+                return true;
+                });
+        }
+        return scanned->second.count(key) > 0;
+    }
+
+    bool found = false;
+    RowSchema schema;
+    scan_rows(table_name, schema, [&](Row& row) {
+        found = row.values[pos] == key;
+        return !found;
+        });
+    return found;
+}
+
+void Record::remember_key(const std::string& field_name, const std::string& value) {
+    if (batch_size <= 1) return;
+    Table* table = target_table ? target_table : dbManager::getInstance().get_current_database()->getTable(table_name);
+    for (const auto& field : table->getFields()) {
+        if (field_name == field.name) {
+            pending_keys[field_name].insert(field_value(field, value));
+            return;
+        }
+    }
+}
+
 bool Record::check_references_before_delete(const std::string& table_name,
     const std::unordered_map<std::string, std::string>& record_data) {
     std::vector<std::string> all_tables;
@@ -14,35 +14,83 @@
 #include <algorithm>
 
 void Record::insert_record(const std::string& table_name, const std::string& cols, const std::string& vals) {
+    insert_records(table_name, cols, { vals });
+}
+
+size_t Record::insert_records(const std::string& table_name, const std::string& cols, const std::vector<std::string>& value_lists) {
     this->table_name = table_name;
     if (!table_exists(this->table_name)) {
         throw std::runtime_error("表 '" + this->table_name + "' 不存在。");
     }
+    // 字段和约束取自内存中的表对象，整批只取一次
+    target_table = dbManager::getInstance().get_current_database()->getTable(this->table_name);
+    table_fields = target_table->getFields();
+    table_structure = table_structure_of(table_fields);
+    batch_size = value_lists.size();
+    pending_keys.clear();
+    scanned_keys.clear();
+
+    std::vector<std::string> insert_columns;
     if (!cols.empty()) {
         parse_columns(cols);
-        parse_values(vals);
         validate_columns();
-        validate_types();
+        insert_columns = columns;
     }
     else {
         // 没有指定列名，自动使用所有字段
-            std::vector<FieldBlock> fields = read_field_blocks(table_name);
-        columns.clear();
-        for (const auto& field : fields) {
-            columns.push_back(field.name);
+        for (const auto& field : table_fields) {
+            insert_columns.push_back(field.name);
         }
+    }
 
-        parse_values(vals);
+    // 写入前失败时恢复自增缓存，整批插入不占用自增值
+    std::vector<std::pair<std::string, long long>> saved_auto_increment;
+    bool auto_increment_cached = true;
+    for (const auto& constraint : target_table->getConstraints()) {
+        long long value = 0;
+        if (constraint.type != 7) continue;
+        if (target_table->getAutoIncrement(constraint.field, value)) saved_auto_increment.emplace_back(constraint.field, value);
+        else auto_increment_cached = false;
+    }
 
-        if (columns.size() != values.size()) {
-            throw std::runtime_error("插入值数量与表字段数量不匹配");
+    auto& transactionManager = TransactionManager::instance();
+    bool writing = false;
+    try {
+        // 第一遍：逐行解析并检查约束，全部通过后才开始写入，违反约束时整批都不插入
+        std::vector<std::vector<std::string>> rows;
+        rows.reserve(value_lists.size());
+        for (const auto& vals : value_lists) {
+            columns = insert_columns;
+            parse_values(vals);
+            if (cols.empty() && columns.size() != values.size()) {
+                throw std::runtime_error("插入值数量与表字段数量不匹配");
+            }
+            validate_types();
+            rows.push_back(prepare_row());
         }
 
-        validate_types();
+        // 第二遍：写入堆文件，之后按批更新索引，都完成后才提交（自动提交时）
+        writing = true;
+        std::vector<RecordPointer> record_ptrs = write_rows(rows);
+        updateIndexesAfterInsert(table_name, rows, record_ptrs);
+        transactionManager.commitImplicitTransaction();
+        return rows.size();
+    }
+    catch (const std::exception& e) {
+        if (writing) {
+            // 已开始写入：回滚事务，自增缓存不再可信，下次插入时重新扫描
+            if (transactionManager.isActive()) transactionManager.rollback();
+            target_table->resetAutoIncrement();
+        }
+        else {
+            if (!auto_increment_cached) target_table->resetAutoIncrement();
+            for (const auto& [field, value] : saved_auto_increment) {
+                target_table->setAutoIncrement(field, value);
+            }
+        }
+        std::cerr << "插入记录失败: " << e.what() << std::endl;
+        throw; // 重新抛出异常以便外部捕获
     }
-    insert_into();
-    // 新增：插入后更新所有相关索引
-    updateIndexesAfterInsert(table_name);
 }
 
 void Record::parse_columns(const std::string& cols) {
@@ -85,121 +133,126 @@ void Record::parse_values(const std::string& vals) {
     }
 }
 
-void Record::insert_into() {
-    auto& transactionManager = TransactionManager::instance();
-    transactionManager.beginImplicitTransaction(); //自动判断
-    try {
-        std::vector<FieldBlock> fields = read_field_blocks(table_name);
-        std::unordered_map<std::string, size_t> field_indices;
-        for (size_t i = 0; i < fields.size(); ++i) {
-            field_indices[fields[i].name] = i;
-        }
-
-        std::vector<std::string> record_values(fields.size(), "NULL");
-        for (size_t i = 0; i < columns.size(); ++i) {
-            size_t idx = field_indices[columns[i]];
-            record_values[idx] = values[i];
-        }
+std::vector<std::string> Record::prepare_row() {
+    const std::vector<FieldBlock>& fields = table_fields;
+    std::unordered_map<std::string, size_t> field_indices;
+    for (size_t i = 0; i < fields.size(); ++i) {
+        field_indices[fields[i].name] = i;
+    }
 
-        // 完整字段名和值
-        std::vector<std::string> all_columns;
-        for (const auto& field : fields) {
-            all_columns.push_back(field.name);
-        }
-        std::vector<std::string> all_values = record_values;
+    std::vector<std::string> record_values(fields.size(), "NULL");
+    for (size_t i = 0; i < columns.size(); ++i) {
+        size_t idx = field_indices[columns[i]];
+        record_values[idx] = values[i];
+    }
 
-        std::vector<ConstraintBlock> constraints = read_constraints(table_name);
-        if (!check_constraints(all_columns, all_values, constraints)) {
-            throw std::runtime_error("插入数据违反表约束");
-        }
+    // 完整字段名和值
+    std::vector<std::string> all_columns;
+    for (const auto& field : fields) {
+        all_columns.push_back(field.name);
+    }
 
-        // 同步 DEFAULT 修改后的 all_values 回 record_values
-        record_values = all_values;
+    // DEFAULT 和自增在检查约束时直接填入 record_values
+    if (!check_constraints(all_columns, record_values, target_table->getConstraints())) {
+        throw std::runtime_error("插入数据违反表约束");
+    }
 
-        // 校验类型
-        for (size_t i = 0; i < fields.size(); ++i) {
-            const FieldBlock& field = fields[i];
-            std::string& value = record_values[i];  // 不是 const 引用
+    // 校验类型
+    for (size_t i = 0; i < fields.size(); ++i) {
+        const FieldBlock& field = fields[i];
+        const std::string& value = record_values[i];
 
-            if (value == "NULL") continue;
+        if (value == "NULL") continue;
 
-            // 再检查类型是否合法
-            if (!is_valid_type(value, get_type_string(field.type))) {
-                throw std::runtime_error("字段 '" + std::string(field.name) + "' 的值 '" + value + "' 不符合类型要求");
-            }
+        // 再检查类型是否合法
+        if (!is_valid_type(value, get_type_string(field.type))) {
+            throw std::runtime_error("字段 '" + std::string(field.name) + "' 的值 '" + value + "' 不符合类型要求");
         }
+    }
 
-        // 写入数据
-        std::string file_name = dbManager::getInstance().get_current_database()->getDBPath() + "/" + this->table_name + ".trd";
-        std::ofstream file(file_name, std::ios::app | std::ios::binary);
-        if (!file) {
-            throw std::runtime_error("打开文件" + file_name + "失败。");
-        }
+    // 推进自增字段的缓存，同一批次的下一行从这里继续分配
+    for (const auto& constraint : target_table->getConstraints()) {
+        long long max_val = 0;
+        auto it = field_indices.find(constraint.field);
+        if (constraint.type != 7 || it == field_indices.end() || record_values[it->second] == "NULL" ||
+            !target_table->getAutoIncrement(constraint.field, max_val)) continue;
+        target_table->setAutoIncrement(constraint.field, std::max(max_val, std::stoll(record_values[it->second])));
+    }
+    return record_values;
+}
 
-        // 生成 row_id：当前记录数量 + 1（或其他唯一生成逻辑）
-        uint64_t row_id = static_cast<uint64_t>(dbManager::getInstance().get_current_database()->getTable(table_name)->getRecordCount()) + 1;
+std::vector<RecordPointer> Record::write_rows(const std::vector<std::vector<std::string>>& rows) {
+    auto& transactionManager = TransactionManager::instance();
+    transactionManager.beginImplicitTransaction(); //自动判断
 
-        // 写入 row_id
-        file.write(reinterpret_cast<const char*>(&row_id), sizeof(uint64_t));
+    const std::vector<FieldBlock>& fields = table_fields;
 
-        // 写入 delete_flag（默认为未删除）
-        char delete_flag = 0;
-        file.write(&delete_flag, sizeof(char));
+    // row_id 按堆文件的分配顺序预先确定，先写日志再修改数据页（预写日志）：
+    // 数据页在日志追加之后才被修改，任何时候写回都不会早于描述它的日志
+    HeapFile& heap = heap_file(this->table_name, fields);
+    std::vector<RecordPointer> record_ptrs;
+    record_ptrs.reserve(rows.size());
+    uint64_t next_row_id = heap.nextRowId();
+    for (size_t r = 0; r < rows.size(); ++r) {
+        record_ptrs.push_back(RecordPointer{ next_row_id + r });
+    }
 
-        // 写入字段内容
-        for (size_t i = 0; i < fields.size(); ++i) {
-            write_field(file, fields[i], record_values[i]); // 保持原逻辑
+    if (transactionManager.isActive()||(!transactionManager.isActive()&&transactionManager.isAutoCommit())) {
+        // 把字段名和数据打包成 pair，整批作为一组日志写入
+        std::vector<std::pair<uint64_t, std::vector<std::pair<std::string, std::string>>>> inserts;
+        inserts.reserve(rows.size());
+        for (size_t r = 0; r < rows.size(); ++r) {
+            std::vector<std::pair<std::string, std::string>> insert_values;
+            for (size_t i = 0; i < fields.size(); ++i) {
+                insert_values.emplace_back(fields[i].name, rows[r][i]);
+            }
+            inserts.emplace_back(record_ptrs[r].row_id, std::move(insert_values));
         }
 
-        file.close();
+        // 记录到日志
+        LogManager::instance().logInsertBatch(this->table_name, inserts);
+    }
 
-        dbManager::getInstance().get_current_database()->getTable(table_name)->incrementRecordCount(1);
-        dbManager::getInstance().get_current_database()->getTable(table_name)->setLastModifyTime(std::time(nullptr));
+    // 写入中途失败时已写入的行由事务回滚删除
+    for (const auto& record_ptr : record_ptrs) {
+        transactionManager.addUndo(DmlType::INSERT, this->table_name, record_ptr.row_id);
+    }
 
-        std::cout << "记录插入表 " << this->table_name << " 成功，row_id = " << row_id << "。" << std::endl;
-        
-        transactionManager.addUndo(DmlType::INSERT, this->table_name, row_id);
-       
-        if (transactionManager.isActive()||(!transactionManager.isActive()&&transactionManager.isAutoCommit())) {
-            // 把字段名和数据打包成 pair
-            std::vector<std::pair<std::string, std::string>> insert_values;
-            for (size_t i = 0; i < fields.size(); ++i) {
-                insert_values.emplace_back(fields[i].name, record_values[i]);
-            }
+    // 写入数据：放入有空闲空间的页；row_id + delete_flag（默认为未删除）+ 字段内容
+    for (size_t r = 0; r < rows.size(); ++r) {
+        heap.insertWithRowId(encode_record(record_ptrs[r].row_id, 0, fields, rows[r]));
+    }
 
-            // 记录到日志
-            LogManager::instance().logInsert(this->table_name, row_id, insert_values);
-        }
-        transactionManager.commitImplicitTransaction();
+    // 记录数和修改时间只改内存，.tb 在卸载数据库时统一写回
+    target_table->incrementRecordCount(static_cast<int>(rows.size()));
+    target_table->setLastModifyTime(std::time(nullptr));
+
+    if (rows.size() == 1) {
+        std::cout << "记录插入表 " << this->table_name << " 成功，row_id = " << record_ptrs[0].row_id << "。" << std::endl;
     }
-    catch (const std::exception& e) {
-        //transactionManager.rollback();
-        std::cerr << "插入记录失败: " << e.what() << std::endl;
-        throw; // 重新抛出异常以便外部捕获
+    else if (!rows.empty()) {
+        std::cout << "记录插入表 " << this->table_name << " 成功，共 " << rows.size() << " 条，row_id = "
+            << record_ptrs.front().row_id << " ~ " << record_ptrs.back().row_id << "。" << std::endl;
     }
+    return record_ptrs;
 }
 
 void Record::insertByRowid(uint64_t rowId, const std::vector<std::pair<std::string, std::string>>& values) {
-    std::string file_path = dbManager::getInstance().get_current_database()->getDBPath() + "/" + this->table_name + ".trd";
-    std::ofstream file(file_path, std::ios::app | std::ios::binary);
-    if (!file) throw std::runtime_error("无法打开文件以插入");
-
     std::vector<FieldBlock> fields = read_field_blocks(this->table_name);
-
-    file.write(reinterpret_cast<const char*>(&rowId), sizeof(uint64_t));
-    char delete_flag = 0;
-    file.write(&delete_flag, sizeof(char));
+    HeapFile& heap = heap_file(this->table_name, fields);
 
     std::unordered_map<std::string, std::string> val_map;
     for (const auto& [col, val] : values) {
         val_map[col] = val;
     }
 
-    for (const auto& field : fields) {
-        std::string value = val_map.count(field.name) ? val_map[field.name] : "NULL";
-        write_field(file, field, value);
-    }
+    // 已存在则覆盖（重做日志可能重复执行）
+    bool existed = heap.contains(rowId);
+    heap.insertWithRowId(encode_record(rowId, 0, fields, val_map));
 
-    file.close();
-    dbManager::getInstance().get_current_database()->getTable(table_name)->incrementRecordCount(1);
+    Table* table = dbManager::getInstance().get_current_database()->getTable(table_name);
+    if (!existed) {
+        table->incrementRecordCount(1);
+    }
+    table->resetAutoIncrement();
 }
@@ -0,0 +1,409 @@
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+
+#include "Record.h"
+#include "parse/parse.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <climits>
+#include <cstring>
+#include <functional>
+
+namespace {
+
+constexpr size_t LOAD_CHUNK_BYTES = 16 * 1024 * 1024;   // 每次读入并并行处理的字节数
+constexpr size_t MAX_REPORTED_ERRORS = 10;              // 最多报告的被拒绝行原因
+
+// 按分隔符拆分一行 CSV，支持双引号包围的字段和 "" 转义；引号未闭合时返回 false
+bool split_csv_line(const char* begin, const char* end, char delimiter,
+    std::vector<std::string>& fields, std::vector<bool>& quoted) {
+    fields.clear();
+    quoted.clear();
+    std::string current;
+    bool in_quotes = false, was_quoted = false;
+    for (const char* p = begin; p < end; ++p) {
+        char c = *p;
+        if (in_quotes) {
+            if (c == '"') {
+                if (p + 1 < end && p[1] == '"') { current += '"'; ++p; }
+                else in_quotes = false;
+            }
+            else current += c;
+        }
+        else if (c == '"' && current.empty()) {
+            in_quotes = was_quoted = true;
+        }
+        else if (c == delimiter) {
+            fields.push_back(std::move(current));
+            quoted.push_back(was_quoted);
+            current.clear();
+            was_quoted = false;
+        }
+        else if (c != '\r') {
+            current += c;
+        }
+    }
+    fields.push_back(std::move(current));
+    quoted.push_back(was_quoted);
+    return !in_quotes;
+}
+
+// CSV 中的文本转换为 INSERT 语句中的值写法（字符串和时间带单引号），不合法时返回 false
+bool to_literal(const FieldBlock& field, std::string text, bool quoted, std::string& out) {
+    if (!quoted) {
+        text.erase(0, text.find_first_not_of(" \t"));
+        text.erase(text.find_last_not_of(" \t") + 1);
+        if (text.empty() || text == "\\N" || text == "NULL") {
+            out = "NULL";
+            return true;
+        }
+    }
+
+    const char* begin = text.c_str();
+    char* end = nullptr;
+    switch (field.type) {
+    case 1: {
+        long long v = std::strtoll(begin, &end, 10);
+        if (end == begin || *end != '\0' || v < INT_MIN || v > INT_MAX) return false;
+        out = std::to_string(v);
+        return true;
+    }
+    case 2:
+        std::strtod(begin, &end);
+        if (end == begin || *end != '\0') return false;
+        out = text;
+        return true;
+    case 3:
+        out = "'" + text + "'";
+        return out.size() <= static_cast<size_t>(field.param);
+    case 4: {
+        std::string lower = text;
+        std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+        if (lower == "true" || lower == "1") out = "true";
+        else if (lower == "false" || lower == "0") out = "false";
+        else return false;
+        return true;
+    }
+    case 5: {
+        std::time_t t;
+        out = "'" + text + "'";
+        return parse_datetime(out, t);
+    }
+    default:
+        return false;
+    }
+}
+
+// 把 [0, count) 均分给 threads 个线程执行 work(begin, end)
+void parallel_for(size_t count, unsigned threads, const std::function<void(size_t, size_t)>& work) {
+    threads = static_cast<unsigned>(std::min<size_t>(threads, std::max<size_t>(1, count / 1024)));
+    if (threads <= 1) {
+        work(0, count);
+        return;
+    }
+    std::vector<std::thread> pool;
+    size_t step = (count + threads - 1) / threads;
+    for (size_t begin = 0; begin < count; begin += step) {
+        pool.emplace_back(work, begin, std::min(count, begin + step));
+    }
+    for (auto& t : pool) t.join();
+}
+
+}
+
+LoadResult Record::load_data(const std::string& table_name, const std::string& file_path, char delimiter, size_t skip_lines) {
+    auto start = std::chrono::steady_clock::now();
+    this->table_name = table_name;
+    if (!table_exists(this->table_name)) {
+        throw std::runtime_error("表 '" + this->table_name + "' 不存在。");
+    }
+    std::ifstream in(file_path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("无法打开数据文件: " + file_path);
+    }
+
+    target_table = dbManager::getInstance().get_current_database()->getTable(this->table_name);
+    table_fields = target_table->getFields();
+    const std::vector<FieldBlock>& fields = table_fields;
+    const std::vector<ConstraintBlock>& constraints = target_table->getConstraints();
+    batch_size = SIZE_MAX;  // 唯一性检查按批进行：没有索引的字段扫描一次收集已有的键
+    pending_keys.clear();
+    scanned_keys.clear();
+
+    std::unordered_map<std::string, size_t> field_indices;
+    for (size_t i = 0; i < fields.size(); ++i) {
+        field_indices[fields[i].name] = i;
+    }
+    auto field_pos = [&](const char* name) {
+        auto it = field_indices.find(name);
+        return it == field_indices.end() ? SIZE_MAX : it->second;
+    };
+
+    // 外键引用的值在导入前一次读入
+    std::vector<std::pair<size_t, std::set<Value>>> foreign_keys;
+    for (const auto& constraint : constraints) {
+        if (constraint.type != 2 || field_pos(constraint.field) == SIZE_MAX) continue;
+        std::istringstream ss(constraint.param);
+        std::string ref_table, ref_field;
+        std::getline(ss, ref_table, '.');
+        std::getline(ss, ref_field);
+        std::set<Value> referenced;
+        RowSchema schema;
+        int pos = -1;
+        scan_rows(ref_table, schema, [&](Row& row) {
+            if (pos < 0) pos = schema.find(ref_field);
+            if (pos >= 0 && !row.values[pos].isNull()) referenced.insert(row.values[pos]);
+            return true;
+            });
+        foreign_keys.emplace_back(field_pos(constraint.field), std::move(referenced));
+    }
+
+    // 文件大小用于在写入前估计导入行数
+    in.seekg(0, std::ios::end);
+    uint64_t file_bytes = static_cast<uint64_t>(std::max<std::streamoff>(0, in.tellg()));
+    in.seekg(0, std::ios::beg);
+
+    LoadResult result;
+    uint64_t rows_before = heap_file(table_name, fields).size();
+    HeapFile& heap = heap_file(table_name, fields);
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // 单字段索引的新条目，导入量相对表很小时逐条插入，否则导入后整体重建。
+    // 在第一块写入前按文件大小估计导入行数并决定走哪条路，只有逐条插入时才收集条目
+    std::vector<std::pair<BTree*, size_t>> single_indexes;
+    for (const auto& index : target_table->getIndexes()) {
+        BTree* btree = target_table->getBTreeByIndexName(index.name);
+        if (btree && index.field_num == 1 && field_pos(index.field[0]) != SIZE_MAX) {
+            single_indexes.emplace_back(btree, field_pos(index.field[0]));
+        }
+    }
+    std::vector<std::vector<FieldPointer>> index_entries(single_indexes.size());
+    bool decided = false, rebuild = true;
+
+    auto reject = [&](size_t line_no, const std::string& reason) {
+        ++result.rejected;
+        if (result.errors.size() < MAX_REPORTED_ERRORS) {
+            result.errors.push_back("第 " + std::to_string(line_no) + " 行: " + reason);
+        }
+    };
+
+    auto& transactionManager = TransactionManager::instance();
+    transactionManager.beginImplicitTransaction();
+    bool logging = transactionManager.isActive() || transactionManager.isAutoCommit();
+    bool indexing = false;
+    try {
+        std::string buffer, carry;
+        size_t line_no = 0;
+        std::vector<char> chunk(LOAD_CHUNK_BYTES);
+        while (in || !carry.empty()) {
+            in.read(chunk.data(), chunk.size());
+            size_t got = static_cast<size_t>(in.gcount());
+            buffer = std::move(carry);
+            buffer.append(chunk.data(), got);
+            carry.clear();
+            if (in) {
+                // 不完整的最后一行留到下一块
+                size_t last = buffer.rfind('\n');
+                if (last == std::string::npos) { carry = std::move(buffer); continue; }
+                carry = buffer.substr(last + 1);
+                buffer.resize(last + 1);
+            }
+            if (buffer.empty()) break;
+
+            // 切分行
+            std::vector<std::pair<const char*, const char*>> lines;
+            std::vector<size_t> line_numbers;
+            const char* p = buffer.data();
+            const char* end = p + buffer.size();
+            while (p < end) {
+                const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+                const char* line_end = nl ? nl : end;
+                ++line_no;
+                if (line_no > skip_lines && line_end > p && !(line_end - p == 1 && *p == '\r')) {
+                    lines.emplace_back(p, line_end);
+                    line_numbers.push_back(line_no);
+                }
+                p = nl ? nl + 1 : end;
+            }
+            result.lines += lines.size();
+            if (!decided && !lines.empty()) {
+                // 按本块的平均行长估计整个文件的行数
+                uint64_t estimated = static_cast<uint64_t>(static_cast<double>(file_bytes) / buffer.size() * lines.size());
+                rebuild = estimated * 4 >= rows_before;
+                decided = true;
+            }
+
+            // 第一阶段（并行）：拆分字段、转换类型，补 DEFAULT，检查 CHECK 约束
+            std::vector<std::vector<std::string>> rows(lines.size());
+            std::vector<std::string> errors(lines.size());
+            parallel_for(lines.size(), threads, [&](size_t begin, size_t stop) {
+                std::vector<std::string> parts;
+                std::vector<bool> quoted;
+                for (size_t i = begin; i < stop; ++i) {
+                    if (!split_csv_line(lines[i].first, lines[i].second, delimiter, parts, quoted)) {
+                        errors[i] = "引号未闭合";
+                        continue;
+                    }
+                    if (parts.size() != fields.size()) {
+                        errors[i] = "字段数 " + std::to_string(parts.size()) + " 与表字段数 " + std::to_string(fields.size()) + " 不匹配";
+                        continue;
+                    }
+                    std::vector<std::string> values(fields.size());
+                    for (size_t f = 0; f < fields.size() && errors[i].empty(); ++f) {
+                        if (!to_literal(fields[f], parts[f], quoted[f], values[f])) {
+                            errors[i] = "字段 '" + std::string(fields[f].name) + "' 的值 '" + parts[f] + "' 不符合类型要求";
+                        }
+                    }
+                    if (!errors[i].empty()) continue;
+
+                    std::unordered_map<std::string, std::string> column_values;
+                    for (const auto& constraint : constraints) {
+                        size_t pos = field_pos(constraint.field);
+                        if (constraint.type == 6 && pos != SIZE_MAX && values[pos] == "NULL") {
+                            values[pos] = constraint.param;
+                        }
+                        else if (constraint.type == 3 && pos != SIZE_MAX && !check_check_constraint(constraint, values[pos])) {
+                            errors[i] = "违反约束 " + std::string(constraint.name);
+                            break;
+                        }
+                        else if (constraint.type == 3 && std::strlen(constraint.field) == 0) {
+                            if (column_values.empty()) {
+                                for (size_t f = 0; f < fields.size(); ++f) column_values[fields[f].name] = values[f];
+                            }
+                            if (!check_table_level_constraint(constraint, column_values)) {
+                                errors[i] = "违反约束 " + std::string(constraint.name);
+                                break;
+                            }
+                        }
+                    }
+                    if (errors[i].empty()) rows[i] = std::move(values);
+                }
+                });
+
+            // 第二阶段（串行）：分配自增值，检查非空、唯一性和外键
+            std::vector<char> accepted(lines.size(), 0);
+            for (size_t i = 0; i < lines.size(); ++i) {
+                if (!errors[i].empty()) { reject(line_numbers[i], errors[i]); continue; }
+                std::vector<std::string>& values = rows[i];
+                std::string error;
+                for (const auto& constraint : constraints) {
+                    size_t pos = field_pos(constraint.field);
+                    if (pos == SIZE_MAX) continue;
+                    std::string& value = values[pos];
+                    if (constraint.type == 7) {
+                        long long max_val = 0;
+                        if (!target_table->getAutoIncrement(constraint.field, max_val)) {
+                            std::string probe = "NULL";
+                            check_auto_increment_constraint(constraint, probe);
+                            target_table->getAutoIncrement(constraint.field, max_val);
+                        }
+                        if (value == "NULL") value = std::to_string(max_val + 1);
+                        target_table->setAutoIncrement(constraint.field, std::max(max_val, std::stoll(value)));
+                    }
+                    else if ((constraint.type == 1 || constraint.type == 5) && value == "NULL") {
+                        error = "字段 '" + std::string(constraint.field) + "' 不能为 NULL";
+                    }
+                    else if ((constraint.type == 1 || constraint.type == 4) && value != "NULL" && key_exists(constraint.field, value)) {
+                        error = "字段 '" + std::string(constraint.field) + "' 的值 " + value + " 重复";
+                    }
+                    if (!error.empty()) break;
+                }
+                for (const auto& [pos, referenced] : foreign_keys) {
+                    if (error.empty() && values[pos] != "NULL" && !referenced.count(field_value(fields[pos], values[pos]))) {
+                        error = "外键字段 '" + std::string(fields[pos].name) + "' 的值 " + values[pos] + " 在被引用表中不存在";
+                    }
+                }
+                if (!error.empty()) { reject(line_numbers[i], error); continue; }
+                for (const auto& constraint : constraints) {
+                    size_t pos = field_pos(constraint.field);
+                    if ((constraint.type == 1 || constraint.type == 4) && pos != SIZE_MAX && values[pos] != "NULL") {
+                        remember_key(constraint.field, values[pos]);
+                    }
+                }
+                accepted[i] = 1;
+            }
+
+            // row_id 按堆文件的分配顺序预先确定，本块的日志先于数据页写入（预写日志）
+            std::vector<uint64_t> row_ids(lines.size(), 0);
+            const uint64_t first_row_id = heap.nextRowId();
+            uint64_t next_row_id = first_row_id;
+            for (size_t i = 0; i < lines.size(); ++i) {
+                if (accepted[i]) row_ids[i] = next_row_id++;
+            }
+
+            // 第三阶段（并行）：编码为记录
+            std::vector<std::string> encoded(lines.size());
+            parallel_for(lines.size(), threads, [&](size_t begin, size_t stop) {
+                for (size_t i = begin; i < stop; ++i) {
+                    if (accepted[i]) encoded[i] = encode_record(row_ids[i], 0, fields, rows[i]);
+                }
+                });
+
+            // 第四阶段（串行）：先写日志和撤销信息，再写入堆文件并收集索引条目
+            if (logging) {
+                std::vector<std::pair<uint64_t, std::vector<std::pair<std::string, std::string>>>> inserts;
+                for (size_t i = 0; i < lines.size(); ++i) {
+                    if (!accepted[i]) continue;
+                    std::vector<std::pair<std::string, std::string>> insert_values;
+                    for (size_t f = 0; f < fields.size(); ++f) {
+                        insert_values.emplace_back(fields[f].name, rows[i][f]);
+                    }
+                    inserts.emplace_back(row_ids[i], std::move(insert_values));
+                }
+                if (!inserts.empty()) {
+                    LogManager::instance().logInsertBatch(this->table_name, inserts);
+                }
+            }
+            // 本块的 row_id 连续，撤销信息只记一个范围（与前一块合并）
+            transactionManager.addInsertRange(this->table_name, first_row_id, next_row_id - first_row_id);
+            for (size_t i = 0; i < lines.size(); ++i) {
+                if (!accepted[i]) continue;
+                heap.insertWithRowId(encoded[i]);
+                target_table->incrementRecordCount(1);
+                ++result.loaded;
+                for (size_t k = 0; k < single_indexes.size() && !rebuild; ++k) {
+                    index_entries[k].push_back(FieldPointer{ single_indexes[k].first->makeKey(rows[i][single_indexes[k].second]), RecordPointer{ row_ids[i] } });
+                }
+            }
+        }
+
+        // 导入量不小于原表的四分之一时整体重建索引（自底向上批量构建），否则排序后逐条插入
+        if (result.loaded > 0) {
+            indexing = true;
+            if (rebuild) {
+                target_table->rebuildIndexes();
+            }
+            else {
+                for (size_t k = 0; k < single_indexes.size(); ++k) {
+                    std::sort(index_entries[k].begin(), index_entries[k].end(), [](const FieldPointer& a, const FieldPointer& b) {
+                        return BTree::compare(a, b) < 0;
+                        });
+                    for (const auto& entry : index_entries[k]) {
+                        single_indexes[k].first->insert(entry);
+                    }
+                    std::vector<FieldPointer>().swap(index_entries[k]);
+                }
+            }
+            target_table->setLastModifyTime(std::time(nullptr));
+        }
+        transactionManager.commitImplicitTransaction();
+    }
+    catch (const std::exception& e) {
+        // 已写入的行随事务回滚，回滚时一次删除导入的行并重建索引；
+        // 不在事务中时行保留，索引可能只更新了一部分，按表重建；自增缓存下次插入时重新扫描
+        if (transactionManager.isActive()) transactionManager.rollback();
+        else if (indexing) target_table->rebuildIndexes();
+        target_table->resetAutoIncrement();
+        throw std::runtime_error("导入失败，已回滚: " + std::string(e.what()));
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
@@ -1,8 +1,13 @@
 #include "parse/parse.h"
 #include "Record.h"
 #include "ui/output.h"
+#include "join.h"
+#include "queryProfile.h"
+#include "executor.h"
 
 #include <algorithm>
+#include <cctype>
+#include <iterator>
 #include <iostream>
 #include <map>
 #include <regex>
@@ -11,456 +16,384 @@
 #include <unordered_map>
 #include <vector>
 
-std::vector<Record> Record::select(
-    const std::string& columns,
-    const std::string& table_name,
-    const std::string& condition,
-    const std::string& group_by,
-    const std::string& order_by,
-    const std::string& having,
-    const JoinInfo* join_info)
-{
-    std::vector<Record> records;
-    std::vector<std::pair<uint64_t, std::unordered_map<std::string, std::string>>> filtered;
-    std::unordered_map<std::string, std::string> combined_structure;
-
-    // ==================== 1️⃣  表读取处理 ====================
-    std::vector<std::string> tables;
-    if (join_info && !join_info->tables.empty()) {
-        tables = join_info->tables;
+namespace {
+    // 全表扫描：表足够大且 max_parallel_workers 大于 1 时按块并行扫描
+    std::unique_ptr<Operator> scan_table(const std::string& table, const std::string& prefix,
+        const std::string& detail, double estimated_rows) {
+        unsigned workers = ParallelScanOperator::plannedWorkers(table);
+        if (workers > 1) {
+            return std::make_unique<ParallelScanOperator>(table, prefix, workers, detail, estimated_rows);
+        }
+        return std::make_unique<ScanOperator>(table, prefix, detail, estimated_rows);
     }
-    else {
-        if (table_name.find(',') != std::string::npos) {
-            std::istringstream ss(table_name);
-            std::string table;
-            while (std::getline(ss, table, ',')) {
-                table.erase(0, table.find_first_not_of(" \t"));
-                table.erase(table.find_last_not_of(" \t") + 1);
-                tables.push_back(table);
+
+    // 在扫描之后过滤：并行扫描时在各工作线程中过滤
+    std::unique_ptr<Operator> filter_scan(std::unique_ptr<Operator> scan, const std::string& condition,
+        bool use_prefix) {
+        if (auto* parallel = dynamic_cast<ParallelScanOperator*>(scan.get())) {
+            parallel->pushFilter(condition, use_prefix);
+            return scan;
+        }
+        return FilterOperator::where(std::move(scan), condition, use_prefix);
+    }
+
+    // 读取一张连接输入表：列名加表名前缀，并先应用只涉及该表字段的 WHERE 子条件
+    std::unique_ptr<Operator> join_input(const std::string& table, const std::vector<std::string>& conjuncts,
+        std::vector<bool>& consumed, bool explain) {
+        if (!Record::table_exists(table)) {
+            throw std::runtime_error("表 '" + table + "' 不存在。");
+        }
+        std::unique_ptr<Operator> scan = scan_table(table, table, "FULL SCAN",
+            explain ? static_cast<double>(AccessPlanner::plan(table, "").table_rows) : -1);
+
+        std::string pushed;
+        for (size_t i = 0; i < conjuncts.size(); ++i) {
+            if (consumed[i]) continue;
+            std::vector<std::string> names = Predicate::identifiers(conjuncts[i]);
+            if (names.empty()) continue;
+            bool local = true;
+            for (const auto& name : names) {
+                if (scan->schema().find(name) < 0) { local = false; break; }
             }
+            if (!local) continue;
+            pushed += (pushed.empty() ? "(" : " AND (") + conjuncts[i] + ")";
+            consumed[i] = true;
         }
-        else {
-            tables.push_back(table_name);
+        if (pushed.empty()) return scan;
+        return filter_scan(std::move(scan), pushed, true);
+    }
+
+    std::string join_keys_text(const std::vector<JoinKey>& keys, const RowSchema& left, const RowSchema& right) {
+        std::string text;
+        for (const auto& key : keys) {
+            if (!text.empty()) text += " AND ";
+            text += left.names[key.left] + " = " + right.names[key.right];
         }
+        return text.empty() ? "无连接键" : text;
     }
 
-    // ==================== 2️⃣  数据读取 ====================
-    if (join_info && !join_info->tables.empty()) {
-        // 读取第一个表并添加表名前缀
-        auto first_table_records = read_records(join_info->tables[0]);
-        std::vector<std::pair<uint64_t, std::unordered_map<std::string, std::string>>> result;
-
-        for (const auto& [row_id, rec] : first_table_records) {
-            std::unordered_map<std::string, std::string> prefixed;
-            for (const auto& [k, v] : rec) {
-                std::string full_key = join_info->tables[0] + "." + k;
-                prefixed[full_key] = v;
-                combined_structure[full_key] = read_table_structure_static(join_info->tables[0]).at(k);
+    // WHERE 中形如 "a.x = b.y" 且两侧分属已连接结果和右表的子条件，转为连接键
+    void extract_where_keys(const RowSchema& left_schema, const RowSchema& right_schema,
+        const std::vector<std::string>& conjuncts, std::vector<bool>& consumed, std::vector<JoinKey>& keys) {
+        static const std::regex equality(R"(^\s*([\w.]+)\s*=\s*([\w.]+)\s*$)");
+        for (size_t i = 0; i < conjuncts.size(); ++i) {
+            if (consumed[i]) continue;
+            std::smatch m;
+            if (!std::regex_match(conjuncts[i], m, equality)) continue;
+            int l = left_schema.find(m[1]);
+            int r = right_schema.find(m[2]);
+            if (l < 0 || r < 0) {
+                l = left_schema.find(m[2]);
+                r = right_schema.find(m[1]);
             }
-            result.emplace_back(row_id, std::move(prefixed));
+            if (l < 0 || r < 0) continue;
+            keys.push_back({ static_cast<size_t>(l), static_cast<size_t>(r) });
+            consumed[i] = true;
+        }
+    }
+
+    bool apply_compare(const std::string& op, int c) {
+        if (op == "=") return c == 0;
+        if (op == "!=") return c != 0;
+        if (op == ">") return c > 0;
+        if (op == "<") return c < 0;
+        if (op == ">=") return c >= 0;
+        if (op == "<=") return c <= 0;
+        return true;
+    }
+
+    std::string strip_quotes(const std::string& s) {
+        if (s.size() >= 2 && s.front() == '\'' && s.back() == '\'') return s.substr(1, s.size() - 2);
+        return s;
+    }
+
+    // HAVING 只支持 "列 比较符 常量"，其他形式不过滤
+    std::unique_ptr<Operator> having_filter(std::unique_ptr<Operator> child, const std::string& having) {
+        static const std::regex pattern(R"(\s*(\w+\(.*\)|\w+)\s*(>=|<=|!=|=|>|<)\s*(\S+))");
+        std::smatch match;
+        if (!std::regex_match(having, match, pattern)) return child;
+
+        int col_index = child->schema().find(match[1]);
+        std::string op = match[2];
+        std::string rhs = strip_quotes(match[3]);
+        double rnum = 0;
+        bool rhs_numeric = false;
+        try {
+            size_t used = 0;
+            rnum = std::stod(rhs, &used);
+            rhs_numeric = (used == rhs.size());
         }
+        catch (...) {}
 
-        // 连接其他表
-        for (size_t i = 1; i < join_info->tables.size(); ++i) {
-            auto right_table_records = read_records(join_info->tables[i]);
-            std::vector<std::pair<uint64_t, std::unordered_map<std::string, std::string>>> right_prefixed;
-
-            // 给右表添加前缀
-            for (const auto& [row_id, rec] : right_table_records) {
-                std::unordered_map<std::string, std::string> prefixed;
-                for (const auto& [k, v] : rec) {
-                    std::string full_key = join_info->tables[i] + "." + k;
-                    prefixed[full_key] = v;
-                    combined_structure[full_key] = read_table_structure_static(join_info->tables[i]).at(k);
-                }
-                right_prefixed.emplace_back(row_id, std::move(prefixed));
+        auto eval_having = [=](const Row& row) -> bool {
+            if (col_index < 0) return false;
+            const Value& lhs = row.values[col_index];
+            if (lhs.isNull()) return false;
+
+            double lnum = 0;
+            if (rhs_numeric && lhs.toNumber(lnum)) {
+                return apply_compare(op, lnum < rnum ? -1 : (lnum > rnum ? 1 : 0));
             }
+            return apply_compare(op, strip_quotes(lhs.toString()).compare(rhs));
+            };
+        return std::make_unique<FilterOperator>(std::move(child), eval_having, "Having", having);
+    }
 
-            // 执行JOIN操作
-            std::vector<std::pair<uint64_t, std::unordered_map<std::string, std::string>>> new_result;
-            uint64_t row = 1;  // 初始化行号
+    // ORDER BY 字段上的单字段索引，可以按索引顺序读表；字符串键在索引中可能被截断，不按它排序
+    BTree* order_index(const std::string& table_name, const std::string& key, std::string& index_name) {
+        Table* table = dbManager::getInstance().get_current_database()->getTable(table_name);
+        for (const auto& field : table->getFields()) {
+            if (key == field.name && field.type == 3) return nullptr;
+        }
+        for (const auto& index : table->getIndexes()) {
+            if (index.field_num != 1 || key != index.field[0]) continue;
+            if (BTree* btree = table->getBTreeByIndexName(index.name)) {
+                index_name = index.name;
+                return btree;
+            }
+        }
+        return nullptr;
+    }
 
-            for (const auto& [row_r1, r1] : result) {
-                for (const auto& [row_r2, r2] : right_prefixed) {
-                    bool match = true;
+    // ORDER BY 列表中的一项："字段 [ASC|DESC]"
+    struct OrderItem {
+        std::string column;
+        bool desc;
+    };
+
+    std::vector<OrderItem> parse_order_by(const std::string& order_by) {
+        static const std::regex pattern(R"(^(.+?)(?:\s+(ASC|DESC))?$)", std::regex::icase);
+        std::vector<OrderItem> items;
+        for (const auto& item : Record::parse_column_list(order_by)) {
+            std::smatch m;
+            if (item.empty() || !std::regex_match(item, m, pattern)) continue;
+            items.push_back({ m[1].str(), m[2].matched && std::toupper(m[2].str()[0]) == 'D' });
+        }
+        return items;
+    }
 
-                    // 检查所有可能的JOIN条件
+    // 把 SELECT 编译为算子树：读表（单表时按代价选择全表扫描或索引访问）→ 连接 → 过滤 → 分组
+    // → HAVING → 排序 → LIMIT → 投影。explain 为 true 时计算各阶段的估计行数
+    std::unique_ptr<Operator> build_plan(
+        const std::string& columns,
+        const std::string& table_name,
+        const std::string& condition,
+        const std::string& group_by,
+        const std::string& order_by,
+        const std::string& having,
+        const JoinInfo* join_info,
+        const LimitClause* limit,
+        bool explain)
+    {
+        std::vector<OrderItem> order_items = parse_order_by(order_by);
+        bool index_ordered = false;     // 读表时已按 ORDER BY 的顺序输出
+
+        // ==================== 1️⃣  表读取处理 ====================
+        std::vector<std::string> tables;
+        if (join_info && !join_info->tables.empty()) {
+            tables = join_info->tables;
+        }
+        else {
+            if (table_name.find(',') != std::string::npos) {
+                std::istringstream ss(table_name);
+                std::string table;
+                while (std::getline(ss, table, ',')) {
+                    table.erase(0, table.find_first_not_of(" \t"));
+                    table.erase(table.find_last_not_of(" \t") + 1);
+                    tables.push_back(table);
+                }
+            }
+            else {
+                tables.push_back(table_name);
+            }
+        }
+        bool has_join = (join_info != nullptr) || tables.size() > 1;
+
+        // ==================== 2️⃣  数据读取 ====================
+        // 多表时 WHERE 按顶层 AND 拆分：只涉及单表的子条件下推到该表的扫描之后立即过滤，
+        // 跨表的等值条件转为连接键，其余在连接后再过滤
+        std::vector<std::string> conjuncts;
+        if (has_join && !condition.empty()) conjuncts = Predicate::splitConjuncts(condition);
+        std::vector<bool> consumed(conjuncts.size(), false);
+
+        std::unique_ptr<Operator> root;
+        if (has_join) {
+            root = join_input(tables[0], conjuncts, consumed, explain);
+
+            // 连接其他表
+            for (size_t i = 1; i < tables.size(); ++i) {
+                std::unique_ptr<Operator> right = join_input(tables[i], conjuncts, consumed, explain);
+                const RowSchema& schema = root->schema();
+                const RowSchema& right_schema = right->schema();
+
+                // 把涉及当前表和已处理表的 JOIN 条件解析为连接键
+                std::vector<JoinKey> keys;
+                bool resolvable = true;
+                if (join_info) {
                     for (const auto& join : join_info->joins) {
-                        // 检查此JOIN条件是否涉及当前正在处理的表
                         bool involves_current_table =
-                            join.left_table == join_info->tables[i] ||
-                            join.right_table == join_info->tables[i];
-
+                            join.left_table == tables[i] ||
+                            join.right_table == tables[i];
                         if (!involves_current_table) continue;
 
-                        std::string other_table = (join.left_table == join_info->tables[i])
+                        std::string other_table = (join.left_table == tables[i])
                             ? join.right_table
                             : join.left_table;
 
                         bool involves_processed_table = false;
                         for (size_t j = 0; j < i; ++j) {
-                            if (other_table == join_info->tables[j]) {
+                            if (other_table == tables[j]) {
                                 involves_processed_table = true;
                                 break;
                             }
                         }
                         if (!involves_processed_table) continue;
 
-                        // 应用JOIN条件
                         for (const auto& [left_col, right_col] : join.conditions) {
                             std::string left_field = join.left_table + "." + left_col;
                             std::string right_field = join.right_table + "." + right_col;
+                            bool current_is_left = (join.left_table == tables[i]);
 
-                            std::string field1, field2;
-                            if (join.left_table == join_info->tables[i]) {
-                                field1 = left_field;
-                                field2 = right_field;
-                            }
-                            else {
-                                field1 = right_field;
-                                field2 = left_field;
-                            }
-
-                            auto current_field_it = r2.find(field1);
-                            auto previous_field_it = r1.find(field2);
-
-                            if (current_field_it == r2.end() || previous_field_it == r1.end() ||
-                                current_field_it->second != previous_field_it->second) {
-                                match = false;
+                            int current_index = right_schema.find(current_is_left ? left_field : right_field);
+                            int previous_index = schema.find(current_is_left ? right_field : left_field);
+                            if (current_index < 0 || previous_index < 0) {
+                                resolvable = false;
                                 break;
                             }
+                            keys.push_back({ static_cast<size_t>(previous_index), static_cast<size_t>(current_index) });
                         }
-                        if (!match) break;
-                    }
-
-                    if (match) {
-                        auto combined = r1;
-                        combined.insert(r2.begin(), r2.end());
-                        new_result.emplace_back(row, std::move(combined));  // 使用 row 作为新的 row_id
-                        ++row;  // 自增
+                        if (!resolvable) break;
                     }
                 }
-            }
-            result = std::move(new_result);
-        }
-        filtered = std::move(result);
-    }
-    else if (tables.size() == 1) {
-        // 单表查询
-        if (!table_exists(tables[0])) {
-            throw std::runtime_error("表 '" + tables[0] + "' 不存在。");
-        }
-        filtered = read_records(tables[0]);
-        combined_structure = read_table_structure_static(tables[0]);
-    }
-    else {
-        // 隐式连接处理
-        auto first_table_records = read_records(tables[0]);
-        combined_structure = read_table_structure_static(tables[0]);
-        filtered = std::move(first_table_records);
-
-        // 初始化行号
-        uint64_t row = 1;
-
-        for (size_t i = 1; i < tables.size(); ++i) {
-            if (!table_exists(tables[i])) {
-                throw std::runtime_error("表 '" + tables[i] + "' 不存在。");
-            }
-
-            auto right_structure = read_table_structure_static(tables[i]);
-            auto right_records = read_records(tables[i]);
-
-            // 添加前缀
-            std::vector<std::pair<uint64_t, std::unordered_map<std::string, std::string>>> right_prefixed;
-            for (const auto& [row_id, rec] : right_records) {
-                std::unordered_map<std::string, std::string> prefixed;
-                for (const auto& [k, v] : rec) {
-                    std::string full_key = tables[i] + "." + k;
-                    prefixed[full_key] = v;
-                    combined_structure[full_key] = right_structure.at(k);
-                }
-                right_prefixed.emplace_back(row_id, std::move(prefixed));
-            }
+                extract_where_keys(schema, right_schema, conjuncts, consumed, keys);
 
-            // 执行连接
-            std::vector<std::pair<uint64_t, std::unordered_map<std::string, std::string>>> new_result;
-            for (const auto& [row_r1, r1] : filtered) {
-                for (const auto& [row_r2, r2] : right_prefixed) {
-                    auto combined = r1;
-                    combined.insert(r2.begin(), r2.end());
-                    new_result.emplace_back(row, std::move(combined));  // 这里有序递增
-                    ++row;
-                }
+                std::string detail = join_keys_text(keys, schema, right_schema);
+                root = std::make_unique<JoinOperator>(std::move(root), std::move(right), std::move(keys), resolvable, detail);
             }
-            filtered = std::move(new_result);
         }
-}
-
-    // ==================== 3️⃣  WHERE 过滤 ====================
-    Record temp;
-    temp.set_table_name(tables.size() == 1 ? tables[0] : "");
-    temp.table_structure = combined_structure;
-    if (!condition.empty()) temp.parse_condition(condition);
-
-    auto map_filtered = vectorToMap(filtered);
-
-    // 构造共享指针列表（避免析构）
-    std::vector<std::shared_ptr<Table>> table_ptrs;
-    for (const auto& name : tables) {
-        Table* raw_table = dbManager::getInstance().get_current_database()->getTable(name);
-        table_ptrs.push_back(std::shared_ptr<Table>(raw_table, [](Table*) {}));
-    }
-
-    // 判断是否有索引字段
-    bool has_index = false;
-    for (const auto& table : table_ptrs) {
-        for (const auto& idx : table->getIndexes()) {
-            if (condition.find(idx.field[0]) != std::string::npos) {
-                has_index = true;
-                break;
-            }
-        }
-        if (has_index) break;
-    }
-
-    // 根据是否有索引决定处理方式
-    std::vector<std::pair<uint64_t, std::unordered_map<std::string, std::string>>> condition_filtered;
-
-    if (has_index) {
-        condition_filtered = temp.selectByIndex(map_filtered, table_ptrs, combined_structure, join_info != nullptr || tables.size() > 1);
-    }
-    else {
-        // fallback：直接根据 matches_condition 过滤
-        for (const auto& [row_id, rec] : map_filtered) {
-            if (condition.empty() || temp.matches_condition(rec, join_info != nullptr || tables.size() > 1)) {
-                condition_filtered.emplace_back(row_id, rec);
-            }
-        }
-    }
-    // ==================== 4️⃣  GROUP BY 和 聚合函数 ====================
-    if (!group_by.empty()) {
-        // 按组分类记录
-        std::map<std::string, std::vector<std::unordered_map<std::string, std::string>>> grouped;
-        for (const auto& [_, rec] : condition_filtered) {
-            auto it = rec.find(group_by);
-            if (it == rec.end()) {
-                throw std::runtime_error("GROUP BY 字段 '" + group_by + "' 不存在于某条记录中");
-            }
-            std::string key = it->second;
-            grouped[key].push_back(rec);
-        }
-
-        // 定义应用聚合函数的lambda表达式
-        auto apply_aggregates = [](const std::string& col, const std::vector<std::unordered_map<std::string, std::string>>& records) -> std::string {
-            // 如果不是聚合函数，直接返回空
-            if (col.find("(") == std::string::npos) return "";
-
-            std::string field = col.substr(col.find("(") + 1, col.length() - col.find("(") - 2);
-            if (records.empty() || records[0].find(field) == records[0].end()) {
-                return "NULL";
-            }
-
-            if (col.find("COUNT(") == 0) {
-                return std::to_string(records.size());
-            }
-            else if (col.find("SUM(") == 0) {
-                double sum = 0;
-                for (const auto& r : records) {
-                    auto it = r.find(field);
-                    if (it != r.end() && it->second != "NULL")
-                        sum += std::stod(it->second);
-                }
-                return std::to_string(sum);
-            }
-            else if (col.find("AVG(") == 0) {
-                double sum = 0;
-                int count = 0;
-                for (const auto& r : records) {
-                    auto it = r.find(field);
-                    if (it != r.end() && it->second != "NULL") {
-                        sum += std::stod(it->second);
-                        count++;
-                    }
-                }
-                return count > 0 ? std::to_string(sum / count) : "NULL";
+        else {
+            // 单表查询：按统计信息选择全表扫描或索引访问，走索引时只回表读取命中的行，并在读取时按完整条件过滤
+            if (!Record::table_exists(tables[0])) {
+                throw std::runtime_error("表 '" + tables[0] + "' 不存在。");
             }
-            else if (col.find("MAX(") == 0) {
-                bool first = true;
-                double max_val = 0;
-                for (const auto& r : records) {
-                    auto it = r.find(field);
-                    if (it != r.end() && it->second != "NULL") {
-                        double current = std::stod(it->second);
-                        if (first || current > max_val) {
-                            max_val = current;
-                            first = false;
-                        }
-                    }
-                }
-                return first ? "NULL" : std::to_string(max_val);
+            AccessPlan access_plan;
+            if (!condition.empty() || explain) access_plan = AccessPlanner::plan(tables[0], condition);
+            // ORDER BY 单个索引字段（升序）+ LIMIT 且条件不走索引时，按索引顺序读表，取够行数即停止
+            std::string index_name;
+            BTree* order_btree = nullptr;
+            if (limit && order_items.size() == 1 && !order_items[0].desc && group_by.empty() &&
+                !access_plan.usesIndex()) {
+                order_btree = order_index(tables[0], order_items[0].column, index_name);
             }
-            else if (col.find("MIN(") == 0) {
-                bool first = true;
-                double min_val = 0;
-                for (const auto& r : records) {
-                    auto it = r.find(field);
-                    if (it != r.end() && it->second != "NULL") {
-                        double current = std::stod(it->second);
-                        if (first || current < min_val) {
-                            min_val = current;
-                            first = false;
-                        }
-                    }
-                }
-                return first ? "NULL" : std::to_string(min_val);
+            if (order_btree) {
+                root = std::make_unique<IndexOrderScanOperator>(tables[0], order_btree, index_name, condition);
+                index_ordered = true;
             }
-            return "NULL";
-            };
-
-        // 清空之前的记录并添加分组后的结果
-        condition_filtered.clear();
-        for (const auto& [group_key, group_records] : grouped) {
-            std::unordered_map<std::string, std::string> grouped_row;
-            grouped_row[group_by] = group_key;
-
-            // 检查选择的列
-            std::vector<std::string> agg_cols;
-            if (columns == "*") {
-                for (const auto& [col, _] : combined_structure) {
-                    agg_cols.push_back(col);
-                }
+            else if (access_plan.usesIndex()) {
+                root = std::make_unique<IndexScanOperator>(tables[0], access_plan, condition);
             }
             else {
-                agg_cols = parse_column_list(columns);
+                root = scan_table(tables[0], "", access_plan.describe(), access_plan.estimated_rows);
+                if (!condition.empty()) root = filter_scan(std::move(root), condition, false);
             }
+        }
 
-            // 应用聚合函数到每一列
-            for (const auto& col : agg_cols) {
-                if (col == group_by) continue; // 分组字段直接使用
-                if (col.find("(") != std::string::npos) {
-                    grouped_row[col] = apply_aggregates(col, group_records);
-                }
+        // ==================== 3️⃣  WHERE 过滤 ====================
+        // 多表时只剩未下推的子条件
+        if (has_join) {
+            std::string remaining;
+            for (size_t i = 0; i < conjuncts.size(); ++i) {
+                if (consumed[i]) continue;
+                remaining += (remaining.empty() ? "(" : " AND (") + conjuncts[i] + ")";
             }
+            if (!remaining.empty()) root = FilterOperator::where(std::move(root), remaining, true);
+        }
 
-            condition_filtered.emplace_back(0, grouped_row);
+        // ==================== 4️⃣  GROUP BY 和 聚合函数 ====================
+        if (!group_by.empty()) {
+            root = std::make_unique<AggregateOperator>(std::move(root), group_by, columns);
         }
-    }
 
-    // ==================== 5️⃣  HAVING 过滤 ====================
-    if (!having.empty()) {
-        // 定义一个lambda函数用于评估HAVING条件
-        auto eval_having = [&](const std::unordered_map<std::string, std::string>& row) -> bool {
-            std::regex pattern(R"(\s*(\w+\(.*\)|\w+)\s*(=|!=|>|<|>=|<=)\s*(\S+))");
-            std::smatch match;
-            if (!std::regex_match(having, match, pattern)) return true;
-
-            std::string col = match[1];
-            std::string op = match[2];
-            std::string rhs = match[3];
-            if (rhs.front() == '\'' && rhs.back() == '\'') {
-                rhs = rhs.substr(1, rhs.length() - 2);
-            }
+        // ==================== 5️⃣  HAVING 过滤 ====================
+        if (!having.empty()) {
+            root = having_filter(std::move(root), having);
+        }
 
-            if (!row.count(col)) return false;
-            std::string lhs = row.at(col);
-
-            try {
-                double lnum = std::stod(lhs);
-                double rnum = std::stod(rhs);
-                if (op == "=") return lnum == rnum;
-                if (op == "!=") return lnum != rnum;
-                if (op == ">") return lnum > rnum;
-                if (op == "<") return lnum < rnum;
-                if (op == ">=") return lnum >= rnum;
-                if (op == "<=") return lnum <= rnum;
+        // ==================== 6️⃣  ORDER BY 排序 ====================
+        // 有 LIMIT 时只需保留前 offset + count 行；结果中不存在的排序字段忽略
+        if (!order_items.empty() && !index_ordered) {
+            std::vector<SortKey> sort_keys;
+            for (const auto& item : order_items) {
+                int key_index = root->schema().find(item.column);
+                if (key_index >= 0) sort_keys.push_back({ key_index, item.desc });
             }
-            catch (...) {
-                if (op == "=") return lhs == rhs;
-                if (op == "!=") return lhs != rhs;
-                if (op == ">") return lhs > rhs;
-                if (op == "<") return lhs < rhs;
-                if (op == ">=") return lhs >= rhs;
-                if (op == "<=") return lhs <= rhs;
+            if (!sort_keys.empty()) {
+                uint64_t top_n = limit ? limit->offset + limit->count : 0;
+                root = std::make_unique<SortOperator>(std::move(root), std::move(sort_keys), order_by, top_n);
             }
-
-            return true;
-            };
-
-        // 应用HAVING条件过滤记录
-        auto it = std::remove_if(condition_filtered.begin(), condition_filtered.end(),
-            [&](const auto& pair) { return !eval_having(pair.second); });
-        condition_filtered.erase(it, condition_filtered.end());
-    }
-
-    // ==================== 6️⃣  ORDER BY 排序 ====================
-    if (!order_by.empty()) {
-        std::string key = order_by;
-        bool desc = false;
-        if (key.find(" DESC") != std::string::npos) {
-            desc = true;
-            key = key.substr(0, key.find(" DESC"));
         }
 
-        std::sort(condition_filtered.begin(), condition_filtered.end(),
-            [&](const auto& a, const auto& b) {
-                auto a_it = a.second.find(key);
-                auto b_it = b.second.find(key);
-
-                // 处理NULL值
-                if (a_it == a.second.end() || a_it->second == "NULL") {
-                    return false; // NULL值放在最后
-                }
-                if (b_it == b.second.end() || b_it->second == "NULL") {
-                    return true;  // NULL值放在最后
-                }
+        // ==================== 7️⃣  LIMIT / OFFSET ====================
+        if (limit) {
+            root = std::make_unique<LimitOperator>(std::move(root), limit->count, limit->offset);
+        }
 
-                // 尝试数值比较
-                try {
-                    double a_val = std::stod(a_it->second);
-                    double b_val = std::stod(b_it->second);
-                    return desc ? a_val > b_val : a_val < b_val;
-                }
-                catch (...) {
-                    // 字符串比较
-                    return desc ? a_it->second > b_it->second : a_it->second < b_it->second;
-                }
-            });
+        // ==================== 8️⃣  投影 ====================
+        std::vector<std::string> result_columns = columns == "*"
+            ? root->schema().names      // 按表结构中的字段顺序输出
+            : Record::parse_column_list(columns);
+        return std::make_unique<ProjectOperator>(std::move(root), result_columns, columns);
     }
+}
 
-    // ==================== 7️⃣  构建结果集 ====================
-    std::vector<std::string> selected_cols; // 先声明向量
-    if (columns == "*") {
-        // 如果有条件过滤后的记录，从第一条记录获取所有列名
-        if (!condition_filtered.empty()) {
-            for (const auto& [col, _] : condition_filtered[0].second) {
-                selected_cols.push_back(col);
-            }
-            // 确保列名按顺序排列，提高输出一致性
-            std::sort(selected_cols.begin(), selected_cols.end());
-        }
-        // 如果没有记录，则从表结构中获取列名
-        else {
-            for (const auto& pair : combined_structure) {
-                selected_cols.push_back(pair.first);
-            }
-        }
-    }
-    else {
-        // 如果不是 SELECT *，则解析 columns 字符串
-        selected_cols = parse_column_list(columns);
+ResultSet Record::select(
+    const std::string& columns,
+    const std::string& table_name,
+    const std::string& condition,
+    const std::string& group_by,
+    const std::string& order_by,
+    const std::string& having,
+    const JoinInfo* join_info,
+    const LimitClause* limit,
+    QueryProfile* profile)
+{
+    std::unique_ptr<Operator> plan = build_plan(columns, table_name, condition, group_by, order_by, having,
+        join_info, limit, profile != nullptr);
+
+    ResultSet result;
+    result.columns = plan->schema().names;
+    if (profile && !profile->analyze()) {
+        plan->report(profile);
+        return result;
     }
 
-    for (const auto& [_, rec_map] : condition_filtered) {
-        Record rec;
-        rec.set_table_name(tables.size() == 1 ? tables[0] : "");
-        for (const auto& col : selected_cols) {
-            auto it = rec_map.find(col);
-            std::string val = (it != rec_map.end()) ? it->second : "NULL";
-            rec.add_column(col);
-            rec.add_value(val);
-        }
-        records.push_back(rec);
+    if (profile) plan->enableProfiling();
+    RowBatch batch;
+    while (plan->next(batch)) {
+        std::move(batch.begin(), batch.end(), std::back_inserter(result.rows));
     }
+    plan->report(profile);
+    return result;
+}
+
+void Record::select_each(
+    const std::string& columns,
+    const std::string& table_name,
+    const std::string& condition,
+    const std::string& group_by,
+    const std::string& order_by,
+    const std::string& having,
+    const JoinInfo* join_info,
+    const LimitClause* limit,
+    const std::function<void(const RowSchema&)>& on_schema,
+    const std::function<bool(const RowBatch&)>& emit)
+{
+    std::unique_ptr<Operator> plan = build_plan(columns, table_name, condition, group_by, order_by, having,
+        join_info, limit, false);
+    on_schema(plan->schema());
 
-    return records;
+    RowBatch batch;
+    while (plan->next(batch)) {
+        if (!emit(batch)) break;
+    }
 }
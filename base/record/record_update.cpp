@@ -50,124 +50,107 @@ int Record::update(const std::string& tableName, const std::string& setClause, c
         updates[col] = val;
     }
 
-    std::string trd_path = dbManager::getInstance().get_current_database()->getDBPath() + "/" + table_name + ".trd";
-    std::ifstream infile(trd_path, std::ios::binary);
-    if (!infile) throw std::runtime_error("无法打开数据文件。");
+    HeapFile& heap = heap_file(table_name, fields);
+
+    // 先找出满足条件的记录，再逐条处理
+    std::vector<std::pair<uint64_t, std::unordered_map<std::string, std::string>>> matched;
+    RowSchema schema = row_schema(fields);
+    Row row;
+    heap.scan([&](uint64_t, const char* data, size_t) {
+        if (decode_row(data, fields, row, /*skip_deleted=*/true) &&
+            (condition.empty() || matches_condition(row, schema, false))) {
+            matched.emplace_back(row.row_id, row_to_map(row, schema));
+        }
+        return true;
+        });
 
     int updated = 0;
-    std::vector<std::pair<uint64_t, std::unordered_map<std::string, std::string>>> all_records;
-    std::vector<std::pair<uint64_t, std::unordered_map<std::string, std::string>>> undo_records;
-
-    while (infile.peek() != EOF) {
-        std::unordered_map<std::string, std::string> record_data;
-        uint64_t row_id = 0;
-
-        if (read_record_from_file(infile, fields, record_data, row_id, /*skip_deleted=*/true)) {
-            if (condition.empty() || matches_condition(record_data, false)) {
-                // 事务处理
-                if (transaction.isActive()) {
-                    try {
-                        std::vector<std::pair<std::string, std::string>> oldValues, newPairs;
-                        for (const auto& [col, _] : updates) {
-                            oldValues.emplace_back(col, record_data[col]);
-                        }
-                        transaction.addUndo(DmlType::UPDATE, table_name, row_id, oldValues);
-
-                        for (const auto& [col, val] : updates) {
-                            newPairs.emplace_back(col, val);
-                        }
-
-                        LogManager::instance().logUpdate(table_name, row_id, oldValues, newPairs);
-                        transaction.commitImplicitTransaction();
-                    }
-                    catch (const std::exception& e) {
-                        transaction.rollback();
-                        std::cerr << "更新操作失败: " << e.what() << std::endl;
-                        throw;
-                    }
-                }
+    std::vector<std::pair<uint64_t, std::unordered_map<std::string, std::string>>> updated_records;
 
-                // 构造 oldValues/newValues 用于更新索引
-                std::vector<std::string> oldValues, newValues;
+    for (auto& [row_id, record_data] : matched) {
+        // 事务处理
+        if (transaction.isActive()) {
+            try {
+                std::vector<std::pair<std::string, std::string>> oldValues, newPairs;
                 for (const auto& [col, _] : updates) {
-                    oldValues.push_back(record_data[col]);
+                    oldValues.emplace_back(col, record_data[col]);
                 }
-
-                undo_records.emplace_back(row_id, record_data); // 记录旧数据
+                transaction.addUndo(DmlType::UPDATE, table_name, row_id, oldValues);
 
                 for (const auto& [col, val] : updates) {
-                    record_data[col] = val;
-                    newValues.push_back(val);
-                }
-
-                // 约束检查
-                std::vector<std::string> cols, vals;
-                for (const auto& field : fields) {
-                    std::string field_name(field.name);
-                    cols.push_back(field_name);
-                    vals.push_back(record_data[field_name]);
-                }
-                std::vector<ConstraintBlock> constraints = read_constraints(table_name);
-                if (!check_constraints(cols, vals, constraints)) {
-                    throw std::runtime_error("更新数据违反表约束");
+                    newPairs.emplace_back(col, val);
                 }
 
-                // 更新索引
-                updateIndexesAfterUpdate(table_name, oldValues, newValues, RecordPointer{ row_id });
-                updated++;
+                LogManager::instance().logUpdate(table_name, row_id, oldValues, newPairs);
+                transaction.commitImplicitTransaction();
+            }
+            catch (const std::exception& e) {
+                transaction.rollback();
+                std::cerr << "更新操作失败: " << e.what() << std::endl;
+                throw;
             }
-
-            all_records.emplace_back(row_id, record_data); // 无论是否更新都保留
         }
-    }
-    infile.close();
 
-    // 写回文件
-    std::stable_sort(all_records.begin(), all_records.end(), [](const auto& a, const auto& b) {
-        return a.first < b.first;
-        });
+        // 构造 oldValues/newValues 用于更新索引（按 columns 的字段顺序）
+        std::vector<std::string> oldValues, newValues;
+        for (const auto& col : columns) {
+            oldValues.push_back(record_data[col]);
+        }
 
-    std::ofstream outfile(trd_path, std::ios::binary | std::ios::trunc);
-    if (!outfile) throw std::runtime_error("无法打开数据文件进行写入。");
+        for (const auto& [col, val] : updates) {
+            record_data[col] = val;
+        }
+        for (const auto& col : columns) {
+            newValues.push_back(record_data[col]);
+        }
 
-    for (const auto& [row_id, record] : all_records) {
-        outfile.write(reinterpret_cast<const char*>(&row_id), sizeof(uint64_t));
-        char delete_flag = 0;
-        outfile.write(&delete_flag, sizeof(char));
+        // 约束检查
+        std::vector<std::string> cols, vals;
         for (const auto& field : fields) {
-            write_field(outfile, field, record.at(field.name));
+            std::string field_name(field.name);
+            cols.push_back(field_name);
+            vals.push_back(record_data[field_name]);
+        }
+        std::vector<ConstraintBlock> constraints = read_constraints(table_name);
+        if (!check_constraints(cols, vals, constraints)) {
+            throw std::runtime_error("更新数据违反表约束");
         }
+
+        // 更新索引
+        updateIndexesAfterUpdate(table_name, oldValues, newValues, RecordPointer{ row_id });
+        updated_records.emplace_back(row_id, record_data);
+        updated++;
+    }
+
+    // 全部检查通过后再原地写回，只涉及被修改记录所在的页
+    for (const auto& [row_id, record] : updated_records) {
+        heap.update(row_id, encode_record(row_id, 0, fields, record));
     }
-    outfile.close();
 
-    dbManager::getInstance().get_current_database()->getTable(table_name)->setLastModifyTime(std::time(nullptr));
+    Table* table = dbManager::getInstance().get_current_database()->getTable(table_name);
+    table->setLastModifyTime(std::time(nullptr));
+    table->resetAutoIncrement();
     return updated;
 }
 
 
 void Record::updateByRowid(uint64_t rowId, const std::vector<std::pair<std::string, std::string>>& newValues) {
-    std::string file_path = dbManager::getInstance().get_current_database()->getDBPath() + "/" + this->table_name + ".trd";
-    std::ofstream file(file_path, std::ios::in | std::ios::out | std::ios::binary);
-    if (!file) throw std::runtime_error("无法打开文件进行更新");
-
     std::vector<FieldBlock> fields = read_field_blocks(this->table_name);
-    size_t record_size = sizeof(uint64_t) + sizeof(char);
-    for (const auto& f : fields) {
-        record_size += get_field_size(f);
-    }
-
-    std::streampos pos = (rowId - 1) * record_size;
-    file.seekp(std::streamoff(pos) + sizeof(uint64_t) + sizeof(char), std::ios::beg);
+    HeapFile& heap = heap_file(this->table_name, fields);
 
-    std::unordered_map<std::string, std::string> val_map;
-    for (const auto& [col, val] : newValues) {
-        val_map[col] = val;
+    std::string raw;
+    if (!heap.read(rowId, raw)) {
+        throw std::runtime_error("记录 row_id = " + std::to_string(rowId) + " 不存在，无法更新");
     }
 
-    for (const auto& field : fields) {
-        std::string value = val_map.count(field.name) ? val_map[field.name] : "NULL";
-        write_field(file, field, value);
+    // 只覆盖给出的字段，其余字段与删除标记保持不变
+    std::unordered_map<std::string, std::string> record_data;
+    uint64_t stored_row_id = 0;
+    decode_record(raw.data(), fields, record_data, stored_row_id, /*skip_deleted=*/false);
+    for (const auto& [col, val] : newValues) {
+        record_data[col] = val;
     }
 
-    file.close();
+    heap.update(rowId, encode_record(rowId, raw[HeapFile::DELETE_FLAG_OFFSET], fields, record_data));
+    dbManager::getInstance().get_current_database()->getTable(this->table_name)->resetAutoIncrement();
 }
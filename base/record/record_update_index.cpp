@@ -11,23 +11,36 @@
 #include <map>
 #include <set>
 
-void Record::updateIndexesAfterInsert(const std::string& table_name) {
-    Table* table = dbManager::getInstance().get_current_database()->getTable(table_name);
-    RecordPointer recordPtr = get_last_inserted_record_pointer(table_name);
+// 索引页只在缓冲池中修改，由换出、检查点或卸载数据库时写回，插入、删除、更新都不逐条记录刷盘
+// 每个索引的新条目先按键排序再插入，相邻条目落在同一叶子页，批量插入时页面命中率高
+void Record::updateIndexesAfterInsert(const std::string& table_name, const std::vector<std::vector<std::string>>& rows,
+    const std::vector<RecordPointer>& recordPtrs) {
+    Table* table = target_table ? target_table : dbManager::getInstance().get_current_database()->getTable(table_name);
+    const auto& fields = table->getFields();
     const auto& indexes = table->getIndexes();
 
     for (const auto& index : indexes) {
         if (index.field_num != 1) continue;
 
         const std::string& fieldName = index.field[0];
-        auto it = std::find(columns.begin(), columns.end(), fieldName);
-        if (it == columns.end()) continue;
+        auto it = std::find_if(fields.begin(), fields.end(),
+            [&](const FieldBlock& f) { return fieldName == f.name; });
+        if (it == fields.end()) continue;
+        size_t pos = it - fields.begin();
 
-        std::string fieldValue = values[it - columns.begin()];
         BTree* btree = table->getBTreeByIndexName(index.name);
-        if (btree) {
-            btree->insert(fieldValue, recordPtr);
-            btree->saveBTreeIndex();
+        if (!btree) continue;
+
+        std::vector<FieldPointer> entries;
+        entries.reserve(rows.size());
+        for (size_t i = 0; i < rows.size(); ++i) {
+            entries.push_back(FieldPointer{ btree->makeKey(rows[i][pos]), recordPtrs[i] });
+        }
+        std::sort(entries.begin(), entries.end(), [](const FieldPointer& a, const FieldPointer& b) {
+            return BTree::compare(a, b) < 0;
+            });
+        for (const auto& entry : entries) {
+            btree->insert(entry);
         }
     }
 }
@@ -46,8 +59,7 @@ void Record::updateIndexesAfterDelete(const std::string& table_name, const std::
         std::string fieldValue = deletedValues[it - columns.begin()];
         BTree* btree = table->getBTreeByIndexName(index.name);
         if (btree) {
-            btree->remove(fieldValue);
-            btree->saveBTreeIndex();
+            btree->remove(fieldValue, recordPtr);
         }
     }
 }
@@ -70,24 +82,9 @@ void Record::updateIndexesAfterUpdate(const std::string& table_name, const std::
         if (oldVal != newVal) {
             BTree* btree = table->getBTreeByIndexName(index.name);
             if (btree) {
-                btree->remove(oldVal);
+                btree->remove(oldVal, recordPtr);
                 btree->insert(newVal, recordPtr);
-                btree->saveBTreeIndex();
             }
         }
     }
 }
-
-RecordPointer Record::get_last_inserted_record_pointer(const std::string& table_name) {
-    Table* table = dbManager::getInstance().get_current_database()->getTable(table_name);
-    const auto& allRecords = read_records(table_name); // 返回上面的 vector<pair<row_id, map>> 类型
-
-    if (allRecords.empty()) {
-        throw std::runtime_error("No records exist in the table.");
-    }
-
-    RecordPointer ptr;
-    ptr.row_id = allRecords.back().first;  // 获取最后插入的 row_id
-    return ptr;
-}
-
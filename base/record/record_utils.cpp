@@ -35,17 +35,20 @@ std::tm custom_strptime(const std::string& datetime_str, const std::string& form
 Record::Record() {
 }
 
+std::shared_ptr<const TableSchema> Record::catalog_schema(const std::string& table_name) {
+    return dbManager::getInstance().get_current_database()->getCatalog().get(table_name);
+}
+
 bool Record::table_exists(const std::string& table_name) {
-    std::string tdf_filename = dbManager::getInstance().get_current_database()->getDBPath() + "/" + table_name + ".tdf";
-    std::ifstream file(tdf_filename,std::ios::binary);
-    return file.good();
+    return dbManager::getInstance().get_current_database()->getCatalog().find(table_name) != nullptr;
 }
 
 std::unordered_map<std::string, std::string> Record::read_table_structure_static(const std::string& table_name) {
-    std::unordered_map<std::string, std::string> result;
-    // 替换为类似 read_field_blocks 的二进制读取
-    std::vector<FieldBlock> fields = read_field_blocks(table_name);
+    return catalog_schema(table_name)->structure;
+}
 
+std::unordered_map<std::string, std::string> Record::table_structure_of(const std::vector<FieldBlock>& fields) {
+    std::unordered_map<std::string, std::string> result;
     for (const auto& field : fields) {
         std::string column_name = field.name;
         std::string column_type;
@@ -111,7 +114,7 @@ bool Record::is_valid_type(const std::string& value, const std::string& type) {
         return  val == "true" || val == "false";
     }
     else if (type == "DATE" || type == "DATETIME") {
-        std::regex date_regex(R"('(\d{4}-\d{2}-\d{2})')");
+        static const std::regex date_regex(R"('(\d{4}-\d{2}-\d{2})')");
         return std::regex_match(value, date_regex);
     }
     return true;
@@ -120,24 +123,20 @@ bool Record::is_valid_type(const std::string& value, const std::string& type) {
 
 // 修改validate_types方法使用FieldBlock进行验证
 void Record::validate_types() {
-    std::vector<FieldBlock> fields = read_field_blocks(table_name);
-    std::unordered_map<std::string, FieldBlock> field_map;
-
-    // 构建字段名到FieldBlock的映射
-    for (const auto& field : fields) {
-        field_map[field.name] = field;
-    }
+    // 字段名到FieldBlock的映射取自表结构缓存
+    std::shared_ptr<const TableSchema> schema = catalog_schema(table_name);
 
     // 验证每个值的类型是否与对应的字段类型匹配
     for (size_t i = 0; i < columns.size(); ++i) {
-        std::string column = columns[i];
-        std::string value = values[i];
+        const std::string& column = columns[i];
+        const std::string& value = values[i];
 
-        if (field_map.find(column) == field_map.end()) {
+        int ordinal = schema->ordinal(column);
+        if (ordinal < 0) {
             throw std::runtime_error("字段 '" + column + "' 不存在于表中");
         }
 
-        FieldBlock field = field_map[column];
+        const FieldBlock& field = schema->fields[ordinal];
 
         if (!validate_field_block(value, field)) {
             throw std::runtime_error("字段 '" + column + "' 的值类型不匹配");
@@ -205,30 +204,19 @@ void Record::write_to_tdf_format(const std::string& table_name,
     }
 
     file.close();
+    Catalog::bumpVersion();
     std::cout << "成功创建表定义文件: " << tdf_filename << std::endl;
 }
-// 从.tdf文件读取FieldBlock结构
-std::vector<FieldBlock> Record::read_field_blocks(const std::string& table_name) {
-    std::vector<FieldBlock> fields;
-    std::string tdf_filename = dbManager::getInstance().get_current_database()->getDBPath() + "/" + table_name + ".tdf";
-    std::ifstream file(tdf_filename, std::ios::binary);
-
-    if (!file) {
-        throw std::runtime_error("无法打开表定义文件: " + tdf_filename);
-    }
 
-    // 开始读取FieldBlock结构
-    FieldBlock field;
-    while (file.read(reinterpret_cast<char*>(&field), sizeof(FieldBlock))) {
-        fields.push_back(field);
-    }
-    return fields;
+// 表的FieldBlock结构（取自表结构缓存，表结构变化后才重新读取.tdf文件）
+std::vector<FieldBlock> Record::read_field_blocks(const std::string& table_name) {
+    return catalog_schema(table_name)->fields;
 }
 
 // 根据FieldBlock验证值类型
 bool Record::validate_field_block(const std::string& value, const FieldBlock& field) {
-    // 在函数开始处定义正则表达式，而不是在case中
-    std::regex date_regex(R"('(\d{4}-\d{2}-\d{2})')");
+    // 正则表达式只编译一次，避免逐条记录重复构造
+    static const std::regex date_regex(R"('(\d{4}-\d{2}-\d{2})')");
     std::string val = value;
     
     switch (field.type) {
@@ -313,267 +301,195 @@ const std::vector<std::string>& Record::get_values() const {
 
 void Record::parse_condition(const std::string& condition) {
     full_condition = condition;
+    compiled_condition.reset();
 }
 
-bool Record::matches_condition(const std::unordered_map<std::string, std::string>& record_data, bool use_prefix) const {
+bool Record::matches_condition(const Row& row, const RowSchema& schema, bool use_prefix) const {
     if (full_condition.empty()) return true;
 
-    // 1️⃣ 拆分表达式
-    std::vector<std::string> tokens = tokenize(full_condition);
-
-    // 2️⃣ 构建表达式树
-    ExpressionNode* root = build_expression_tree(tokens);
+    // 每条语句只编译一次：字段名解析为列序号，之后逐行执行谓词程序
+    if (!compiled_condition || compiled_use_prefix != use_prefix) {
+        compiled_condition = std::make_shared<Predicate>(Predicate::compile(full_condition, schema, use_prefix));
+        compiled_use_prefix = use_prefix;
+    }
+    return compiled_condition->evaluate(row);
+}
 
-    // 3️⃣ 定义工具函数：获取字段类型
-    auto resolve_field_type = [&](const std::string& key) -> std::string {
-        for (const auto& [k, type] : table_structure) {
-            if (strcasecmp(k.c_str(), key.c_str()) == 0) return type;
-            if (!use_prefix) {
-                size_t dot_pos = k.find('.');
-                std::string suffix = (dot_pos != std::string::npos) ? k.substr(dot_pos + 1) : k;
-                if (strcasecmp(suffix.c_str(), key.c_str()) == 0) return type;
-            }
-        }
-        throw std::runtime_error("字段 '" + key + "' 无法匹配到表结构中");
-        };
-
-    // 4️⃣ 获取字段值
-    auto get_field_value = [&](const std::string& key) -> std::string {
-        for (const auto& [k, v] : record_data) {
-            if (strcasecmp(k.c_str(), key.c_str()) == 0) return v;
-            if (!use_prefix) {
-                size_t dot_pos = k.find('.');
-                std::string suffix = (dot_pos != std::string::npos) ? k.substr(dot_pos + 1) : k;
-                if (strcasecmp(suffix.c_str(), key.c_str()) == 0) return v;
-            }
-        }
-        throw std::runtime_error("字段 '" + key + "' 无法匹配到记录中");
-        };
-
-    // 5️⃣ 去除不可打印字符
-    auto normalize_string = [](const std::string& str) -> std::string {
-        std::string res = str;
-        while (!res.empty() && (res.back() == '\0' || !isprint(res.back()))) {
-            res.pop_back();
-        }
-        return res;
-        };
-
-    // 6️⃣ 解析单个条件
-    auto evaluate_single = [&](const std::string& cond) -> bool {
-        std::regex expr_regex(R"(^\s*(\w+(?:\.\w+)?)\s*(=|!=|>=|<=|>|<)\s*(.+?)\s*$)");
-        std::smatch m;
-        if (!std::regex_match(cond, m, expr_regex)) return false;
-
-        std::string left = m[1];
-        std::string op = m[2];
-        std::string right = m[3];
-
-        std::string left_val = get_field_value(left);
-        std::string left_type = resolve_field_type(left);
-
-        // 判断右边是字段还是常量
-        bool right_is_field = false;
-        for (const auto& [k, _] : record_data) {
-            if (strcasecmp(k.c_str(), right.c_str()) == 0) {
-                right_is_field = true;
-                break;
-            }
-        }
+RowSchema Record::row_schema(const std::vector<FieldBlock>& fields, const std::string& prefix) {
+    RowSchema schema;
+    for (const auto& field : fields) {
+        schema.add(prefix.empty() ? std::string(field.name) : prefix + "." + field.name, field.type);
+    }
+    return schema;
+}
 
-        std::string right_val = right_is_field ? get_field_value(right) : right;
-
-        // 数值类型处理
-        if (left_type == "INTEGER" || left_type == "FLOAT" || left_type == "DOUBLE") {
-            try {
-                double a = std::stod(left_val);
-                double b = std::stod(right_val);
-                if (op == "=") return a == b;
-                if (op == "!=") return a != b;
-                if (op == ">") return a > b;
-                if (op == "<") return a < b;
-                if (op == ">=") return a >= b;
-                if (op == "<=") return a <= b;
-            }
-            catch (...) { return false; }
-        }
-        // 布尔类型处理
-        else if (left_type == "BOOL") {
-            if (op == "=") return left_val == right_val;
-            if (op == "!=") return left_val != right_val;
-        }
-        // 字符串类型处理
-        else if (left_type == "CHAR" || left_type == "VARCHAR" || left_type == "TEXT") {
-            std::string clean_left = normalize_string(left_val);
-            std::string clean_right = normalize_string(right_val);
-
-            if (op == "=") return clean_left == clean_right;
-            if (op == "!=") return clean_left != clean_right;
-            if (op == ">") return clean_left > clean_right;
-            if (op == "<") return clean_left < clean_right;
-            if (op == ">=") return clean_left >= clean_right;
-            if (op == "<=") return clean_left <= clean_right;
-        }
-        // 日期时间处理
-        else if (left_type == "DATETIME") {
-            std::string clean_left = normalize_string(left_val);
-            std::string clean_right = normalize_string(right_val);
-
-            if (op == "=") return clean_left == clean_right;
-            if (op == "!=") return clean_left != clean_right;
-            if (op == ">") return clean_left > clean_right;
-            if (op == "<") return clean_left < clean_right;
-            if (op == ">=") return clean_left >= clean_right;
-            if (op == "<=") return clean_left <= clean_right;
-        }
+std::unordered_map<std::string, std::string> Record::row_to_map(const Row& row, const RowSchema& schema) {
+    std::unordered_map<std::string, std::string> record_data;
+    for (size_t i = 0; i < schema.size() && i < row.values.size(); ++i) {
+        record_data[schema.names[i]] = row.values[i].toString();
+    }
+    return record_data;
+}
 
-        return false;
-        };
+// 按页顺序遍历堆文件，直接解码为类型行
+std::vector<Row> Record::read_rows(const std::string& table_name, RowSchema& schema) {
+    std::vector<Row> rows;
+    scan_rows(table_name, schema, [&](Row& row) {
+        rows.push_back(std::move(row));
+        return true;
+        });
+    return rows;
+}
 
-    // 7️⃣ 递归遍历二叉树并求值
-    std::function<bool(ExpressionNode*)> evaluate_tree = [&](ExpressionNode* node) -> bool {
-        if (!node) return false;
+void Record::scan_rows(const std::string& table_name, RowSchema& schema, const std::function<bool(Row&)>& visit) {
+    std::vector<FieldBlock> fields = read_field_blocks(table_name);
+    schema = row_schema(fields);
+    HeapFile& heap = heap_file(table_name, fields);
 
-        if (!is_operator(node->value)) {
-            // 叶子节点是单个表达式，直接判断
-            return evaluate_single(node->value);
+    heap.scan([&](uint64_t, const char* data, size_t) {
+        Row row;
+        if (decode_row(data, fields, row, /*skip_deleted=*/true)) {
+            return visit(row);
         }
-
-        bool left_result = evaluate_tree(node->left);
-        bool right_result = evaluate_tree(node->right);
-
-        if (node->value == "AND") return left_result && right_result;
-        if (node->value == "OR") return left_result || right_result;
-
-        return false;
-        };
-
-    // 8️⃣ 最终计算结果
-    return evaluate_tree(root);
+        return true;
+        });
 }
 
+RowSchema Record::table_schema(const std::string& table_name) {
+    return row_schema(read_field_blocks(table_name));
+}
 
-// 从.trd文件读取记录
+// 从.trd文件读取记录（按页顺序遍历堆文件）
 std::vector<std::pair<uint64_t, std::unordered_map<std::string, std::string>>>
 Record::read_records(const std::string& table_name) {
     std::vector<std::pair<uint64_t, std::unordered_map<std::string, std::string>>> records;
-    std::string trd_filename = dbManager::getInstance().get_current_database()->getDBPath() + "/" + table_name + ".trd";
-    std::ifstream file(trd_filename, std::ios::binary);
-
-    if (!file) return records;
-
     std::vector<FieldBlock> fields = read_field_blocks(table_name);
+    HeapFile& heap = heap_file(table_name, fields);
+    records.reserve(heap.size());
 
-    while (file.peek() != EOF) {
+    heap.scan([&](uint64_t, const char* data, size_t) {
         std::unordered_map<std::string, std::string> record_data;
         uint64_t row_id = 0;
-
-        if (read_record_from_file(file, fields, record_data, row_id, /*skip_deleted=*/true)) {
-			//record_data["row_id"] = std::to_string(row_id);
+        if (decode_record(data, fields, record_data, row_id, /*skip_deleted=*/true)) {
+            //record_data["row_id"] = std::to_string(row_id);
             records.emplace_back(row_id, std::move(record_data));
         }
-    }
+        return true;
+        });
 
     return records;
 }
 
+std::string Record::get_trd_path(const std::string& table_name) {
+    return dbManager::getInstance().get_current_database()->getDBPath() + "/" + table_name + ".trd";
+}
 
+HeapFile& Record::heap_file(const std::string& table_name, const std::vector<FieldBlock>& fields) {
+    return dbManager::getInstance().get_current_database()->getHeapFile(get_trd_path(table_name), get_record_size(fields));
+}
 
-//只在delete和update中使用
-bool Record::read_record_from_file(std::ifstream& file, const std::vector<FieldBlock>& fields,
-    std::unordered_map<std::string, std::string>& record_data, uint64_t& row_id, bool skip_deleted) {
+size_t Record::get_record_size(const std::vector<FieldBlock>& fields) {
+    size_t size = sizeof(uint64_t) + sizeof(char);   // row_id + delete_flag
+    for (const auto& field : fields) {
+        size_t bytes = sizeof(char) + get_field_data_size(field.type, field.param);
+        size += bytes + (4 - bytes % 4) % 4;
+    }
+    return size;
+}
 
-    record_data.clear();
+bool Record::read_record(HeapFile& heap, uint64_t row_id, const std::vector<FieldBlock>& fields,
+    std::unordered_map<std::string, std::string>& record_data, bool skip_deleted) {
+    std::string raw;
+    if (!heap.read(row_id, raw)) {
+        record_data.clear();
+        return false;
+    }
+    uint64_t stored_row_id = 0;
+    return decode_record(raw.data(), fields, record_data, stored_row_id, skip_deleted);
+}
 
+// 从内存中解码一条记录为类型行，布局与 write_field 写入的一致
+bool Record::decode_row(const char* data, const std::vector<FieldBlock>& fields, Row& row, bool skip_deleted) {
     // 读取 row_id
-    file.read(reinterpret_cast<char*>(&row_id), sizeof(uint64_t));
-    if (!file) return false;
+    std::memcpy(&row.row_id, data, sizeof(uint64_t));
+    const char* p = data + sizeof(uint64_t);
 
     // 读取 delete_flag
-    char delete_flag;
-    file.read(&delete_flag, sizeof(char));
-    if (!file) return false;
-
+    char delete_flag = *p++;
     if (skip_deleted && delete_flag == 1) {
-        // 跳过字段数据
-        for (const auto& field : fields) {
-            char null_flag;
-            file.read(&null_flag, sizeof(char));
-            size_t bytes_read = sizeof(char);
-            size_t field_size = get_field_data_size(field.type, field.param);
-            file.seekg(field_size, std::ios::cur);
-            bytes_read += field_size;
-            size_t padding = (4 - (bytes_read % 4)) % 4;
-            if (padding > 0) file.seekg(padding, std::ios::cur);
-        }
         return false; // 跳过该条记录
     }
 
+    row.values.clear();
+    row.values.reserve(fields.size());
+
     // 读取每个字段数据
     for (const auto& field : fields) {
-        char null_flag;
-        file.read(&null_flag, sizeof(char));
-        if (!file) return false;
+        char null_flag = *p;
+        const char* value = p + sizeof(char);
+        size_t bytes_read = sizeof(char) + get_field_data_size(field.type, field.param);
 
-        size_t bytes_read = sizeof(char);
         if (null_flag == 1) {
-            record_data[field.name] = "NULL";
-            file.seekg(get_field_data_size(field.type, field.param), std::ios::cur);
-            bytes_read += get_field_data_size(field.type, field.param);
+            row.values.push_back(Value::null());
         }
         else {
             switch (field.type) {
             case 1: {
                 int val;
-                file.read(reinterpret_cast<char*>(&val), sizeof(int));
-                record_data[field.name] = std::to_string(val);
-                bytes_read += sizeof(int);
+                std::memcpy(&val, value, sizeof(int));
+                row.values.push_back(Value::fromInt(val));
                 break;
             }
             case 2: {
                 double val;
-                file.read(reinterpret_cast<char*>(&val), sizeof(double));
-                record_data[field.name] = std::to_string(val);
-                bytes_read += sizeof(double);
+                std::memcpy(&val, value, sizeof(double));
+                row.values.push_back(Value::fromDouble(val));
                 break;
             }
             case 3: {
-                std::vector<char> buf(field.param);
-                file.read(buf.data(), field.param);
-                record_data[field.name] = std::string(buf.data(), strnlen(buf.data(), field.param));
-                bytes_read += field.param;
+                row.values.push_back(Value::fromString(std::string(value, strnlen(value, field.param))));
                 break;
             }
             case 4: {
-                char b;
-                file.read(&b, sizeof(char));
-                record_data[field.name] = (b == 1 ? "TRUE" : "FALSE");
-                bytes_read += sizeof(char);
+                row.values.push_back(Value::fromBool(*value == 1));
                 break;
             }
             case 5: {
                 std::time_t t;
-                file.read(reinterpret_cast<char*>(&t), sizeof(std::time_t));
-                char buf[30];
-                std::tm timeinfo;
-                localtime_s(&timeinfo, &t);  // 将 time_t 转为 struct tm（安全）
-                // %H:%M:%S
-                std::strftime(buf, sizeof(buf), "%Y-%m-%d", &timeinfo);  // 格式化
-                record_data[field.name] = "'" + std::string(buf) + "'";
-                bytes_read += sizeof(std::time_t);
+                std::memcpy(&t, value, sizeof(std::time_t));
+                row.values.push_back(Value::fromTime(t));
                 break;
             }
-            default: break;
+            default:
+                row.values.push_back(Value::null());
+                break;
             }
         }
 
         size_t padding = (4 - (bytes_read % 4)) % 4;
-        if (padding > 0) file.seekg(padding, std::ios::cur);
+        p += bytes_read + padding;
     }
 
     return true;
 }
 
+// 字符串形式的解码，供事务日志、约束检查等按字段名访问的路径使用
+bool Record::decode_record(const char* data, const std::vector<FieldBlock>& fields,
+    std::unordered_map<std::string, std::string>& record_data, uint64_t& row_id, bool skip_deleted) {
+
+    record_data.clear();
+    Row row;
+    if (!decode_row(data, fields, row, skip_deleted)) {
+        row_id = row.row_id;
+        return false;
+    }
+    row_id = row.row_id;
+    for (size_t i = 0; i < fields.size(); ++i) {
+        record_data[fields[i].name] = row.values[i].toString();
+    }
+    return true;
+}
+
 size_t Record::get_field_data_size(int type, int param) {
     switch (type) {
     case 1: return sizeof(int);             // INT
@@ -586,32 +502,37 @@ size_t Record::get_field_data_size(int type, int param) {
 }
 
 void Record::write_field(std::ofstream& out, const FieldBlock& field, const std::string& value) {
+    std::string buf;
+    encode_field(buf, field, value);
+    out.write(buf.data(), buf.size());
+}
+
+void Record::encode_field(std::string& out, const FieldBlock& field, const std::string& value) {
     bool is_null = (value == "NULL");
     char null_flag = is_null ? 1 : 0;
-    out.write(&null_flag, sizeof(char));
+    out.push_back(null_flag);
 
+    size_t data_size = get_field_data_size(field.type, field.param);
     if (is_null) {
-        size_t data_size = get_field_data_size(field.type, field.param);
-        std::vector<char> dummy(data_size, 0);
-        out.write(dummy.data(), data_size);
+        out.append(data_size, '\0');
     }
     else {
         switch (field.type) {
         case 1: {
             int v = std::stoi(value);
-            out.write(reinterpret_cast<const char*>(&v), sizeof(int));
+            out.append(reinterpret_cast<const char*>(&v), sizeof(int));
             break;
         }
         case 2: {
             double d = std::stod(value);
-            out.write(reinterpret_cast<const char*>(&d), sizeof(double));
+            out.append(reinterpret_cast<const char*>(&d), sizeof(double));
             break;
         }
         case 3: {
             // 写入原始字符串（包含引号）
             std::vector<char> buf(field.param, 0);
             std::memcpy(buf.data(), value.c_str(), std::min((size_t)field.param, value.size()));
-            out.write(buf.data(), field.param);
+            out.append(buf.data(), field.param);
             break;
         }
 
@@ -619,21 +540,46 @@ void Record::write_field(std::ofstream& out, const FieldBlock& field, const std:
             std::string val = value;
 			std::transform(val.begin(), val.end(), val.begin(), ::tolower);
             char b = (val=="true") ? 1 : 0;
-            out.write(&b, sizeof(char));
+            out.push_back(b);
             break;
         }
         case 5: {
-            // %H:%M:%S
-            std::tm tm = custom_strptime(value, "%Y-%m-%d");
-            std::time_t t = std::mktime(&tm);
-            out.write(reinterpret_cast<const char*>(&t), sizeof(std::time_t));
+            std::time_t t;
+            if (!parse_datetime(value, t)) {
+                throw std::runtime_error("时间字符串解析失败：" + value);
+            }
+            out.append(reinterpret_cast<const char*>(&t), sizeof(std::time_t));
             break;
         }
+        default:
+            out.append(data_size, '\0');
+            break;
         }
     }
 
-    size_t data_size = get_field_data_size(field.type, field.param);
     size_t padding = (4 - (sizeof(char) + data_size) % 4) % 4;
-    char pad[4] = { 0 };
-    out.write(pad, padding);
+    out.append(padding, '\0');
+}
+
+std::string Record::encode_record(uint64_t row_id, char delete_flag, const std::vector<FieldBlock>& fields,
+    const std::vector<std::string>& values) {
+    std::string buf;
+    buf.reserve(get_record_size(fields));
+    buf.append(reinterpret_cast<const char*>(&row_id), sizeof(uint64_t));
+    buf.push_back(delete_flag);
+    for (size_t i = 0; i < fields.size(); ++i) {
+        encode_field(buf, fields[i], i < values.size() ? values[i] : "NULL");
+    }
+    return buf;
+}
+
+std::string Record::encode_record(uint64_t row_id, char delete_flag, const std::vector<FieldBlock>& fields,
+    const std::unordered_map<std::string, std::string>& record) {
+    std::vector<std::string> values;
+    values.reserve(fields.size());
+    for (const auto& field : fields) {
+        auto it = record.find(field.name);
+        values.push_back(it != record.end() ? it->second : "NULL");
+    }
+    return encode_record(row_id, delete_flag, fields, values);
 }
@@ -0,0 +1,111 @@
+#include "row.h"
+#include <sstream>
+#include <iomanip>
+#include <cctype>
+#include <cstdlib>
+#include <functional>
+
+bool Value::toNumber(double& out) const {
+    switch (type) {
+    case ValueType::INT: out = i; return true;
+    case ValueType::DOUBLE: out = d; return true;
+    case ValueType::STRING: {
+        const char* begin = s.c_str();
+        char* end = nullptr;
+        out = std::strtod(begin, &end);
+        return end != begin;
+    }
+    default:
+        return false;
+    }
+}
+
+std::string Value::toString() const {
+    switch (type) {
+    case ValueType::INT: return std::to_string(i);
+    case ValueType::DOUBLE: return std::to_string(d);
+    case ValueType::BOOL: return b ? "TRUE" : "FALSE";
+    case ValueType::DATETIME: {
+        char buf[30];
+        std::tm timeinfo;
+        localtime_s(&timeinfo, &t);
+        std::strftime(buf, sizeof(buf), "%Y-%m-%d", &timeinfo);
+        return "'" + std::string(buf) + "'";
+    }
+    case ValueType::STRING: return s;
+    default: return "NULL";
+    }
+}
+
+int Value::compare(const Value& a, const Value& b) {
+    if (a.isNull() || b.isNull()) {
+        return a.isNull() == b.isNull() ? 0 : (a.isNull() ? 1 : -1);
+    }
+    if (a.isNumeric() && b.isNumeric()) {
+        double x = a.type == ValueType::INT ? a.i : a.d;
+        double y = b.type == ValueType::INT ? b.i : b.d;
+        return x < y ? -1 : (x > y ? 1 : 0);
+    }
+    if (a.type == b.type) {
+        switch (a.type) {
+        case ValueType::BOOL: return static_cast<int>(a.b) - static_cast<int>(b.b);
+        case ValueType::DATETIME: return a.t < b.t ? -1 : (a.t > b.t ? 1 : 0);
+        case ValueType::STRING: return a.s.compare(b.s);
+        default: break;
+        }
+    }
+
+    // 类型不同：能转成数值就按数值比较，否则按输出文本比较
+    double x, y;
+    if (a.toNumber(x) && b.toNumber(y)) {
+        return x < y ? -1 : (x > y ? 1 : 0);
+    }
+    return a.toString().compare(b.toString());
+}
+
+size_t ValueHash::operator()(const Value& v) const {
+    switch (v.type) {
+    case ValueType::INT: return std::hash<double>()(static_cast<double>(v.i));
+    case ValueType::DOUBLE: return std::hash<double>()(v.d == 0 ? 0.0 : v.d);
+    case ValueType::BOOL: return std::hash<bool>()(v.b);
+    case ValueType::DATETIME: return std::hash<long long>()(static_cast<long long>(v.t));
+    case ValueType::STRING: return std::hash<std::string>()(v.s);
+    default: return 0;
+    }
+}
+
+bool parse_datetime(const std::string& text, std::time_t& out) {
+    std::string s = text;
+    if (s.size() >= 2 && (s.front() == '\'' || s.front() == '"') && s.back() == s.front()) {
+        s = s.substr(1, s.size() - 2);
+    }
+
+    std::tm tm = {};
+    std::istringstream ss(s);
+    ss >> std::get_time(&tm, "%Y-%m-%d");
+    if (ss.fail()) return false;
+
+    out = std::mktime(&tm);
+    return out != static_cast<std::time_t>(-1);
+}
+
+int RowSchema::find(const std::string& name, bool allow_suffix) const {
+    auto iequals = [](const std::string& a, const std::string& b) {
+        if (a.size() != b.size()) return false;
+        for (size_t k = 0; k < a.size(); ++k) {
+            if (std::tolower(static_cast<unsigned char>(a[k])) != std::tolower(static_cast<unsigned char>(b[k]))) return false;
+        }
+        return true;
+    };
+
+    for (size_t k = 0; k < names.size(); ++k) {
+        if (iequals(names[k], name)) return static_cast<int>(k);
+    }
+    if (allow_suffix) {
+        for (size_t k = 0; k < names.size(); ++k) {
+            size_t dot_pos = names[k].find('.');
+            if (dot_pos != std::string::npos && iequals(names[k].substr(dot_pos + 1), name)) return static_cast<int>(k);
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#ifndef ROW_H
+#define ROW_H
+
+#include <string>
+#include <vector>
+#include <ctime>
+#include <cstdint>
+
+// 查询内部使用的带类型的行表示：
+// 记录从页中解码后直接得到按字段顺序排列的 Value，
+// 比较、聚合、排序都在类型值上进行，只有在输出时才转换成字符串
+
+enum class ValueType : uint8_t { NULL_VALUE, INT, DOUBLE, BOOL, DATETIME, STRING };
+
+struct Value {
+    ValueType type = ValueType::NULL_VALUE;
+    union {
+        int32_t i;
+        double d;
+        bool b;
+        std::time_t t;
+    };
+    std::string s;              // 仅 STRING 使用（保存原始内容，含引号）
+
+    Value() : t(0) {}
+
+    static Value null() { return Value(); }
+    static Value fromInt(int32_t v) { Value val; val.type = ValueType::INT; val.i = v; return val; }
+    static Value fromDouble(double v) { Value val; val.type = ValueType::DOUBLE; val.d = v; return val; }
+    static Value fromBool(bool v) { Value val; val.type = ValueType::BOOL; val.b = v; return val; }
+    static Value fromTime(std::time_t v) { Value val; val.type = ValueType::DATETIME; val.t = v; return val; }
+    static Value fromString(std::string v) { Value val; val.type = ValueType::STRING; val.s = std::move(v); return val; }
+
+    bool isNull() const { return type == ValueType::NULL_VALUE; }
+    bool isNumeric() const { return type == ValueType::INT || type == ValueType::DOUBLE; }
+
+    // 转成 double，STRING 按数值文本解析，失败返回 false
+    bool toNumber(double& out) const;
+
+    // 输出格式与旧的字符串记录一致：INT/DOUBLE 用 to_string，BOOL 为 TRUE/FALSE，
+    // DATETIME 为 'YYYY-MM-DD'，NULL 为 "NULL"
+    std::string toString() const;
+
+    // 排序用的比较：数值按大小，日期按时间，其余按字符串，NULL 视为最大
+    static int compare(const Value& a, const Value& b);
+    bool operator<(const Value& other) const { return compare(*this, other) < 0; }
+    bool operator==(const Value& other) const { return compare(*this, other) == 0; }
+};
+
+// 与 Value::compare 的相等关系一致的哈希（INT 和 DOUBLE 统一按 double 计算），用于哈希连接和哈希分组
+struct ValueHash {
+    size_t operator()(const Value& v) const;
+};
+
+// 解析 'YYYY-MM-DD'（引号可有可无）
+bool parse_datetime(const std::string& text, std::time_t& out);
+
+// 行的列信息：列名与字段类型代码一一对应
+struct RowSchema {
+    std::vector<std::string> names;
+    std::vector<int> types;
+
+    void add(const std::string& name, int type) {
+        names.push_back(name);
+        types.push_back(type);
+    }
+    size_t size() const { return names.size(); }
+
+    // 按列名查找（不区分大小写），allow_suffix 时允许用字段名匹配 "表名.字段名"，找不到返回 -1
+    int find(const std::string& name, bool allow_suffix = false) const;
+};
+
+struct Row {
+    uint64_t row_id = 0;
+    std::vector<Value> values;
+};
+
+// SELECT 的结果：列名 + 类型行，交给 Output 输出时再转字符串
+struct ResultSet {
+    std::vector<std::string> columns;
+    std::vector<Row> rows;
+
+    bool empty() const { return rows.empty(); }
+    size_t size() const { return rows.size(); }
+};
+
+#endif // ROW_H
@@ -0,0 +1,114 @@
+#include "spillFile.h"
+
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+
+namespace {
+    std::atomic<uint64_t> next_file_id{ 0 };
+
+    template <typename T>
+    void put(std::ofstream& out, const T& v) {
+        out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+    }
+
+    template <typename T>
+    bool get(std::ifstream& in, T& v) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&v), sizeof(T)));
+    }
+
+    size_t write_value(std::ofstream& out, const Value& v) {
+        put(out, static_cast<uint8_t>(v.type));
+        switch (v.type) {
+        case ValueType::INT: put(out, v.i); return 1 + sizeof(int32_t);
+        case ValueType::DOUBLE: put(out, v.d); return 1 + sizeof(double);
+        case ValueType::BOOL: put(out, static_cast<char>(v.b ? 1 : 0)); return 2;
+        case ValueType::DATETIME: put(out, static_cast<int64_t>(v.t)); return 1 + sizeof(int64_t);
+        case ValueType::STRING: {
+            uint32_t len = static_cast<uint32_t>(v.s.size());
+            put(out, len);
+            out.write(v.s.data(), len);
+            return 1 + sizeof(uint32_t) + len;
+        }
+        default: return 1;
+        }
+    }
+
+    bool read_value(std::ifstream& in, Value& v) {
+        uint8_t type = 0;
+        if (!get(in, type)) return false;
+        switch (static_cast<ValueType>(type)) {
+        case ValueType::INT: { int32_t i; get(in, i); v = Value::fromInt(i); break; }
+        case ValueType::DOUBLE: { double d; get(in, d); v = Value::fromDouble(d); break; }
+        case ValueType::BOOL: { char b; get(in, b); v = Value::fromBool(b == 1); break; }
+        case ValueType::DATETIME: { int64_t t; get(in, t); v = Value::fromTime(static_cast<std::time_t>(t)); break; }
+        case ValueType::STRING: {
+            uint32_t len = 0;
+            get(in, len);
+            std::string s(len, '\0');
+            in.read(&s[0], len);
+            v = Value::fromString(std::move(s));
+            break;
+        }
+        default: v = Value::null(); break;
+        }
+        return static_cast<bool>(in);
+    }
+}
+
+RowSpillFile::RowSpillFile(const std::string& tag) {
+    std::filesystem::path dir = std::filesystem::temp_directory_path();
+    m_path = (dir / ("dbms_" + tag + "_" + std::to_string(reinterpret_cast<uintptr_t>(this)) + "_" +
+        std::to_string(next_file_id++) + ".spill")).string();
+    m_out.rdbuf()->pubsetbuf(m_buffer, sizeof(m_buffer));
+    m_out.open(m_path, std::ios::binary | std::ios::trunc);
+    if (!m_out.is_open()) {
+        throw std::runtime_error("无法创建查询临时文件: " + m_path);
+    }
+}
+
+RowSpillFile::~RowSpillFile() {
+    if (m_out.is_open()) m_out.close();
+    if (m_in.is_open()) m_in.close();
+    std::remove(m_path.c_str());
+}
+
+void RowSpillFile::write(const Row& row) {
+    uint32_t count = static_cast<uint32_t>(row.values.size());
+    put(m_out, count);
+    m_bytes += sizeof(uint32_t);
+    for (const auto& v : row.values) {
+        m_bytes += write_value(m_out, v);
+    }
+    if (!m_out) {
+        throw std::runtime_error("写入查询临时文件失败: " + m_path);
+    }
+    ++m_rows;
+}
+
+void RowSpillFile::rewind() {
+    if (m_out.is_open()) {
+        m_out.close();
+        if (!m_out) {
+            throw std::runtime_error("写入查询临时文件失败: " + m_path);
+        }
+    }
+    if (m_in.is_open()) m_in.close();
+    m_in.rdbuf()->pubsetbuf(m_buffer, sizeof(m_buffer));
+    m_in.open(m_path, std::ios::binary);
+    if (!m_in.is_open()) {
+        throw std::runtime_error("无法打开查询临时文件: " + m_path);
+    }
+}
+
+bool RowSpillFile::read(Row& row) {
+    uint32_t count = 0;
+    if (!get(m_in, count)) return false;
+    row.row_id = 0;
+    row.values.resize(count);
+    for (auto& v : row.values) {
+        if (!read_value(m_in, v)) return false;
+    }
+    return true;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#ifndef SPILLFILE_H
+#define SPILLFILE_H
+
+#include <string>
+#include <fstream>
+#include <cstdint>
+#include "row.h"
+
+// 查询执行时放不下内存的中间结果（分组分区、排序段）：
+// 行先顺序写入系统临时目录下的文件，写完后从头顺序读取，对象析构时删除文件。
+// 每行为 u32 列数 + 各列 (u8 ValueType 标记 + 数据)，格式只在本进程内使用
+class RowSpillFile {
+public:
+    // tag 用作临时文件名的一部分，便于区分是哪个算子写出的
+    explicit RowSpillFile(const std::string& tag);
+    ~RowSpillFile();
+
+    RowSpillFile(const RowSpillFile&) = delete;
+    RowSpillFile& operator=(const RowSpillFile&) = delete;
+
+    void write(const Row& row);
+    // 结束写入，之后从第一行开始读取
+    void rewind();
+    // 读取下一行，读完返回 false
+    bool read(Row& row);
+
+    uint64_t rows() const { return m_rows; }
+    uint64_t bytes() const { return m_bytes; }
+
+private:
+    std::string m_path;
+    std::ofstream m_out;
+    std::ifstream m_in;
+    uint64_t m_rows = 0;
+    uint64_t m_bytes = 0;
+    char m_buffer[1 << 16];
+};
+
+#endif // SPILLFILE_H
@@ -0,0 +1,113 @@
+#include "workerPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace {
+    constexpr unsigned MAX_WORKERS = 256;
+
+    unsigned hardware_threads() {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    std::atomic<unsigned> g_max_parallel_workers{ hardware_threads() };
+}
+
+WorkerPool& WorkerPool::instance() {
+    static WorkerPool pool(hardware_threads());
+    return pool;
+}
+
+WorkerPool::WorkerPool(unsigned threads) {
+    grow(threads);
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    for (auto& thread : m_threads) thread.join();
+}
+
+void WorkerPool::grow(unsigned threads) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    while (m_threads.size() < threads) {
+        m_threads.emplace_back([this] { run(); });
+    }
+}
+
+unsigned WorkerPool::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<unsigned>(m_threads.size());
+}
+
+void WorkerPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_cv.notify_one();
+}
+
+void WorkerPool::runAll(size_t tasks, unsigned workers, const std::function<void(size_t)>& task) {
+    // 工作线程可能在调用返回后才开始运行，共享状态由各方共同持有
+    struct State {
+        std::atomic<size_t> next{ 0 };
+        size_t done = 0;
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable cv;
+    };
+    auto state = std::make_shared<State>();
+    auto work = [state, tasks, &task] {
+        for (size_t i = state->next++; i < tasks; i = state->next++) {
+            std::exception_ptr error;
+            try {
+                task(i);
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (error && !state->error) state->error = error;
+            if (++state->done == tasks) state->cv.notify_all();
+        }
+    };
+
+    size_t helpers = std::min<size_t>(tasks, std::max(workers, 1u)) - (tasks ? 1 : 0);
+    for (size_t i = 0; i < helpers; ++i) submit(work);
+    work();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait(lock, [&] { return state->done == tasks; });
+    if (state->error) std::rethrow_exception(state->error);
+}
+
+void WorkerPool::run() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+            if (m_stop && m_tasks.empty()) return;
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        task();
+    }
+}
+
+unsigned WorkerPool::maxParallelWorkers() {
+    return g_max_parallel_workers;
+}
+
+void WorkerPool::setMaxParallelWorkers(unsigned workers) {
+    workers = std::min(std::max(workers, 1u), MAX_WORKERS);
+    g_max_parallel_workers = workers;
+    // 允许超过核数（如等待磁盘的扫描），线程池随之扩大
+    instance().grow(workers);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <functional>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// 查询执行共用的工作线程池：线程第一次使用时按 CPU 核数创建并常驻，任务按提交顺序执行。
+// 任务不能阻塞等待其他任务（并行扫描的工作任务领不到块时直接返回，由提交者再次提交）
+class WorkerPool {
+public:
+    static WorkerPool& instance();
+
+    void submit(std::function<void()> task);
+    unsigned size() const;
+
+    // 调用线程和最多 workers - 1 个工作线程一起执行 task(0) ... task(tasks - 1)，全部完成后返回；
+    // 任务抛出的第一个异常在调用线程重新抛出。调用线程自己也领取任务，线程池忙时不会一直等待。
+    // 只能在查询线程中调用，不能在池中的任务里调用
+    void runAll(size_t tasks, unsigned workers, const std::function<void(size_t)>& task);
+
+    // SET max_parallel_workers：单个算子最多同时使用的工作线程数，1 表示不并行；默认为 CPU 核数
+    static unsigned maxParallelWorkers();
+    static void setMaxParallelWorkers(unsigned workers);
+
+private:
+    explicit WorkerPool(unsigned threads);
+    ~WorkerPool();
+    // 线程数不足 threads 时补足
+    void grow(unsigned threads);
+    void run();
+
+    std::vector<std::thread> m_threads;
+    std::deque<std::function<void()>> m_tasks;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stop = false;
+};
+
+#endif // WORKERPOOL_H
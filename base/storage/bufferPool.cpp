@@ -0,0 +1,436 @@
+#include "bufferPool.h"
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <atomic>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+BufferPool::BeforeWriteHook BufferPool::s_before_write;
+
+void BufferPool::setBeforeWriteHook(BeforeWriteHook hook) {
+    s_before_write = std::move(hook);
+}
+
+namespace {
+    std::atomic<size_t> g_default_capacity{ BufferPool::DEFAULT_CAPACITY };
+}
+
+size_t BufferPool::defaultCapacity() {
+    return g_default_capacity;
+}
+
+void BufferPool::setDefaultCapacity(size_t capacity) {
+    g_default_capacity = std::max(capacity, MIN_CAPACITY);
+}
+
+BufferPool::BufferPool() : BufferPool(defaultCapacity()) {
+}
+
+BufferPool::BufferPool(size_t capacity) : m_capacity(std::max(capacity, MIN_CAPACITY)) {
+    m_stats.capacity = m_capacity;
+}
+
+BufferPool::~BufferPool() {
+    try {
+        flushAll();
+    }
+    catch (...) {
+        // 析构中不抛出异常
+    }
+}
+
+// 取得文件的逻辑大小，首次访问时从磁盘读取
+uint64_t& BufferPool::sizeOf(const std::string& file) {
+    auto it = m_file_sizes.find(file);
+    if (it != m_file_sizes.end()) return it->second;
+
+    std::error_code ec;
+    uint64_t size = std::filesystem::exists(file, ec) ? std::filesystem::file_size(file, ec) : 0;
+    if (ec) size = 0;
+    return m_file_sizes[file] = size;
+}
+
+std::shared_ptr<BufferPool::FileHandle> BufferPool::openFile(const std::string& file, bool create) {
+    auto it = m_handles.find(file);
+    if (it != m_handles.end()) return it->second;
+
+    std::FILE* f = std::fopen(file.c_str(), "r+b");
+    if (!f && create) f = std::fopen(file.c_str(), "w+b");
+    if (!f) return nullptr;
+    auto handle = std::make_shared<FileHandle>();
+    handle->file = f;
+    m_handles[file] = handle;
+    return handle;
+}
+
+// 只读取磁盘上已存在的部分，其余保持为 0
+void BufferPool::readPage(FileHandle* handle, uint32_t page_no, char* data) {
+    std::memset(data, 0, PAGE_SIZE);
+    if (!handle) return;
+    std::lock_guard<std::mutex> lock(handle->mutex);
+#ifdef _WIN32
+    if (_fseeki64(handle->file, static_cast<long long>(page_no) * PAGE_SIZE, SEEK_SET) != 0) return;
+#else
+    if (fseeko(handle->file, static_cast<off_t>(page_no) * PAGE_SIZE, SEEK_SET) != 0) return;
+#endif
+    std::fread(data, 1, PAGE_SIZE, handle->file);
+}
+
+// 页被修改：描述这次修改的日志已在修改前追加（预写日志），它的位置在下一次 logAppended 时记下
+void BufferPool::markDirty(Page* page) {
+    page->dirty = true;
+    if (!page->pending) {
+        page->pending = true;
+        m_pending.insert(page);
+    }
+}
+
+// 页从缓存中移除（不写回）
+void BufferPool::dropPage(Page* page) {
+    m_page_table.erase(PageKey{ page->file, page->page_no });
+    page->dirty = false;
+    page->pending = false;
+    page->lsn = 0;
+    m_pending.erase(page);
+}
+
+void BufferPool::logAppended(uint64_t lsn) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (Page* page : m_pending) {
+        page->lsn = std::max(page->lsn, lsn);
+        page->pending = false;
+    }
+    m_pending.clear();
+}
+
+// 等待日志同步到 lsn，等待时释放缓冲池的锁，其他线程可以继续访问缓冲池
+void BufferPool::waitForLog(std::unique_lock<std::mutex>& lock, uint64_t lsn) {
+    if (!s_before_write || lsn <= m_durable_lsn) return;
+    lock.unlock();
+    uint64_t durable = 0;
+    try {
+        durable = s_before_write(lsn);
+    }
+    catch (...) {
+        lock.lock();
+        throw;
+    }
+    lock.lock();
+    m_durable_lsn = std::max(m_durable_lsn, durable);
+}
+
+// 把一页写回磁盘，只写逻辑文件大小以内的部分，保证文件内容与不经过缓冲池时完全一致。
+// 写回前等待描述这一页修改的日志落盘；等待期间页被 pin 住，再次被修改时重新检查
+void BufferPool::flushPage(std::unique_lock<std::mutex>& lock, Page* page, uint64_t waited) {
+    while (page->dirty) {
+        // 最近的修改还没有日志位置时等到当前的日志末尾；日志无法同步到要求的位置（如已关闭）时只等一次
+        uint64_t need = page->pending ? UNKNOWN_LSN : page->lsn;
+        if (need <= m_durable_lsn || need == waited || !s_before_write) break;
+        waited = need;
+        page->pin_count++;
+        try {
+            waitForLog(lock, need);
+        }
+        catch (...) {
+            page->pin_count--;
+            throw;
+        }
+        page->pin_count--;
+    }
+    if (!page->dirty) return;
+
+    uint64_t size = sizeOf(page->file);
+    uint64_t begin = static_cast<uint64_t>(page->page_no) * PAGE_SIZE;
+    if (begin < size) {
+        size_t len = static_cast<size_t>(std::min<uint64_t>(PAGE_SIZE, size - begin));
+
+        std::shared_ptr<FileHandle> handle = openFile(page->file, true);
+        if (!handle) {
+            throw std::runtime_error("缓冲池无法写回文件: " + page->file);
+        }
+        std::lock_guard<std::mutex> file_lock(handle->mutex);
+#ifdef _WIN32
+        bool ok = _fseeki64(handle->file, static_cast<long long>(begin), SEEK_SET) == 0;
+#else
+        bool ok = fseeko(handle->file, static_cast<off_t>(begin), SEEK_SET) == 0;
+#endif
+        // 立即交给操作系统，绕过缓冲池直接读文件的代码（如复制备份）看到的内容与写回后一致
+        ok = ok && std::fwrite(page->data, 1, len, handle->file) == len && std::fflush(handle->file) == 0;
+        if (!ok) {
+            throw std::runtime_error("缓冲池无法写回文件: " + page->file);
+        }
+        m_unsynced.insert(page->file);
+    }
+
+    page->dirty = false;
+    m_stats.flushes++;
+}
+
+// 写回一批页：先按其中最大的 LSN 等一次日志，之后逐页写回时通常不必再等
+void BufferPool::flushPages(std::unique_lock<std::mutex>& lock, const std::vector<Page*>& pages) {
+    uint64_t need = 0;
+    for (Page* page : pages) {
+        need = std::max(need, page->pending ? UNKNOWN_LSN : page->lsn);
+    }
+    waitForLog(lock, need);
+    // 等待期间页可能已被淘汰（淘汰时已写回），写回前重新检查
+    for (Page* page : pages) {
+        flushPage(lock, page, need);
+    }
+}
+
+// 取得一个空闲页框，必要时按 LRU 淘汰未被 pin 的页
+BufferPool::Page* BufferPool::allocateFrame(std::unique_lock<std::mutex>& lock) {
+    while (true) {
+        if (!m_free.empty()) {
+            Page* page = m_free.back();
+            m_free.pop_back();
+            return page;
+        }
+        if (m_frames.size() < m_capacity) {
+            m_frames.push_back(std::make_unique<Page>());
+            return m_frames.back().get();
+        }
+
+        Page* victim = nullptr;
+        for (auto it = m_lru.rbegin(); it != m_lru.rend(); ++it) {
+            if ((*it)->pin_count == 0) {
+                victim = *it;
+                break;
+            }
+        }
+        if (!victim) {
+            throw std::runtime_error("缓冲池已满，所有页均被占用");
+        }
+
+        // 写回时可能等待日志并释放锁，期间页又被使用或修改时另选一页
+        flushPage(lock, victim);
+        if (victim->pin_count > 0 || victim->dirty) continue;
+
+        m_lru.erase(victim->lru_pos);
+        dropPage(victim);
+        m_stats.evictions++;
+        return victim;
+    }
+}
+
+BufferPool::Page* BufferPool::fetchLocked(std::unique_lock<std::mutex>& lock, const std::string& file, uint32_t page_no) {
+    while (true) {
+        auto it = m_page_table.find(PageKey{ file, page_no });
+        if (it != m_page_table.end()) {
+            Page* page = it->second;
+            m_lru.splice(m_lru.begin(), m_lru, page->lru_pos);
+            page->pin_count++;
+            m_stats.hits++;
+            // 其他线程正在读入这一页；页已被 pin 住，不会在等待期间被淘汰
+            m_loaded.wait(lock, [page]() { return !page->loading; });
+            return page;
+        }
+
+        Page* page = allocateFrame(lock);
+        // 淘汰时释放过锁，其他线程可能已经读入了这一页
+        if (m_page_table.count(PageKey{ file, page_no })) {
+            m_free.push_back(page);
+            continue;
+        }
+
+        m_stats.misses++;
+        page->file = file;
+        page->page_no = page_no;
+        page->pin_count = 1;
+        page->dirty = false;
+        page->pending = false;
+        page->lsn = 0;
+        page->loading = true;
+        m_lru.push_front(page);
+        page->lru_pos = m_lru.begin();
+        m_page_table[PageKey{ file, page_no }] = page;
+
+        // 读磁盘时不持有缓冲池的锁，其他页的访问不必等待这次读入
+        std::shared_ptr<FileHandle> handle = openFile(file, false);
+        lock.unlock();
+        readPage(handle.get(), page_no, page->data);
+        handle.reset();
+        lock.lock();
+        page->loading = false;
+        m_loaded.notify_all();
+        return page;
+    }
+}
+
+BufferPool::Page* BufferPool::fetchPage(const std::string& file, uint32_t page_no) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return fetchLocked(lock, file, page_no);
+}
+
+void BufferPool::unpinPage(Page* page, bool dirty) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!page) return;
+    if (dirty) markDirty(page);
+    if (page->pin_count > 0) page->pin_count--;
+}
+
+size_t BufferPool::read(const std::string& file, uint64_t offset, char* buf, size_t len) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    uint64_t size = sizeOf(file);
+    if (offset >= size) return 0;
+    len = static_cast<size_t>(std::min<uint64_t>(len, size - offset));
+
+    size_t done = 0;
+    while (done < len) {
+        uint64_t pos = offset + done;
+        uint32_t page_no = static_cast<uint32_t>(pos / PAGE_SIZE);
+        size_t in_page = static_cast<size_t>(pos % PAGE_SIZE);
+        size_t chunk = std::min(len - done, PAGE_SIZE - in_page);
+
+        Page* page = fetchLocked(lock, file, page_no);
+        std::memcpy(buf + done, page->data + in_page, chunk);
+        page->pin_count--;
+        done += chunk;
+    }
+    return done;
+}
+
+void BufferPool::write(const std::string& file, uint64_t offset, const char* buf, size_t len) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    size_t done = 0;
+    while (done < len) {
+        uint64_t pos = offset + done;
+        uint32_t page_no = static_cast<uint32_t>(pos / PAGE_SIZE);
+        size_t in_page = static_cast<size_t>(pos % PAGE_SIZE);
+        size_t chunk = std::min(len - done, PAGE_SIZE - in_page);
+
+        Page* page = fetchLocked(lock, file, page_no);
+        std::memcpy(page->data + in_page, buf + done, chunk);
+        markDirty(page);
+        page->pin_count--;
+        done += chunk;
+    }
+    // 取页时可能释放过锁，文件大小表要重新查找
+    uint64_t& size = sizeOf(file);
+    size = std::max<uint64_t>(size, offset + len);
+}
+
+uint64_t BufferPool::append(const std::string& file, const char* buf, size_t len) {
+    uint64_t offset;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        offset = sizeOf(file);
+    }
+    write(file, offset, buf, len);
+    return offset;
+}
+
+uint64_t BufferPool::fileSize(const std::string& file) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return sizeOf(file);
+}
+
+void BufferPool::truncate(const std::string& file) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (auto it = m_lru.begin(); it != m_lru.end();) {
+        Page* page = *it;
+        if (page->file != file) { ++it; continue; }
+        if (page->pin_count > 0) {
+            throw std::runtime_error("无法清空文件，页仍被占用: " + file);
+        }
+        it = m_lru.erase(it);
+        dropPage(page);
+        m_free.push_back(page);
+    }
+
+    m_handles.erase(file);
+    std::ofstream out(file, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        throw std::runtime_error("无法清空文件: " + file);
+    }
+    out.close();
+    m_file_sizes[file] = 0;
+}
+
+void BufferPool::flushFile(const std::string& file) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    std::vector<Page*> pages;
+    for (Page* page : m_lru) {
+        if (page->dirty && page->file == file) pages.push_back(page);
+    }
+    flushPages(lock, pages);
+}
+
+void BufferPool::flushAll() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    std::vector<Page*> pages;
+    for (Page* page : m_lru) {
+        if (page->dirty) pages.push_back(page);
+    }
+    flushPages(lock, pages);
+}
+
+void BufferPool::syncFiles() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& file : m_unsynced) {
+        auto it = m_handles.find(file);
+        if (it == m_handles.end()) continue;   // 文件已被删除
+        std::lock_guard<std::mutex> file_lock(it->second->mutex);
+#ifdef _WIN32
+        _commit(_fileno(it->second->file));
+#else
+        fsync(fileno(it->second->file));
+#endif
+    }
+    m_unsynced.clear();
+}
+
+void BufferPool::discardFile(const std::string& file) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    // 正在读入的页等读入完成再丢弃，页框才能安全地重新使用
+    m_loaded.wait(lock, [&]() {
+        return std::none_of(m_lru.begin(), m_lru.end(), [&](const Page* page) {
+            return page->loading && page->file == file;
+            });
+        });
+    for (auto it = m_lru.begin(); it != m_lru.end();) {
+        Page* page = *it;
+        if (page->file != file) { ++it; continue; }
+        it = m_lru.erase(it);
+        dropPage(page);
+        page->pin_count = 0;
+        m_free.push_back(page);
+    }
+    m_file_sizes.erase(file);
+    m_handles.erase(file);   // 关闭文件，之后可以删除
+}
+
+void BufferPool::setCapacity(size_t capacity) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_capacity = std::max(capacity, MIN_CAPACITY);
+    m_stats.capacity = m_capacity;
+    // 缩小时取出多余的页框（空闲的或按 LRU 淘汰的）释放掉；剩下的都被 pin 住时留到以后
+    while (m_frames.size() > m_capacity) {
+        bool evictable = !m_free.empty() || std::any_of(m_lru.begin(), m_lru.end(),
+            [](const Page* page) { return page->pin_count == 0; });
+        if (!evictable) break;
+        Page* page = allocateFrame(lock);
+        m_frames.erase(std::find_if(m_frames.begin(), m_frames.end(),
+            [page](const std::unique_ptr<Page>& frame) { return frame.get() == page; }));
+    }
+}
+
+BufferPool::Stats BufferPool::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats = m_stats;
+    stats.resident = m_page_table.size();
+    stats.dirty = 0;
+    for (const Page* page : m_lru) {
+        if (page->dirty) stats.dirty++;
+    }
+    return stats;
+}
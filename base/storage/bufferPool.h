@@ -0,0 +1,147 @@
+#pragma once
+
+#ifndef BUFFERPOOL_H
+#define BUFFERPOOL_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <cstdio>
+#include <functional>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+
+// 页式缓冲池：记录文件(.trd)的所有读写都经过这里，
+// 以固定大小的页为单位缓存在内存中，LRU 淘汰，脏页在淘汰/刷盘时写回。
+// 每个文件只打开一次；未命中时先把页框标记为读入中，读磁盘时不持有缓冲池的锁，
+// 同时访问这一页的线程等待读入完成
+class BufferPool {
+public:
+    static constexpr size_t PAGE_SIZE = 8192;          // 页大小 8KB
+    static constexpr size_t DEFAULT_CAPACITY = 1024;   // 默认 1024 页（8MB）
+    static constexpr size_t MIN_CAPACITY = 64;         // 并行扫描时每个线程都要 pin 住页，容量不能过小
+
+    struct Page {
+        std::string file;           // 所属文件
+        uint32_t page_no = 0;       // 页号
+        int pin_count = 0;          // 引用计数，>0 时不可淘汰
+        bool dirty = false;         // 是否被修改过
+        uint64_t lsn = 0;           // 写回前日志至少要同步到这里（描述此前修改的日志的末尾）
+        bool pending = false;       // 最近的修改还没有记下日志位置（日志已先于修改追加），写回前等到当前的日志末尾
+        bool loading = false;       // 正在从磁盘读入，读入完成前其他线程不能使用
+        std::list<Page*>::iterator lru_pos;
+        char data[PAGE_SIZE];
+    };
+
+    // 命中/未命中等统计信息
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t flushes = 0;
+        size_t resident = 0;
+        size_t dirty = 0;
+        size_t capacity = 0;
+    };
+
+    BufferPool();   // 容量为 defaultCapacity()
+    explicit BufferPool(size_t capacity);
+    ~BufferPool();
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    // 取页并 pin 住，用完必须 unpinPage
+    Page* fetchPage(const std::string& file, uint32_t page_no);
+    void unpinPage(Page* page, bool dirty);
+
+    // 按字节读写（可跨页），返回实际读取的字节数
+    size_t read(const std::string& file, uint64_t offset, char* buf, size_t len);
+    void write(const std::string& file, uint64_t offset, const char* buf, size_t len);
+    uint64_t append(const std::string& file, const char* buf, size_t len);  // 返回写入位置
+
+    uint64_t fileSize(const std::string& file);   // 逻辑文件大小（含未刷盘的追加）
+    void truncate(const std::string& file);       // 清空文件（整表重写时使用）
+
+    void flushFile(const std::string& file);
+    void flushAll();
+    // 把写回过脏页的文件同步到磁盘（fsync），检查点截断日志前使用
+    void syncFiles();
+    void discardFile(const std::string& file);    // 丢弃缓存（删除表文件前调用）
+
+    Stats getStats() const;
+
+    // 调整容量（页数），缩小时淘汰多余的页并释放页框
+    void setCapacity(size_t capacity);
+    // SET buffer_pool_size：之后打开的数据库使用的缓冲池容量（页数）
+    static size_t defaultCapacity();
+    static void setDefaultCapacity(size_t capacity);
+
+    // 日志追加到 lsn：此前修改、还没有对应日志位置的页以 lsn 作为写回前要等待的位置
+    void logAppended(uint64_t lsn);
+
+    // 表示“当前的日志末尾”的 LSN
+    static constexpr uint64_t UNKNOWN_LSN = UINT64_MAX;
+    // 脏页写回磁盘前调用（不持有缓冲池的锁）：等待日志同步到 lsn（UNKNOWN_LSN 为当前末尾），
+    // 返回已同步到的位置。预写日志借此保证日志先于数据页落盘
+    using BeforeWriteHook = std::function<uint64_t(uint64_t lsn)>;
+    static void setBeforeWriteHook(BeforeWriteHook hook);
+
+private:
+    struct PageKey {
+        std::string file;
+        uint32_t page_no;
+        bool operator==(const PageKey& other) const {
+            return page_no == other.page_no && file == other.file;
+        }
+    };
+    struct PageKeyHash {
+        size_t operator()(const PageKey& key) const {
+            return std::hash<std::string>()(key.file) ^ (std::hash<uint32_t>()(key.page_no) << 1);
+        }
+    };
+
+    // 以下函数调用时持有 lock，等待日志期间会暂时释放
+    // 文件句柄：同一文件的所有页共用，定位和读写要成对进行
+    struct FileHandle {
+        std::FILE* file = nullptr;
+        std::mutex mutex;
+        ~FileHandle() {
+            if (file) std::fclose(file);
+        }
+    };
+    // 取得文件句柄，create 为 false 且文件不存在时返回空
+    std::shared_ptr<FileHandle> openFile(const std::string& file, bool create);
+    static void readPage(FileHandle* handle, uint32_t page_no, char* data);
+
+    Page* fetchLocked(std::unique_lock<std::mutex>& lock, const std::string& file, uint32_t page_no);
+    Page* allocateFrame(std::unique_lock<std::mutex>& lock);
+    // waited：已经等过的日志位置，不再为它重复等待
+    void flushPage(std::unique_lock<std::mutex>& lock, Page* page, uint64_t waited = 0);
+    void flushPages(std::unique_lock<std::mutex>& lock, const std::vector<Page*>& pages);
+    void waitForLog(std::unique_lock<std::mutex>& lock, uint64_t lsn);
+    void markDirty(Page* page);
+    void dropPage(Page* page);
+    uint64_t& sizeOf(const std::string& file);
+
+    size_t m_capacity;
+    std::vector<std::unique_ptr<Page>> m_frames;            // 所有页框
+    std::vector<Page*> m_free;                               // 空闲页框
+    std::unordered_map<PageKey, Page*, PageKeyHash> m_page_table;
+    std::list<Page*> m_lru;                                  // 表头为最近使用
+    std::unordered_map<std::string, uint64_t> m_file_sizes;
+    std::unordered_map<std::string, std::shared_ptr<FileHandle>> m_handles;
+    std::condition_variable m_loaded;                        // 页读入完成
+    std::unordered_set<std::string> m_unsynced;             // 写回后尚未同步的文件
+    std::unordered_set<Page*> m_pending;                     // 修改后还没有记下日志位置的页
+    uint64_t m_durable_lsn = 0;                              // 已知日志同步到的位置
+    mutable std::mutex m_mutex;
+    Stats m_stats;
+    static BeforeWriteHook s_before_write;
+};
+
+#endif // BUFFERPOOL_H
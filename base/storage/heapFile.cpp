@@ -0,0 +1,383 @@
+#include "heapFile.h"
+#include <filesystem>
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    const char HEAP_MAGIC[8] = { 'T', 'R', 'D', 'S', 'L', 'O', 'T', '1' };
+
+    HeapPageHeader* pageHeader(char* data) {
+        return reinterpret_cast<HeapPageHeader*>(data);
+    }
+    const HeapPageHeader* pageHeader(const char* data) {
+        return reinterpret_cast<const HeapPageHeader*>(data);
+    }
+    HeapSlot* slotAt(char* data, uint16_t slot) {
+        return reinterpret_cast<HeapSlot*>(data + sizeof(HeapPageHeader)) + slot;
+    }
+    const HeapSlot* slotAt(const char* data, uint16_t slot) {
+        return reinterpret_cast<const HeapSlot*>(data + sizeof(HeapPageHeader)) + slot;
+    }
+    uint64_t rowIdOf(const char* record) {
+        uint64_t row_id;
+        std::memcpy(&row_id, record, sizeof(uint64_t));
+        return row_id;
+    }
+}
+
+HeapFile::HeapFile(BufferPool& pool, const std::string& path, size_t legacy_record_size)
+    : m_pool(pool), m_path(path) {
+    std::memset(&m_header, 0, sizeof(m_header));
+    open(legacy_record_size);
+}
+
+bool HeapFile::isSlottedFile(BufferPool& pool, const std::string& path) {
+    char magic[sizeof(HEAP_MAGIC)] = {};
+    if (pool.read(path, 0, magic, sizeof(magic)) < sizeof(magic)) return false;
+    return std::memcmp(magic, HEAP_MAGIC, sizeof(HEAP_MAGIC)) == 0;
+}
+
+void HeapFile::open(size_t legacy_record_size) {
+    if (m_pool.fileSize(m_path) == 0) {
+        initEmpty();
+        return;
+    }
+    if (!isSlottedFile(m_pool, m_path)) {
+        if (legacy_record_size == 0) {
+            throw std::runtime_error("记录文件格式无法识别: " + m_path);
+        }
+        convertLegacyFile(m_pool, m_path, legacy_record_size);
+    }
+
+    m_pool.read(m_path, 0, reinterpret_cast<char*>(&m_header), sizeof(m_header));
+    if (m_header.version != VERSION) {
+        throw std::runtime_error("不支持的记录文件版本: " + m_path);
+    }
+
+    // 扫描所有数据页，重建定位表和空闲空间表
+    m_fsm.assign(m_header.page_count, 0);
+    for (uint32_t page_no = 1; page_no < m_header.page_count; ++page_no) {
+        BufferPool::Page* page = m_pool.fetchPage(m_path, page_no);
+        const HeapPageHeader* ph = pageHeader(page->data);
+        for (uint16_t s = 0; s < ph->slot_count; ++s) {
+            const HeapSlot* slot = slotAt(page->data, s);
+            if (slot->length == 0) continue;
+            uint64_t row_id = rowIdOf(page->data + slot->offset);
+            m_locator[row_id] = RowLocation{ page_no, s };
+            trackDeleteFlag(row_id, page->data + slot->offset, slot->length);
+        }
+        m_fsm[page_no] = static_cast<uint16_t>(freeSpace(page->data));
+        m_pool.unpinPage(page, false);
+    }
+}
+
+void HeapFile::initEmpty() {
+    std::memcpy(m_header.magic, HEAP_MAGIC, sizeof(HEAP_MAGIC));
+    m_header.version = VERSION;
+    m_header.page_count = 1;
+    m_header.next_row_id = 1;
+
+    std::vector<char> page(PAGE_SIZE, 0);
+    std::memcpy(page.data(), &m_header, sizeof(m_header));
+    m_pool.write(m_path, 0, page.data(), page.size());
+
+    m_locator.clear();
+    m_tombstones.clear();
+    m_fsm.assign(1, 0);
+    m_fsm_hint = 1;
+}
+
+void HeapFile::trackDeleteFlag(uint64_t row_id, const char* record, size_t len) {
+    if (len > DELETE_FLAG_OFFSET && record[DELETE_FLAG_OFFSET] == 1) m_tombstones.insert(row_id);
+    else m_tombstones.erase(row_id);
+}
+
+void HeapFile::writeHeader() {
+    m_pool.write(m_path, 0, reinterpret_cast<const char*>(&m_header), sizeof(m_header));
+}
+
+uint32_t HeapFile::allocatePage() {
+    uint32_t page_no = m_header.page_count;
+
+    std::vector<char> page(PAGE_SIZE, 0);
+    HeapPageHeader* ph = pageHeader(page.data());
+    ph->slot_count = 0;
+    ph->free_end = static_cast<uint16_t>(PAGE_SIZE);
+    ph->live_count = 0;
+    m_pool.write(m_path, static_cast<uint64_t>(page_no) * PAGE_SIZE, page.data(), page.size());
+
+    m_header.page_count++;
+    writeHeader();
+    m_fsm.push_back(static_cast<uint16_t>(freeSpace(page.data())));
+    return page_no;
+}
+
+uint32_t HeapFile::findPageWithSpace(size_t len) {
+    for (uint32_t page_no = std::max<uint32_t>(m_fsm_hint, 1); page_no < m_fsm.size(); ++page_no) {
+        if (m_fsm[page_no] >= len) {
+            m_fsm_hint = page_no;
+            return page_no;
+        }
+    }
+    uint32_t page_no = allocatePage();
+    m_fsm_hint = page_no;
+    return page_no;
+}
+
+// 页内可用空间：总大小减去页头、槽目录和有效记录
+size_t HeapFile::freeSpace(const char* data) {
+    const HeapPageHeader* ph = pageHeader(data);
+    size_t used = sizeof(HeapPageHeader) + ph->slot_count * sizeof(HeapSlot);
+    for (uint16_t s = 0; s < ph->slot_count; ++s) {
+        used += slotAt(data, s)->length;
+    }
+    return PAGE_SIZE - used;
+}
+
+// 槽目录末尾到记录区之间连续的空闲字节
+size_t HeapFile::contiguousSpace(const char* data) {
+    const HeapPageHeader* ph = pageHeader(data);
+    return ph->free_end - (sizeof(HeapPageHeader) + ph->slot_count * sizeof(HeapSlot));
+}
+
+// 整理页内碎片：把有效记录紧密地挪到页尾，槽号不变
+void HeapFile::compactPage(char* data) {
+    std::vector<char> tmp(PAGE_SIZE, 0);
+    HeapPageHeader* ph = pageHeader(data);
+    uint16_t free_end = static_cast<uint16_t>(PAGE_SIZE);
+
+    for (uint16_t s = 0; s < ph->slot_count; ++s) {
+        HeapSlot* slot = slotAt(data, s);
+        if (slot->length == 0) continue;
+        free_end -= slot->length;
+        std::memcpy(tmp.data() + free_end, data + slot->offset, slot->length);
+        slot->offset = free_end;
+    }
+
+    size_t dir_end = sizeof(HeapPageHeader) + ph->slot_count * sizeof(HeapSlot);
+    std::memset(data + dir_end, 0, free_end - dir_end);
+    std::memcpy(data + free_end, tmp.data() + free_end, PAGE_SIZE - free_end);
+    ph->free_end = free_end;
+}
+
+RowLocation HeapFile::place(const std::string& record) {
+    if (record.size() > MAX_RECORD_SIZE) {
+        throw std::runtime_error("记录长度 " + std::to_string(record.size()) + " 超过单页容量");
+    }
+
+    uint32_t page_no = findPageWithSpace(record.size() + sizeof(HeapSlot));
+    BufferPool::Page* page = m_pool.fetchPage(m_path, page_no);
+    HeapPageHeader* ph = pageHeader(page->data);
+
+    // 优先复用空槽
+    uint16_t slot_no = ph->slot_count;
+    for (uint16_t s = 0; s < ph->slot_count; ++s) {
+        if (slotAt(page->data, s)->length == 0) {
+            slot_no = s;
+            break;
+        }
+    }
+    size_t need = record.size() + (slot_no == ph->slot_count ? sizeof(HeapSlot) : 0);
+    if (contiguousSpace(page->data) < need) {
+        compactPage(page->data);
+    }
+    if (slot_no == ph->slot_count) {
+        ph->slot_count++;
+    }
+
+    ph->free_end = static_cast<uint16_t>(ph->free_end - record.size());
+    std::memcpy(page->data + ph->free_end, record.data(), record.size());
+    HeapSlot* slot = slotAt(page->data, slot_no);
+    slot->offset = ph->free_end;
+    slot->length = static_cast<uint16_t>(record.size());
+    ph->live_count++;
+
+    m_fsm[page_no] = static_cast<uint16_t>(freeSpace(page->data));
+    m_pool.unpinPage(page, true);
+    return RowLocation{ page_no, slot_no };
+}
+
+void HeapFile::removeSlot(const RowLocation& loc) {
+    BufferPool::Page* page = m_pool.fetchPage(m_path, loc.page_no);
+    HeapPageHeader* ph = pageHeader(page->data);
+
+    HeapSlot* slot = slotAt(page->data, loc.slot);
+    slot->offset = 0;
+    slot->length = 0;
+    ph->live_count--;
+
+    // 收缩末尾的空槽，记录区的空洞留到下次插入时整理
+    while (ph->slot_count > 0 && slotAt(page->data, ph->slot_count - 1)->length == 0) {
+        ph->slot_count--;
+    }
+    if (ph->slot_count == 0) {
+        ph->free_end = static_cast<uint16_t>(PAGE_SIZE);
+    }
+
+    m_fsm[loc.page_no] = static_cast<uint16_t>(freeSpace(page->data));
+    m_fsm_hint = std::min(m_fsm_hint, loc.page_no);
+    m_pool.unpinPage(page, true);
+}
+
+uint64_t HeapFile::insert(std::string record) {
+    if (record.size() < sizeof(uint64_t)) {
+        throw std::runtime_error("记录格式错误");
+    }
+    uint64_t row_id = m_header.next_row_id++;
+    std::memcpy(&record[ROW_ID_OFFSET], &row_id, sizeof(uint64_t));
+
+    m_locator[row_id] = place(record);
+    trackDeleteFlag(row_id, record.data(), record.size());
+    writeHeader();
+    return row_id;
+}
+
+void HeapFile::insertWithRowId(const std::string& record) {
+    if (record.size() < sizeof(uint64_t)) {
+        throw std::runtime_error("记录格式错误");
+    }
+    uint64_t row_id = rowIdOf(record.data());
+    if (contains(row_id)) {
+        update(row_id, record);
+        return;
+    }
+
+    m_locator[row_id] = place(record);
+    trackDeleteFlag(row_id, record.data(), record.size());
+    if (row_id >= m_header.next_row_id) {
+        m_header.next_row_id = row_id + 1;
+        writeHeader();
+    }
+}
+
+bool HeapFile::contains(uint64_t row_id) const {
+    return m_locator.count(row_id) > 0;
+}
+
+bool HeapFile::read(uint64_t row_id, std::string& record) {
+    auto it = m_locator.find(row_id);
+    if (it == m_locator.end()) return false;
+
+    BufferPool::Page* page = m_pool.fetchPage(m_path, it->second.page_no);
+    const HeapSlot* slot = slotAt(page->data, it->second.slot);
+    record.assign(page->data + slot->offset, slot->length);
+    m_pool.unpinPage(page, false);
+    return true;
+}
+
+bool HeapFile::update(uint64_t row_id, const std::string& record) {
+    auto it = m_locator.find(row_id);
+    if (it == m_locator.end()) return false;
+
+    trackDeleteFlag(row_id, record.data(), record.size());
+    BufferPool::Page* page = m_pool.fetchPage(m_path, it->second.page_no);
+    HeapSlot* slot = slotAt(page->data, it->second.slot);
+    if (slot->length == record.size()) {
+        // 定长记录：原地覆盖，只弄脏这一页
+        std::memcpy(page->data + slot->offset, record.data(), record.size());
+        m_pool.unpinPage(page, true);
+        return true;
+    }
+    m_pool.unpinPage(page, false);
+
+    removeSlot(it->second);
+    it->second = place(record);
+    return true;
+}
+
+bool HeapFile::write(uint64_t row_id, size_t offset, const char* data, size_t len) {
+    auto it = m_locator.find(row_id);
+    if (it == m_locator.end()) return false;
+
+    BufferPool::Page* page = m_pool.fetchPage(m_path, it->second.page_no);
+    HeapSlot* slot = slotAt(page->data, it->second.slot);
+    if (offset + len > slot->length) {
+        m_pool.unpinPage(page, false);
+        throw std::runtime_error("写入位置超出记录范围");
+    }
+    std::memcpy(page->data + slot->offset + offset, data, len);
+    if (offset <= DELETE_FLAG_OFFSET && DELETE_FLAG_OFFSET < offset + len) {
+        trackDeleteFlag(row_id, page->data + slot->offset, slot->length);
+    }
+    m_pool.unpinPage(page, true);
+    return true;
+}
+
+bool HeapFile::erase(uint64_t row_id) {
+    auto it = m_locator.find(row_id);
+    if (it == m_locator.end()) return false;
+
+    removeSlot(it->second);
+    m_locator.erase(it);
+    m_tombstones.erase(row_id);
+    return true;
+}
+
+void HeapFile::scan(const std::function<bool(uint64_t row_id, const char* data, size_t len)>& visit) {
+    scanPages(1, m_header.page_count, visit);
+}
+
+bool HeapFile::scanPages(uint32_t first_page, uint32_t end_page,
+    const std::function<bool(uint64_t row_id, const char* data, size_t len)>& visit) {
+    end_page = std::min(end_page, m_header.page_count);
+    for (uint32_t page_no = std::max<uint32_t>(first_page, 1); page_no < end_page; ++page_no) {
+        BufferPool::Page* page = m_pool.fetchPage(m_path, page_no);
+        const HeapPageHeader* ph = pageHeader(page->data);
+        bool keep_going = true;
+
+        for (uint16_t s = 0; s < ph->slot_count && keep_going; ++s) {
+            const HeapSlot* slot = slotAt(page->data, s);
+            if (slot->length == 0) continue;
+            const char* record = page->data + slot->offset;
+            keep_going = visit(rowIdOf(record), record, slot->length);
+        }
+
+        m_pool.unpinPage(page, false);
+        if (!keep_going) return false;
+    }
+    return true;
+}
+
+void HeapFile::clear() {
+    m_pool.truncate(m_path);
+    initEmpty();
+}
+
+void HeapFile::flush() {
+    m_pool.flushFile(m_path);
+}
+
+// 旧格式：定长记录(row_id + delete_flag + 字段)首尾相接
+// 转换结果写到 .tmp 文件，刷盘并同步后再改名覆盖原文件；中途崩溃时原文件不变，下次打开重新转换
+size_t HeapFile::convertLegacyFile(BufferPool& pool, const std::string& path, size_t record_size) {
+    uint64_t file_size = pool.fileSize(path);
+    std::vector<char> legacy(static_cast<size_t>(file_size));
+    pool.read(path, 0, legacy.data(), legacy.size());
+
+    // 上次转换中断留下的临时文件
+    std::string temp = path + ".tmp";
+    std::error_code ec;
+    pool.discardFile(temp);
+    std::filesystem::remove(temp, ec);
+
+    size_t converted = 0;
+    {
+        HeapFile heap(pool, temp, 0);
+        for (size_t offset = 0; offset + record_size <= legacy.size(); offset += record_size) {
+            heap.insertWithRowId(std::string(legacy.data() + offset, record_size));
+            converted++;
+        }
+        heap.flush();
+    }
+    pool.syncFiles();
+
+    // 关闭两个文件的句柄并丢弃旧格式的缓存页，再替换原文件
+    pool.discardFile(temp);
+    pool.discardFile(path);
+    std::filesystem::rename(temp, path, ec);
+    if (ec) {
+        throw std::runtime_error("无法替换记录文件 " + path + ": " + ec.message());
+    }
+    return converted;
+}
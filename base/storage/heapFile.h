@@ -0,0 +1,115 @@
+#pragma once
+
+#ifndef HEAPFILE_H
+#define HEAPFILE_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
+#include "bufferPool.h"
+
+// .trd 文件的槽页(slotted page)格式：
+//   第 0 页为文件头：magic + 版本 + 页数 + 下一个 row_id
+//   其余为数据页：页头 + 槽目录(向后增长) ... 空闲 ... 记录数据(从页尾向前增长)
+// 每条记录的内容仍是 row_id + delete_flag + 各字段，与旧格式一致，
+// 因此记录编解码逻辑不变，只是记录不再按 row_id 顺序紧密排列
+
+struct HeapFileHeader {
+    char magic[8];          // "TRDSLOT1"
+    uint32_t version;       // 格式版本
+    uint32_t page_count;    // 总页数（含文件头页）
+    uint64_t next_row_id;   // 下一个可分配的 row_id
+};
+
+struct HeapPageHeader {
+    uint16_t slot_count;    // 槽目录项数（含空槽）
+    uint16_t free_end;      // 记录数据区起始位置，空闲区为 [槽目录末尾, free_end)
+    uint16_t live_count;    // 有效记录数
+    uint16_t reserved;
+};
+
+struct HeapSlot {
+    uint16_t offset;        // 记录在页内的偏移
+    uint16_t length;        // 记录长度，0 表示空槽
+};
+
+// row_id 在文件中的位置
+struct RowLocation {
+    uint32_t page_no;
+    uint16_t slot;
+};
+
+// 基于缓冲池的槽页堆文件，维护 row_id -> (页, 槽) 定位表和空闲空间表(FSM)
+// 打开时扫描一遍页面重建这两张表，之后按 row_id 定位为 O(1)
+// 非线程安全，写操作由上层串行执行
+class HeapFile {
+public:
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t PAGE_SIZE = BufferPool::PAGE_SIZE;
+    static constexpr size_t MAX_RECORD_SIZE = PAGE_SIZE - sizeof(HeapPageHeader) - sizeof(HeapSlot);
+    static constexpr size_t ROW_ID_OFFSET = 0;
+    static constexpr size_t DELETE_FLAG_OFFSET = sizeof(uint64_t);
+
+    // legacy_record_size：旧格式定长记录的大小，检测到旧格式文件时用于一次性转换
+    HeapFile(BufferPool& pool, const std::string& path, size_t legacy_record_size);
+
+    // 插入记录并分配新的 row_id（写入记录头部），返回该 row_id
+    uint64_t insert(std::string record);
+    // 按记录自带的 row_id 插入（重做/回滚使用），已存在则覆盖
+    void insertWithRowId(const std::string& record);
+
+    bool read(uint64_t row_id, std::string& record);
+    // 覆盖整条记录，长度相同时原地写，否则在页内或其他页重新放置
+    bool update(uint64_t row_id, const std::string& record);
+    // 修改记录中的部分字节（如删除标记）
+    bool write(uint64_t row_id, size_t offset, const char* data, size_t len);
+    // 物理删除，释放槽位
+    bool erase(uint64_t row_id);
+    bool contains(uint64_t row_id) const;
+
+    // 按页顺序遍历所有记录（含带删除标记的记录），回调返回 false 时提前结束
+    void scan(const std::function<bool(uint64_t row_id, const char* data, size_t len)>& visit);
+    // 只遍历页号在 [first_page, end_page) 内的数据页，供执行器按页分批读取；返回 false 表示被回调提前结束
+    bool scanPages(uint32_t first_page, uint32_t end_page,
+        const std::function<bool(uint64_t row_id, const char* data, size_t len)>& visit);
+
+    void clear();                       // 清空所有记录（整表重写时使用）
+    void flush();
+
+    size_t size() const { return m_locator.size(); }
+    // 带删除标记、等待回收的记录（打开时扫描得到，之后随写入的删除标记更新），回收时不必扫描整表
+    const std::unordered_set<uint64_t>& tombstones() const { return m_tombstones; }
+    uint64_t nextRowId() const { return m_header.next_row_id; }
+    uint32_t pageCount() const { return m_header.page_count; }
+
+    // 旧格式(定长记录紧密排列)文件一次性转换为槽页格式，返回转换的记录数
+    static size_t convertLegacyFile(BufferPool& pool, const std::string& path, size_t record_size);
+    static bool isSlottedFile(BufferPool& pool, const std::string& path);
+
+private:
+    void open(size_t legacy_record_size);
+    void initEmpty();
+    void writeHeader();
+    uint32_t allocatePage();
+    uint32_t findPageWithSpace(size_t len);
+    RowLocation place(const std::string& record);
+    void removeSlot(const RowLocation& loc);
+    static void compactPage(char* data);
+    static size_t freeSpace(const char* data);
+    static size_t contiguousSpace(const char* data);
+    // 按记录中的删除标记更新 m_tombstones
+    void trackDeleteFlag(uint64_t row_id, const char* record, size_t len);
+
+    BufferPool& m_pool;
+    std::string m_path;
+    HeapFileHeader m_header;
+    std::unordered_map<uint64_t, RowLocation> m_locator;    // row_id -> 位置
+    std::unordered_set<uint64_t> m_tombstones;              // 带删除标记的 row_id
+    std::vector<uint16_t> m_fsm;                            // 每页可用字节数（下标为页号）
+    uint32_t m_fsm_hint = 1;                                // 从这一页开始查找空闲页
+};
+
+#endif // HEAPFILE_H
@@ -2,6 +2,7 @@
 #include <iostream>
 #include <ctime>
 #include "parse/parse.h"
+#include <base/Record/record.h>
 #include <cstring>
 #include <iomanip>
 #include <windows.h>
@@ -112,6 +113,7 @@ void Table::initializeNew() {
         }
         outFile.close();
     }
+    Catalog::bumpVersion();
 }
 
 
@@ -262,10 +264,12 @@ void Table::saveMetadataBinary() {
         tableBlock.crtime = m_createTime;
         tableBlock.mtime = m_lastModifyTime;
 
-        strncpy_s(tableBlock.tdf, (m_tableName + ".tdf").c_str(), sizeof(tableBlock.tdf) - 1);
-        strncpy_s(tableBlock.tic, (m_tableName + ".tic").c_str(), sizeof(tableBlock.tic) - 1);
-        strncpy_s(tableBlock.trd, (m_tableName + ".trd").c_str(), sizeof(tableBlock.trd) - 1);
-        strncpy_s(tableBlock.tid, (m_tableName + ".tid").c_str(), sizeof(tableBlock.tid) - 1);
+        // 与更新已有记录时一致写入完整路径，建表后未再修改元数据时重新加载也能找到文件
+        strncpy_s(tableBlock.tdf, (m_tdf).c_str(), sizeof(tableBlock.tdf) - 1);
+        strncpy_s(tableBlock.tic, (m_tic).c_str(), sizeof(tableBlock.tic) - 1);
+        strncpy_s(tableBlock.trd, (m_trd).c_str(), sizeof(tableBlock.trd) - 1);
+        strncpy_s(tableBlock.tid, (m_tid).c_str(), sizeof(tableBlock.tid) - 1);
+        strcpy_s(tableBlock.abledUsers, sizeof(tableBlock.abledUsers), m_abledUsers.c_str());
 
         tbFile.clear(); // 清除 EOF 状态以便写入
         tbFile.seekp(0, std::ios::end);
@@ -273,6 +277,7 @@ void Table::saveMetadataBinary() {
     }
 
     tbFile.close();
+    m_metadataDirty = false;
 }
 
 //从.tb文件中删除表的元数据
@@ -564,6 +569,15 @@ bool Table::isTableExist() const {
 //从磁盘中删除4个表定义文件
 void Table::deleteFilesDisk()
 {
+    // 先关闭堆文件并丢弃缓冲池中该表的页，避免之后被写回
+    dbManager::getInstance().get_current_database()->closeHeapFile(Record::get_trd_path(m_tableName));
+    // 索引页同样在缓冲池中，丢弃后删除 .ix 文件
+    m_btrees.clear();
+    for (const auto& index : indexes) {
+        dbManager::getInstance().get_current_database()->getBufferPool().discardFile(index.index_file);
+        std::remove(index.index_file);
+    }
+
 	// 删除表的相关文件
 	std::vector<std::string> filesToDelete = {
 		 // 表的定义文件
@@ -580,6 +594,7 @@ void Table::deleteFilesDisk()
 			throw std::runtime_error("文件删除失败: " + file);
 		}
 	}
+    Catalog::bumpVersion();
 }
 
 size_t get_field_size(const FieldBlock& field) {
@@ -60,7 +60,7 @@ public:
     std::vector<std::string> getFieldNames() const;
 
     //对表操作（添加、删除、更新字段）
-    std::vector<FieldBlock> getFields() const {
+    const std::vector<FieldBlock>& getFields() const {
         return m_fields;
     }
 
@@ -75,7 +75,7 @@ public:
     //表完整性文件
 
     //获取约束
-	std::vector<ConstraintBlock> getConstraints() const {
+	const std::vector<ConstraintBlock>& getConstraints() const {
 		return m_constraints;
 	}
 
@@ -107,9 +107,14 @@ public:
     void updateRecord_delete(const std::string& fieldName);
 
     // 增加记录计数（正数为增加，负数为减少）
+    // 只修改内存中的计数，由 flushMetadata 或下一次 saveMetadataBinary 写回 .tb
     void incrementRecordCount(int delta) {
         m_recordCount += delta;
-        saveMetadataBinary();
+        m_metadataDirty = true;
+    }
+    // 元数据有未写回的修改时写回 .tb 文件
+    void flushMetadata() {
+        if (m_metadataDirty) saveMetadataBinary();
     }
     // 获取记录计数
     int getRecordCount() const {
@@ -117,10 +122,29 @@ public:
     }
 
 
+    // 自增字段已分配的最大值，未缓存时返回 false
+    bool getAutoIncrement(const std::string& fieldName, long long& value) const {
+        auto it = m_autoIncrement.find(fieldName);
+        if (it == m_autoIncrement.end()) return false;
+        value = it->second;
+        return true;
+    }
+    void setAutoIncrement(const std::string& fieldName, long long value) {
+        m_autoIncrement[fieldName] = value;
+    }
+    // 记录被修改或重做后缓存可能过期，下次插入时重新扫描
+    void resetAutoIncrement() {
+        m_autoIncrement.clear();
+    }
+
     //表索引文件
     void saveIndex();
     void loadIndex();
     void createIndex(const IndexBlock& index);
+    // 顺序扫描一遍表，为给出的各索引收集 (键, row_id)，排序后自底向上批量构建（覆盖原有内容）
+    void buildIndexes(const std::vector<std::pair<const IndexBlock*, BTree*>>& targets);
+    // 用表中现有的记录重建全部索引，批量导入大量记录后使用
+    void rebuildIndexes();
     void addIndex(const IndexBlock& index);
     void dropIndex(const std::string indexName);
     void updateIndex(const std::string indexName, const IndexBlock& updatedIndex);
@@ -163,6 +187,8 @@ private:
     std::time_t m_createTime;     // 表的创建时间
     std::time_t m_lastModifyTime; // 表的最后修改时间
     std::string m_abledUsers;       //表级权限字段
+    bool m_metadataDirty = false;   // 记录数等元数据是否有未写回 .tb 的修改
+    std::unordered_map<std::string, long long> m_autoIncrement; // 自增字段名 -> 已分配的最大值
 
     std::vector<FieldBlock> m_fields;               // 存储表的字段信息
     std::vector<ConstraintBlock> m_constraints;     // 存储表的完整性约束信息
@@ -47,6 +47,7 @@ void Table::saveDefineBinary() {
     }
 
     out.close();
+    Catalog::bumpVersion();
 }
 
 FieldBlock* Table::getFieldByName(const std::string& fieldName) const{
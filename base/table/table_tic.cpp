@@ -20,6 +20,7 @@ void Table::loadIntegrityBinary() {
         in.close();
         return;  // 如果文件为空，直接返回
     }
+    in.seekg(0, std::ios::beg);  // 回到文件头再读取约束
 
     // 清空已有的约束数据
     m_constraints.clear();
@@ -47,6 +48,7 @@ void Table::saveIntegrityBinary() {
     }
 
     out.close();
+    Catalog::bumpVersion();
 }
 
 void Table::addForeignKey(const std::string& constraintName,
@@ -39,9 +39,19 @@ void Table::loadIndex() {
         if (in.gcount() < sizeof(IndexBlock)) break;
         indexes.push_back(index);
 
-        // 为每个索引创建 B 树对象并加载索引数据
+        // 为每个索引创建 B 树对象并加载索引数据，单字段索引按字段类型比较键
+        int keyType = 3, keyParam = 0;
+        if (index.field_num == 1) {
+            for (const auto& field : m_fields) {
+                if (field.name == std::string(index.field[0])) {
+                    keyType = field.type;
+                    keyParam = field.param;
+                    break;
+                }
+            }
+        }
         IndexBlock* indexCopy = new IndexBlock(index);  // 注意生命周期管理
-        std::unique_ptr<BTree> btree = std::make_unique<BTree>(indexCopy);
+        std::unique_ptr<BTree> btree = std::make_unique<BTree>(indexCopy, keyType, keyParam);
 
         try {
             btree->loadBTreeIndex();  // 加载磁盘中已保存的 B 树结构
@@ -73,34 +83,14 @@ void Table::createIndex(const IndexBlock& index) {
         throw std::runtime_error("字段 " + fieldName2 + " 不存在！");
     }
 
-    // 2. 创建 BTree 对象
+    // 2. 创建 BTree 对象，单字段索引按字段类型比较键，组合索引按文本比较
     IndexBlock* indexCopy = new IndexBlock(index);
-    std::unique_ptr<BTree> btree = std::make_unique<BTree>(indexCopy);
-
-    // 3. 读取所有记录
-    auto records = Record::read_records(m_tableName); // m_name 是表名
-    for (const auto& [row_id, data] : records) {  // row_id 是 uint64_t 类型
-        auto it1 = data.find(fieldName1);
-        if (it1 == data.end()) continue;
-        std::string field_value1 = it1->second;
-        std::string field_value2;
-
-        if (index.field_num == 2) {
-            auto it2 = data.find(fieldName2);
-            if (it2 == data.end()) continue;
-            field_value2 = it2->second;
-        }
+    std::unique_ptr<BTree> btree = index.field_num == 1
+        ? std::make_unique<BTree>(indexCopy, field1->type, field1->param)
+        : std::make_unique<BTree>(indexCopy);
 
-        RecordPointer recordPtr;
-        recordPtr.row_id = row_id;  // 这里的 row_id 是 uint64_t 类型
-
-        if (index.field_num == 1) {
-            btree->insert(field_value1, recordPtr);
-        }
-        else {
-            btree->insert(field_value1 + "," + field_value2, recordPtr);
-        }
-    }
+    // 3. 顺序扫描一遍表，收集 (键, row_id) 后排序，自底向上批量构建
+    buildIndexes({ { &index, btree.get() } });
 
     // 4. 保存 B 树到文件
     btree->saveBTreeIndex();
@@ -114,6 +104,60 @@ void Table::createIndex(const IndexBlock& index) {
 
 
 
+void Table::buildIndexes(const std::vector<std::pair<const IndexBlock*, BTree*>>& targets) {
+    if (targets.empty()) return;
+
+    struct Target {
+        const IndexBlock* index;
+        BTree* btree;
+        std::unique_ptr<IndexEntrySorter> sorter;
+        int pos1 = -1, pos2 = -1;
+    };
+    std::vector<Target> builds;
+    for (const auto& [index, btree] : targets) {
+        builds.push_back(Target{ index, btree, std::make_unique<IndexEntrySorter>(index->index_file) });
+    }
+
+    // 一次扫描同时为所有索引收集条目
+    RowSchema schema;
+    bool resolved = false;
+    Record::scan_rows(m_tableName, schema, [&](Row& row) {
+        if (!resolved) {
+            for (auto& build : builds) {
+                build.pos1 = schema.find(build.index->field[0]);
+                build.pos2 = build.index->field_num == 2 ? schema.find(build.index->field[1]) : -1;
+            }
+            resolved = true;
+        }
+        for (auto& build : builds) {
+            FieldPointer fieldPtr;
+            fieldPtr.recordPtr.row_id = row.row_id;
+            if (build.index->field_num == 1) {
+                fieldPtr.fieldValue = row.values[build.pos1];
+            }
+            else {
+                // 组合索引的键与插入时一致：两个字段的文本以逗号连接
+                fieldPtr.fieldValue = build.btree->makeKey(row.values[build.pos1].toString() + "," + row.values[build.pos2].toString());
+            }
+            build.sorter->add(std::move(fieldPtr));
+        }
+        return true;
+        });
+
+    for (auto& build : builds) {
+        build.btree->bulkLoad([&](FieldPointer& fieldPtr) { return build.sorter->next(fieldPtr); });
+    }
+}
+
+void Table::rebuildIndexes() {
+    std::vector<std::pair<const IndexBlock*, BTree*>> targets;
+    for (const auto& index : indexes) {
+        BTree* btree = getBTreeByIndexName(index.name);
+        if (btree) targets.emplace_back(&index, btree);
+    }
+    buildIndexes(targets);
+}
+
 void Table::addIndex(const IndexBlock& index){
 	createIndex(index);
 	// 创建索引
@@ -140,7 +184,8 @@ void Table::dropIndex(const std::string indexName) {
     // 获取索引的文件路径
     std::string indexFilePath = it->index_file;
 
-    // 删除索引文件 (.ix 文件)
+    // 删除索引文件 (.ix 文件)，先丢弃缓冲池中该文件的页，避免之后被写回
+    dbManager::getInstance().get_current_database()->getBufferPool().discardFile(indexFilePath);
     if (std::remove(indexFilePath.c_str()) == 0) {
         std::cout << "索引文件 " << indexFilePath << " 删除成功。" << std::endl;
     } else {
@@ -53,28 +53,17 @@ void Table::updateRecord_add(FieldBlock& new_field) {
     std::vector<FieldBlock> updated_fields = m_fields;
     updated_fields.push_back(new_field);
 
-    std::ofstream file(m_trd, std::ios::binary | std::ios::trunc);
-    if (!file) {
-        throw std::runtime_error("无法打开表文件 '" + m_tableName + ".trd'");
-    }
-
+    // 字段变化后记录长度改变，整表按新布局重写，row_id 保持不变
+    HeapFile& heap = Record::heap_file(m_tableName, m_fields);
+    heap.clear();
     size_t written_count = 0;
     for (const auto& [row_id, record] : records) {
-        // 写入 row_id
-        file.write(reinterpret_cast<const char*>(&row_id), sizeof(uint64_t));
-
-        // 写入 delete_flag
-        char delete_flag = 0;
-        file.write(&delete_flag, sizeof(char));
-
-        for (const auto& fieldBlock : updated_fields) {
-            const std::string& value = record.at(fieldBlock.name);
-            Record::write_field(file, fieldBlock, value);
-        }
+        // row_id + delete_flag + 字段
+        heap.insertWithRowId(Record::encode_record(row_id, 0, updated_fields, record));
         ++written_count;
     }
+    heap.flush();
 
-    file.close();
     if (written_count != records.size()) {
         throw std::runtime_error("写入记录数量不一致！");
     }
@@ -103,29 +92,23 @@ void Table::updateRecord_delete(const std::string& fieldName) {
         record.erase(fieldName);
     }
 
-    std::ofstream file(m_trd, std::ios::binary | std::ios::trunc);
-    if (!file) {
-        throw std::runtime_error("无法打开文件 '" + m_tableName + ".trd' 进行写入。");
-    }
-
     for (const auto& [row_id, record] : full_records) {
-        // 写入 row_id
-        file.write(reinterpret_cast<const char*>(&row_id), sizeof(uint64_t));
-
-        // 写入 delete_flag
-        char delete_flag = 0;
-        file.write(&delete_flag, sizeof(char));
-
         for (const auto& fieldBlock : m_fields) {
-            auto it = record.find(fieldBlock.name);
-            if (it == record.end()) {
+            if (record.find(fieldBlock.name) == record.end()) {
                 throw std::runtime_error("字段 '" + std::string(fieldBlock.name) + "' 缺失对应值。");
             }
-            Record::write_field(file, fieldBlock, it->second);
         }
     }
 
-    file.close();
+    // 记录长度改变，整表按新布局重写，row_id 保持不变
+    HeapFile& heap = Record::heap_file(m_tableName, m_fields);
+    heap.clear();
+    for (const auto& [row_id, record] : full_records) {
+        // row_id + delete_flag + 字段
+        heap.insertWithRowId(Record::encode_record(row_id, 0, m_fields, record));
+    }
+    heap.flush();
+
     std::cout << "字段 '" << fieldName << "' 删除成功，记录已更新。" << std::endl;
 }
 
@@ -6,13 +6,101 @@
 #include <iomanip>
 #include <algorithm>
 #include <filesystem>
+#include <cstring>
 #include <set>
 #include <unordered_set>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 #include "base/record/Record.h"
+#include "base/catalog.h"
+#include "base/record/workerPool.h"
 
 #include <json.hpp>
 using json = nlohmann::json;
 
+namespace {
+
+constexpr char LOG_MAGIC[8] = { 'D', 'B', 'M', 'S', 'W', 'A', 'L', '1' };
+constexpr size_t FILE_HEADER_SIZE = 16;         // 魔数 + 起始 LSN
+constexpr size_t RECORD_HEADER_SIZE = 36;       // 长度到表名长度的定长部分
+constexpr size_t MAX_RECORD_SIZE = 64u << 20;   // 超过视为损坏
+constexpr size_t READ_CHUNK_SIZE = 4u << 20;    // 解析时每次读入的字节数
+
+// 列值的种类
+constexpr uint8_t COLUMN_NULL = 0;
+constexpr uint8_t COLUMN_FIXED = 1;   // 定长类型，数据为 .trd 中该字段去掉空标记和填充后的字节
+constexpr uint8_t COLUMN_TEXT = 2;    // 长度(4) + 原始文本，VARCHAR 及无法按类型编码的值
+
+template <typename T>
+void put(std::string& out, T v) {
+    out.append(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template <typename T>
+T load(const char* p) {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+// CRC32C（Castagnoli 多项式，反射形式 0x82F63B78），每次查表处理 8 字节
+struct Crc32cTable {
+    uint32_t t[8][256];
+    Crc32cTable() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c >> 1) ^ (0x82F63B78u & (0u - (c & 1)));
+            t[0][i] = c;
+        }
+        for (uint32_t i = 0; i < 256; i++) {
+            for (int k = 1; k < 8; k++) t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFF];
+        }
+    }
+};
+
+const Crc32cTable CRC32C_TABLE;
+
+uint32_t crc32c(const char* data, size_t len) {
+    const auto& t = CRC32C_TABLE.t;
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    uint32_t crc = 0xFFFFFFFFu;
+    while (len >= 8) {
+        uint32_t lo = load<uint32_t>(reinterpret_cast<const char*>(p)) ^ crc;
+        uint32_t hi = load<uint32_t>(reinterpret_cast<const char*>(p + 4));
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+            t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+        p += 8;
+        len -= 8;
+    }
+    while (len--) crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+    return ~crc;
+}
+
+// 把已写入的文件内容同步到磁盘，失败时返回 false
+bool syncFile(std::FILE* file) {
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#elif defined(__linux__)
+    return fdatasync(fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+// 写入并交给操作系统，全部写入才算成功
+bool writeFile(std::FILE* file, const std::string& data) {
+    return std::fwrite(data.data(), 1, data.size(), file) == data.size() && std::fflush(file) == 0;
+}
+
+bool isDml(LogType type) {
+    return type == LogType::INSERT || type == LogType::DELETE || type == LogType::UPDATE;
+}
+
+} // namespace
+
 // 单例实现
 
 LogManager& LogManager::instance() {
@@ -20,37 +108,197 @@ LogManager& LogManager::instance() {
     return instance;
 }
 
-// 构造函数
-LogManager::LogManager() : initialized(false) {}
+// 构造函数：数据页写回前等待描述它的日志同步到磁盘
+LogManager::LogManager() : logFile(nullptr), baseLsn(FILE_HEADER_SIZE), nextLsn(FILE_HEADER_SIZE),
+    writtenLsn(FILE_HEADER_SIZE), durableLsn(FILE_HEADER_SIZE), writeRequestLsn(0), syncRequestLsn(0),
+    writerRunning(false), writerStopping(false), writeFailed(false), synchronousCommit(true), nextTransactionId(1),
+    currentTransactionId(0), checkpointEndLsn(FILE_HEADER_SIZE), lastCheckpointTime(std::chrono::steady_clock::now()),
+    checkpointing(false), initialized(false) {
+    BufferPool::setBeforeWriteHook([this](uint64_t lsn) {
+        std::unique_lock<std::recursive_mutex> lock(logMutex);
+        lsn = std::min(lsn, nextLsn);
+        if (lsn > durableLsn) {
+            if (writerRunning) {
+                waitForLsn(lock, lsn, true);
+            }
+            else {
+                flushBuffer();
+            }
+        }
+        return durableLsn;
+    });
+}
+
+// 程序退出时做一次检查点，下次启动时不需要恢复
+LogManager::~LogManager() {
+    try {
+        createCheckpoint();
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Checkpoint failed: " << e.what() << std::endl;
+    }
+    BufferPool::setBeforeWriteHook(nullptr);
+    shutdown();
+}
 
 // 初始化日志管理器
 bool LogManager::initialize(const std::string& dbName) {
-    std::lock_guard<std::mutex> lock(logMutex);
+    {
+        std::lock_guard<std::recursive_mutex> lock(logMutex);
+        if (initialized && this->dbName == dbName) return true;
+    }
+    shutdown();  // 切换数据库
 
-    if (initialized) return true;
+    bool crashed = false;
+    std::vector<LogEntry> entries;
+    {
+        std::lock_guard<std::recursive_mutex> lock(logMutex);
+        this->dbName = dbName;
+        logFilePath = "DBMS_ROOT/data/" + dbName + "/" + dbName + ".log";
+
+        // 1. 解析日志文件
+        uint64_t validBytes = 0;
+        baseLsn = FILE_HEADER_SIZE;
+        entries = parseLogFile(validBytes);
+
+        // 2. 新建的、空的或旧格式的日志改写为只有文件头的二进制日志（旧日志的内容已读入 entries）；
+        //    最后一条记录写了一半时截掉它
+        std::error_code ec;
+        if (validBytes == 0) {
+            if (!createLogFile(baseLsn)) return false;
+            validBytes = FILE_HEADER_SIZE;
+        }
+        else if (std::filesystem::file_size(logFilePath, ec) > validBytes) {
+            std::filesystem::resize_file(logFilePath, validBytes, ec);
+        }
+        nextLsn = baseLsn + (validBytes - FILE_HEADER_SIZE);
+        writtenLsn = durableLsn = nextLsn;
+        writeRequestLsn = syncRequestLsn = 0;
+        writeFailed = false;
+        nextTransactionId = 1;
+        for (const auto& entry : entries) {
+            nextTransactionId = std::max(nextTransactionId, entry.transactionId + 1);
+        }
+        currentTransactionId = 0;
+        activeTransactions.clear();
+        checkpointEndLsn = nextLsn;
+        lastCheckpointTime = std::chrono::steady_clock::now();
+        logBuffer.clear();
+
+        // 3. 以追加模式打开日志文件
+        logFile = std::fopen(logFilePath.c_str(), "ab");
+        if (!logFile) {
+            return false;
+        }
+        initialized = true;
 
-    this->dbName = dbName;
-    logFilePath = "DBMS_ROOT/data/" + dbName + "/" + dbName + ".log";
+        crashed = isSystemCrashed(entries);
+    }
 
-    // 1. 打开日志文件（以追加模式）
-    logFile.open(logFilePath, std::ios::app);
-    if (!logFile.is_open()) {
-        return false;
+    // 4. 没有正常关闭时从最后一个检查点恢复，完成后再启动日志写线程。
+    //    恢复时不持有日志锁：并行重做的线程写回数据页时会进入日志锁
+    if (crashed) {
+        recover(entries);
     }
+    startWriter();
 
-    // 2. 解析日志文件
-    std::vector<LogEntry> entries = parseLogFile();
+    // 恢复的结果写回数据文件，下次启动不必再次恢复
+    if (crashed) {
+        createCheckpoint();
+    }
+    return true;
+}
 
-    // 3. 检查是否有未提交事务（崩溃恢复）
-    if (isSystemCrashed(entries)) {
-        recoverFromCrash();
+void LogManager::shutdown() {
+    stopWriter();
+    std::lock_guard<std::recursive_mutex> lock(logMutex);
+    if (!initialized) return;
+    try {
+        flushBuffer();
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Log flush failed: " << e.what() << std::endl;
     }
+    std::fclose(logFile);
+    logFile = nullptr;
+    initialized = false;
+}
 
-    initialized = true;
-    return true;
+void LogManager::startWriter() {
+    std::lock_guard<std::recursive_mutex> lock(logMutex);
+    if (writerRunning) return;
+    writerRunning = true;
+    writerStopping = false;
+    writer = std::thread(&LogManager::writerLoop, this);
 }
 
+// 日志写线程退出前写出并同步缓冲中剩余的日志
+void LogManager::stopWriter() {
+    {
+        std::lock_guard<std::recursive_mutex> lock(logMutex);
+        if (!writerRunning) return;
+        writerStopping = true;
+    }
+    writerCv.notify_all();
+    writer.join();
+    std::lock_guard<std::recursive_mutex> lock(logMutex);
+    writerRunning = false;
+    flushedCv.notify_all();
+}
 
+// 写入或同步失败时不推进 writtenLsn / durableLsn，标记失败后唤醒等待者，由它们报告错误
+void LogManager::writerLoop() {
+    std::unique_lock<std::recursive_mutex> lock(logMutex);
+    while (true) {
+        writerCv.wait_for(lock, std::chrono::milliseconds(WRITER_DELAY_MS), [this]() {
+            return writerStopping || (!writeFailed && (writeRequestLsn > writtenLsn || syncRequestLsn > durableLsn));
+            });
+        if (writeFailed || (logBuffer.empty() && durableLsn == writtenLsn)) {
+            if (writerStopping) break;
+            continue;
+        }
+
+        // 取走当前缓冲中的所有记录，写文件和同步时不持有锁，其他线程可以继续追加
+        writeBuffer.clear();
+        writeBuffer.swap(logBuffer);
+        uint64_t end = nextLsn;
+        lock.unlock();
+        bool ok = writeBuffer.empty() || writeFile(logFile, writeBuffer);
+        lock.lock();
+        if (!ok) {
+            writeFailed = true;
+            flushedCv.notify_all();
+            continue;
+        }
+        writtenLsn = end;
+        flushedCv.notify_all();
+
+        lock.unlock();
+        ok = syncFile(logFile);
+        lock.lock();
+        if (!ok) {
+            writeFailed = true;
+            flushedCv.notify_all();
+            continue;
+        }
+        durableLsn = end;
+        flushedCv.notify_all();
+    }
+}
+
+void LogManager::waitForLsn(std::unique_lock<std::recursive_mutex>& lock, uint64_t lsn, bool durable) {
+    uint64_t& done = durable ? durableLsn : writtenLsn;
+    if (done >= lsn) return;
+    if (!writeFailed) {
+        uint64_t& request = durable ? syncRequestLsn : writeRequestLsn;
+        request = std::max(request, lsn);
+        writerCv.notify_one();
+        flushedCv.wait(lock, [&]() { return done >= lsn || !writerRunning || writeFailed; });
+    }
+    if (done < lsn && writeFailed) {
+        throw std::runtime_error("日志写入磁盘失败，操作未能持久化: " + logFilePath);
+    }
+}
 
 // 日志记录插入操作
 void LogManager::logInsert( 
@@ -58,21 +306,33 @@ void LogManager::logInsert(
     uint64_t rowId, 
     const std::vector<std::pair<std::string, std::string>>& insertedValues)
 {
-    std::lock_guard<std::mutex> lock(logMutex);
+    std::lock_guard<std::recursive_mutex> lock(logMutex);
 
     if (!initialized) {
         std::cerr << "LogManager not initialized!" << std::endl;
         return;
     }
 
-    LogEntry entry;
-    entry.type = LogType::INSERT;
-    entry.tableName = tableName;
-    entry.rowId = rowId;
-    entry.newValues = insertedValues;
-    entry.timestamp = getCurrentTimestamp();
+    auto schema = dbManager::getInstance().get_current_database()->getCatalog().get(tableName);
+    appendRecord(LogType::INSERT, schema.get(), tableName, rowId, nullptr, &insertedValues);
+    pagesLogged();
+}
+
+void LogManager::logInsertBatch(const std::string& tableName,
+    const std::vector<std::pair<uint64_t, LogValues>>& inserts)
+{
+    std::lock_guard<std::recursive_mutex> lock(logMutex);
+
+    if (!initialized) {
+        std::cerr << "LogManager not initialized!" << std::endl;
+        return;
+    }
 
-    writeLogEntry(entry);
+    auto schema = dbManager::getInstance().get_current_database()->getCatalog().get(tableName);
+    for (const auto& [rowId, insertedValues] : inserts) {
+        appendRecord(LogType::INSERT, schema.get(), tableName, rowId, nullptr, &insertedValues);
+    }
+    pagesLogged();
 }
 
  //日志记录删除操作
@@ -80,134 +340,330 @@ void LogManager::logDelete(
     const std::string& tableName,
     uint64_t rowId,
     const std::vector<std::pair<std::string, std::string>>& values_to_delete) {
-    std::lock_guard<std::mutex> lock(logMutex);
+    std::lock_guard<std::recursive_mutex> lock(logMutex);
 
     if (!initialized) {
         std::cerr << "LogManager not initialized!" << std::endl;
         return;
     }
 
-    LogEntry entry;
-    entry.type = LogType::DELETE;
-    entry.tableName = tableName;
-    entry.rowId = rowId;
-    entry.oldValues = values_to_delete;
-    entry.timestamp = getCurrentTimestamp();
-
-    writeLogEntry(entry);
+    auto schema = dbManager::getInstance().get_current_database()->getCatalog().get(tableName);
+    appendRecord(LogType::DELETE, schema.get(), tableName, rowId, &values_to_delete, nullptr);
+    pagesLogged();
 }
 
  //日志记录更新操作
 void LogManager::logUpdate(const std::string& tableName, uint64_t rowId,
     const std::vector<std::pair<std::string, std::string>>& oldValues,
     const std::vector<std::pair<std::string, std::string>>& newValues) {
-    std::lock_guard<std::mutex> lock(logMutex);
+    std::lock_guard<std::recursive_mutex> lock(logMutex);
 
     if (!initialized) {
         std::cerr << "LogManager not initialized!" << std::endl;
         return;
     }
 
-    LogEntry entry;
-    entry.type = LogType::UPDATE;
-    entry.tableName = tableName;
-    entry.rowId = rowId;
-    entry.oldValues = oldValues;
-    entry.newValues = newValues;
-    entry.timestamp = getCurrentTimestamp();
+    auto schema = dbManager::getInstance().get_current_database()->getCatalog().get(tableName);
+    appendRecord(LogType::UPDATE, schema.get(), tableName, rowId, &oldValues, &newValues);
+    pagesLogged();
+}
 
-    writeLogEntry(entry);
+// 刚修改过的数据页已有对应的日志，写回前要等这些日志落盘
+void LogManager::pagesLogged() {
+    Database* db = dbManager::getInstance().get_current_database();
+    if (db && db->getDBName() == dbName) {
+        db->getBufferPool().logAppended(nextLsn);
+    }
 }
 
 // 记录BEGIN日志
 void LogManager::logBegin() {
-    std::lock_guard<std::mutex> lock(logMutex);
+    std::lock_guard<std::recursive_mutex> lock(logMutex);
 
     if (!initialized) {
         std::cerr << "LogManager not initialized!" << std::endl;
         return;
     }
 
-    LogEntry entry;
-    entry.type = LogType::BEGIN;
-    entry.rowId = 0; //为空
-    entry.timestamp = getCurrentTimestamp();
-    writeLogEntry(entry);
+    currentTransactionId = nextTransactionId++;
+    activeTransactions[currentTransactionId] = appendRecord(LogType::BEGIN, nullptr, "", 0);
 }
-// 记录事务提交
+// 记录事务提交：提交记录同步到磁盘后事务才算提交，同时等待的提交由日志写线程一次同步
 void LogManager::logCommit() {
-    std::lock_guard<std::mutex> lock(logMutex);
+    std::unique_lock<std::recursive_mutex> lock(logMutex);
 
     if (!initialized) {
         std::cerr << "LogManager not initialized!" << std::endl;
         return;
     }
 
-    LogEntry entry;
-    entry.type = LogType::COMMIT;
-    entry.rowId = 0; //为空
-    entry.timestamp = getCurrentTimestamp();
-
-    writeLogEntry(entry);
+    appendRecord(LogType::COMMIT, nullptr, "", 0);
+    activeTransactions.erase(currentTransactionId);
+    currentTransactionId = 0;
+    if (!writerRunning) {
+        flushBuffer();
+    }
+    else if (synchronousCommit) {
+        waitForLsn(lock, nextLsn, true);
+    }
 }
 
 // 记录事务回滚
 void LogManager::logRollback() {
-    std::lock_guard<std::mutex> lock(logMutex);
+    std::lock_guard<std::recursive_mutex> lock(logMutex);
 
     if (!initialized) {
         std::cerr << "LogManager not initialized!" << std::endl;
         return;
     }
 
-    LogEntry entry;
-    entry.type = LogType::ROLLBACK;
-    entry.rowId = 0; //为空
-    entry.timestamp = getCurrentTimestamp();
-
-    writeLogEntry(entry);
+    // 回滚记录不必等待落盘：丢失时恢复会把这个事务当作未完成的事务撤销
+    appendRecord(LogType::ROLLBACK, nullptr, "", 0);
+    activeTransactions.erase(currentTransactionId);
+    currentTransactionId = 0;
+    if (!writerRunning) {
+        flushBuffer();
+    }
 }
 
+uint64_t LogManager::appendRecord(LogType type, const TableSchema* schema, const std::string& tableName,
+    uint64_t rowId, const LogValues* oldValues, const LogValues* newValues, const std::string* payload) {
+    if (writeFailed) {
+        throw std::runtime_error("日志写入磁盘失败，不再接受修改: " + logFilePath);
+    }
+    size_t start = logBuffer.size();
+    logBuffer.resize(start + RECORD_HEADER_SIZE);
+    logBuffer.append(tableName);
+    if (schema && oldValues) encodeValues(logBuffer, *schema, *oldValues);
+    if (schema && newValues) encodeValues(logBuffer, *schema, *newValues);
+    if (payload) logBuffer.append(*payload);
+
+    uint32_t length = static_cast<uint32_t>(logBuffer.size() - start);
+    uint64_t lsn = nextLsn;
+    char* rec = &logBuffer[start];
+    std::memcpy(rec, &length, sizeof(uint32_t));
+    std::memcpy(rec + 8, &lsn, sizeof(uint64_t));
+    std::memcpy(rec + 16, &currentTransactionId, sizeof(uint64_t));
+    std::memcpy(rec + 24, &rowId, sizeof(uint64_t));
+    rec[32] = static_cast<char>(type);
+    rec[33] = 0;
+    uint16_t tableLen = static_cast<uint16_t>(tableName.size());
+    std::memcpy(rec + 34, &tableLen, sizeof(uint16_t));
+    uint32_t crc = crc32c(rec + 8, length - 8);
+    std::memcpy(rec + 4, &crc, sizeof(uint32_t));
+
+    nextLsn += length;
+    if (logBuffer.size() >= LOG_BUFFER_SIZE) {
+        if (writerRunning) {
+            writeRequestLsn = std::max(writeRequestLsn, nextLsn);
+            writerCv.notify_one();
+        }
+        else {
+            flushBuffer();
+        }
+    }
+    return lsn;
+}
 
-
-
-// 写入日志条目
-void LogManager::writeLogEntry(const LogEntry& entry) {
-    if (!logFile.is_open()) {
+void LogManager::flushBuffer() {
+    if (logBuffer.empty()) return;
+    if (!logFile) {
         std::cerr << "Log file not open!" << std::endl;
         return;
     }
+    // 确保写入磁盘；失败时日志文件末尾可能有写了一半的记录，之后不再写入，重启时由解析截掉
+    if (writeFailed || !writeFile(logFile, logBuffer) || !syncFile(logFile)) {
+        writeFailed = true;
+        throw std::runtime_error("日志写入磁盘失败: " + logFilePath);
+    }
+    logBuffer.clear();
+    writtenLsn = durableLsn = nextLsn;
+}
+
+void LogManager::encodeValues(std::string& out, const TableSchema& schema, const LogValues& values) {
+    size_t countPos = out.size();
+    put<uint16_t>(out, 0);
+    uint16_t count = 0;
+    std::string fixed;
+    for (const auto& [name, value] : values) {
+        int ordinal = schema.ordinal(name);
+        if (ordinal < 0) continue;
+        const FieldBlock& field = schema.fields[ordinal];
+        put<uint16_t>(out, static_cast<uint16_t>(ordinal));
+        count++;
+
+        if (value == "NULL") {
+            out.push_back(COLUMN_NULL);
+            continue;
+        }
+        if (field.type != 3) {
+            // 与写入 .trd 走同一套编码：空标记(1) + 数据 + 填充
+            fixed.clear();
+            try {
+                Record::encode_field(fixed, field, value);
+                out.push_back(COLUMN_FIXED);
+                out.append(fixed, 1, Record::get_field_data_size(field.type, field.param));
+                continue;
+            }
+            catch (const std::exception&) {
+                // 按类型编码失败的值原样写入文本
+            }
+        }
+        // VARCHAR 在 .trd 中截断到定义长度，日志中保持一致
+        uint32_t len = static_cast<uint32_t>(field.type == 3 ? std::min<size_t>(value.size(), field.param) : value.size());
+        out.push_back(COLUMN_TEXT);
+        put<uint32_t>(out, len);
+        out.append(value, 0, len);
+    }
+    std::memcpy(&out[countPos], &count, sizeof(uint16_t));
+}
 
-    json j;
-    j["type"] = static_cast<int>(entry.type);  // 然后写入 type
-    j["tableName"] = entry.tableName;
-    j["rowId"] = entry.rowId;
-    // 手动转换 newValues 为 json 对象
-    json j_new;
-    for (const auto& [k, v] : entry.newValues) {
-        j_new[k] = v;
+bool LogManager::decodeValues(const char*& p, const char* end, const TableSchema& schema, LogValues& values) {
+    if (end - p < 2) return false;
+    uint16_t count = load<uint16_t>(p);
+    p += 2;
+    values.reserve(count);
+    for (uint16_t i = 0; i < count; i++) {
+        if (end - p < 3) return false;
+        uint16_t ordinal = load<uint16_t>(p);
+        uint8_t kind = static_cast<uint8_t>(p[2]);
+        p += 3;
+        if (ordinal >= schema.fields.size()) return false;
+        const FieldBlock& field = schema.fields[ordinal];
+
+        if (kind == COLUMN_NULL) {
+            values.emplace_back(field.name, "NULL");
+        }
+        else if (kind == COLUMN_TEXT) {
+            if (end - p < 4) return false;
+            uint32_t len = load<uint32_t>(p);
+            p += 4;
+            if (static_cast<size_t>(end - p) < len) return false;
+            values.emplace_back(field.name, std::string(p, len));
+            p += len;
+        }
+        else {
+            // 解码方式与 Record::decode_row 相同，得到的字符串与读记录时一致
+            size_t size = Record::get_field_data_size(field.type, field.param);
+            if (static_cast<size_t>(end - p) < size) return false;
+            Value value;
+            switch (field.type) {
+            case 1: value = Value::fromInt(load<int>(p)); break;
+            case 2: value = Value::fromDouble(load<double>(p)); break;
+            case 4: value = Value::fromBool(*p == 1); break;
+            case 5: value = Value::fromTime(load<std::time_t>(p)); break;
+            default: return false;
+            }
+            values.emplace_back(field.name, value.toString());
+            p += size;
+        }
     }
-    j["newValues"] = j_new;
+    return true;
+}
 
-    // 手动转换 oldValues 为 json 对象
-    json j_old;
-    for (const auto& [k, v] : entry.oldValues) {
-        j_old[k] = v;
+bool LogManager::createLogFile(uint64_t base) {
+    std::ofstream out(logFilePath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        return false;
     }
-    j["oldValues"] = j_old;
-    j["timestamp"] = entry.timestamp;
+    out.write(LOG_MAGIC, sizeof(LOG_MAGIC));
+    out.write(reinterpret_cast<const char*>(&base), sizeof(uint64_t));
+    return out.good();
+}
 
-    logFile << j.dump() << std::endl;  // 一行一个 JSON 对象
-    logFile.flush();  // 确保写入磁盘
+// 顺序读取日志文件，按块读入后在内存中逐条校验和解析；遇到写了一半或校验失败的记录即停止
+std::vector<LogEntry> LogManager::parseLogFile(uint64_t& validBytes) {
+    std::vector<LogEntry> entries;
+    validBytes = 0;
+
+    std::ifstream inFile(logFilePath, std::ios::binary);
+    if (!inFile.is_open()) {
+        return entries;
+    }
+    char header[FILE_HEADER_SIZE];
+    inFile.read(header, FILE_HEADER_SIZE);
+    if (inFile.gcount() > 0 && header[0] == '{') {
+        inFile.close();
+        return parseLegacyLogFile();
+    }
+    if (inFile.gcount() < static_cast<std::streamsize>(FILE_HEADER_SIZE) ||
+        std::memcmp(header, LOG_MAGIC, sizeof(LOG_MAGIC)) != 0) {
+        return entries;   // 空文件或文件头不完整，重新建立
+    }
+    baseLsn = load<uint64_t>(header + sizeof(LOG_MAGIC));
+    validBytes = FILE_HEADER_SIZE;
+
+    Catalog& catalog = dbManager::getInstance().get_current_database()->getCatalog();
+    std::string buf;
+    size_t pos = 0;
+    bool eof = false;
+    // 保证 buf 中从 pos 开始至少有 need 字节
+    auto fill = [&](size_t need) {
+        if (buf.size() - pos >= need) return true;
+        buf.erase(0, pos);
+        pos = 0;
+        while (buf.size() < need && !eof) {
+            size_t old = buf.size();
+            buf.resize(old + std::max(READ_CHUNK_SIZE, need - old));
+            inFile.read(&buf[old], buf.size() - old);
+            buf.resize(old + static_cast<size_t>(inFile.gcount()));
+            eof = !inFile;
+        }
+        return buf.size() >= need;
+    };
+
+    while (fill(RECORD_HEADER_SIZE)) {
+        uint32_t length = load<uint32_t>(buf.data() + pos);
+        if (length < RECORD_HEADER_SIZE || length > MAX_RECORD_SIZE || !fill(length)) break;
+        const char* rec = buf.data() + pos;
+        if (crc32c(rec + 8, length - 8) != load<uint32_t>(rec + 4)) break;
+
+        LogEntry entry;
+        entry.lsn = load<uint64_t>(rec + 8);
+        if (entry.lsn != baseLsn + (validBytes - FILE_HEADER_SIZE)) break;
+        entry.transactionId = load<uint64_t>(rec + 16);
+        entry.rowId = load<uint64_t>(rec + 24);
+        entry.type = static_cast<LogType>(rec[32]);
+        uint16_t tableLen = load<uint16_t>(rec + 34);
+        if (RECORD_HEADER_SIZE + tableLen > length) break;
+        entry.tableName.assign(rec + RECORD_HEADER_SIZE, tableLen);
+        pos += length;
+        validBytes += length;
+
+        const char* p = rec + RECORD_HEADER_SIZE + tableLen;
+        const char* end = rec + length;
+        if (entry.type == LogType::CHECKPOINT) {
+            // 重做起点(8) + 未结束事务数(4) + 各事务 [事务ID(8) + BEGIN 的 LSN(8)]
+            if (end - p < 12) break;
+            entry.redoLsn = load<uint64_t>(p);
+            uint32_t count = load<uint32_t>(p + 8);
+            p += 12;
+            if (static_cast<size_t>(end - p) < count * 16ull) break;
+            for (uint32_t i = 0; i < count; i++, p += 16) {
+                entry.activeTransactions.push_back(load<uint64_t>(p));
+            }
+        }
+        else if (isDml(entry.type)) {
+            // 表已删除或表结构与日志不符时，这条操作无法重做，跳过
+            auto schema = catalog.find(entry.tableName);
+            if (!schema) continue;
+            if (entry.type != LogType::INSERT && !decodeValues(p, end, *schema, entry.oldValues)) continue;
+            if (entry.type != LogType::DELETE && !decodeValues(p, end, *schema, entry.newValues)) continue;
+        }
+        entries.push_back(std::move(entry));
+    }
+    return entries;
 }
 
-std::vector<LogEntry> LogManager::parseLogFile() {
+// 旧版本的日志每行一个 JSON 对象且没有事务ID，这里按 BEGIN 的出现顺序编号
+std::vector<LogEntry> LogManager::parseLegacyLogFile() {
     std::vector<LogEntry> entries;
     std::ifstream inFile(logFilePath);
     if (!inFile.is_open()) {
         std::cerr << "Failed to open log file for parsing!" << std::endl;
         return entries;
     }
+    uint64_t transactionId = 0;
     std::string line;
     while (std::getline(inFile, line)) {
         if (line.empty()) continue;
@@ -217,7 +673,8 @@ std::vector<LogEntry> LogManager::parseLogFile() {
             entry.type = static_cast<LogType>(j.value("type", 0));
             entry.tableName = j.value("tableName", "");
             entry.rowId = j.value("rowId", 0);
-            entry.timestamp = j.value("timestamp", "");
+            if (entry.type == LogType::BEGIN) transactionId++;
+            entry.transactionId = transactionId;
 
 			// 直接读取 oldValues 和 newValues 为 json 对象，并转换为 std::vector<std::pair<std::string, std::string>>
             if (j.contains("oldValues") && j["oldValues"].is_object()) {
@@ -242,54 +699,327 @@ std::vector<LogEntry> LogManager::parseLogFile() {
     return entries;
 }
 
+// 恢复期间重做操作写回数据页时在本线程直接写日志，因此先停下日志写线程
 void LogManager::recoverFromCrash() {
-    std::vector<LogEntry> logs = parseLogFile();
+    stopWriter();
+    std::vector<LogEntry> entries;
+    {
+        std::lock_guard<std::recursive_mutex> lock(logMutex);
+        flushBuffer();
+        uint64_t validBytes = 0;
+        entries = parseLogFile(validBytes);
+    }
+    recover(entries);
+    startWriter();
+}
+
+void LogManager::createCheckpoint() {
+    // 0. 回收删除标记积累较多的表，回收改动的页随下面的脏页一起写回
+    {
+        std::lock_guard<std::recursive_mutex> lock(logMutex);
+        if (!initialized || checkpointing) return;
+    }
+    Database* current = dbManager::getInstance().get_current_database();
+    if (current && current->getDBName() == dbName) {
+        TransactionManager::instance().reclaimDeleted();
+    }
 
-    std::vector<LogEntry> currentTxn;   // 当前事务日志
-    std::vector<std::vector<LogEntry>> committedTxns; // 所有已提交事务
+    // 1. 记下重做起点和未结束的事务
+    std::string payload;
+    uint64_t redoLsn = 0;
+    {
+        std::lock_guard<std::recursive_mutex> lock(logMutex);
+        if (!initialized || checkpointing) return;
+        checkpointing = true;
+        redoLsn = nextLsn;
+        put<uint64_t>(payload, redoLsn);
+        put<uint32_t>(payload, static_cast<uint32_t>(activeTransactions.size()));
+        for (const auto& [id, beginLsn] : activeTransactions) {
+            put<uint64_t>(payload, id);
+            put<uint64_t>(payload, beginLsn);
+        }
+    }
 
-    for (const auto& log : logs) {
+    // 2. 写回并同步所有脏页，重做起点之前的修改从此都在数据文件中；这期间其他线程可以继续写日志
+    Database* db = dbManager::getInstance().get_current_database();
+    if (!db || db->getDBName() != dbName) {
+        std::lock_guard<std::recursive_mutex> lock(logMutex);
+        checkpointing = false;
+        return;
+    }
+    {
+        try {
+            db->getBufferPool().flushAll();
+            db->getBufferPool().syncFiles();
+        }
+        catch (...) {
+            std::lock_guard<std::recursive_mutex> lock(logMutex);
+            checkpointing = false;
+            throw;
+        }
+    }
+
+    // 3. 写检查点记录并等待落盘
+    uint64_t cutLsn = redoLsn;
+    {
+        std::unique_lock<std::recursive_mutex> lock(logMutex);
+        appendRecord(LogType::CHECKPOINT, nullptr, "", 0, nullptr, nullptr, &payload);
+        if (writerRunning) {
+            waitForLsn(lock, nextLsn, true);
+        }
+        else {
+            flushBuffer();
+        }
+        checkpointEndLsn = nextLsn;
+        lastCheckpointTime = std::chrono::steady_clock::now();
+        for (const auto& [id, beginLsn] : activeTransactions) {
+            cutLsn = std::min(cutLsn, beginLsn);
+        }
+    }
+
+    // 4. 恢复用不到的日志截掉
+    truncateLog(cutLsn);
+    std::lock_guard<std::recursive_mutex> lock(logMutex);
+    checkpointing = false;
+}
+
+bool LogManager::checkpointDue() {
+    std::lock_guard<std::recursive_mutex> lock(logMutex);
+    if (!initialized || checkpointing || writeFailed || nextLsn == checkpointEndLsn) return false;
+    return nextLsn - checkpointEndLsn >= CHECKPOINT_LOG_BYTES ||
+        std::chrono::steady_clock::now() - lastCheckpointTime >= std::chrono::seconds(CHECKPOINT_INTERVAL_SEC);
+}
+
+void LogManager::truncateLog(uint64_t cutLsn) {
+    {
+        std::lock_guard<std::recursive_mutex> lock(logMutex);
+        if (!initialized || writeFailed || cutLsn <= baseLsn) return;
+    }
+    stopWriter();
+    {
+        std::lock_guard<std::recursive_mutex> lock(logMutex);
+        flushBuffer();
+        std::fclose(logFile);
+
+        // 保留的记录复制到临时文件，同步后改名替换原文件，中途崩溃时原文件仍然完整
+        std::string tmpPath = logFilePath + ".tmp";
+        std::ifstream in(logFilePath, std::ios::binary);
+        in.seekg(static_cast<std::streamoff>(FILE_HEADER_SIZE + (cutLsn - baseLsn)));
+        std::FILE* out = std::fopen(tmpPath.c_str(), "wb");
+        bool ok = in.is_open() && out;
+        if (ok) {
+            ok = std::fwrite(LOG_MAGIC, 1, sizeof(LOG_MAGIC), out) == sizeof(LOG_MAGIC) &&
+                std::fwrite(&cutLsn, sizeof(uint64_t), 1, out) == 1;
+            std::vector<char> buf(READ_CHUNK_SIZE);
+            while (ok && (in.read(buf.data(), buf.size()) || in.gcount() > 0)) {
+                size_t got = static_cast<size_t>(in.gcount());
+                ok = std::fwrite(buf.data(), 1, got, out) == got;
+            }
+            ok = ok && !in.bad() && std::fflush(out) == 0 && syncFile(out);
+        }
+        if (out) std::fclose(out);
+        in.close();
+
+        std::error_code ec;
+        if (ok) {
+            std::filesystem::rename(tmpPath, logFilePath, ec);
+            if (!ec) baseLsn = cutLsn;
+        }
+        else {
+            std::filesystem::remove(tmpPath, ec);
+        }
+        logFile = std::fopen(logFilePath.c_str(), "ab");
+    }
+    startWriter();
+}
+
+// 重做最后一个检查点的重做起点之后已提交事务的操作（之前的修改在检查点时已写回数据文件），
+// 撤销既没有提交也没有回滚的事务并为它们补写回滚记录。
+// 检查点截断日志时保留了最早未结束事务的 BEGIN，所以未结束事务的操作都还在日志中
+void LogManager::recover(const std::vector<LogEntry>& entries) {
+    uint64_t redoLsn = 0;
+    std::unordered_set<uint64_t> committed, finished;
+    std::vector<uint64_t> unfinished;
+    for (const auto& log : entries) {
         if (log.type == LogType::BEGIN) {
-            currentTxn.clear();
+            unfinished.push_back(log.transactionId);
         }
         else if (log.type == LogType::COMMIT) {
-            committedTxns.push_back(currentTxn);
-            currentTxn.clear();
+            committed.insert(log.transactionId);
+            finished.insert(log.transactionId);
         }
-        else {
-            currentTxn.push_back(log);
+        else if (log.type == LogType::ROLLBACK) {
+            finished.insert(log.transactionId);
+        }
+        else if (log.type == LogType::CHECKPOINT) {
+            redoLsn = log.redoLsn;
+            unfinished.insert(unfinished.end(), log.activeTransactions.begin(), log.activeTransactions.end());
+        }
+    }
+    std::sort(unfinished.begin(), unfinished.end());
+    unfinished.erase(std::unique(unfinished.begin(), unfinished.end()), unfinished.end());
+    unfinished.erase(std::remove_if(unfinished.begin(), unfinished.end(),
+        [&](uint64_t id) { return finished.count(id) > 0; }), unfinished.end());
+    std::unordered_set<uint64_t> undo(unfinished.begin(), unfinished.end());
+
+    std::vector<LogEntry> redoLogs, undoLogs;
+    for (const auto& log : entries) {
+        if (!isDml(log.type)) continue;
+        if (committed.count(log.transactionId)) {
+            if (log.lsn >= redoLsn) redoLogs.push_back(log);
         }
+        else if (undo.count(log.transactionId)) {
+            undoLogs.push_back(log);
+        }
+    }
+
+    // Redo 检查点之后提交的事务
+    redoOperations(redoLogs);
+
+    // Undo 未提交的事务（如果有）
+    if (!undoLogs.empty()) {
+        undoOperations(undoLogs);
+        // 撤销的修改不写日志，补写回滚记录之前先写回数据页
+        dbManager::getInstance().get_current_database()->getBufferPool().flushAll();
     }
 
-    // Redo 所有已提交事务
-    for (const auto& txn : committedTxns) {
-        redoOperations(txn);
+    // 索引的修改不写日志，崩溃时索引页可能缺项或只写回了一部分：重做起点之后有过修改的表
+    // （包括已回滚的事务修改的表）以及撤销过的表，用恢复后的记录重建全部索引，由恢复之后的检查点写回
+    std::vector<std::string> touched;
+    std::unordered_set<std::string> seen;
+    for (const auto& log : entries) {
+        if (isDml(log.type) && (log.lsn >= redoLsn || undo.count(log.transactionId)) &&
+            seen.insert(log.tableName).second) {
+            touched.push_back(log.tableName);
+        }
+    }
+    Database* db = dbManager::getInstance().get_current_database();
+    for (const auto& name : touched) {
+        if (!db->getCatalog().find(name)) continue;   // 表已删除
+        Table* table = db->getTable(name);
+        if (table && !table->getIndexes().empty()) {
+            table->rebuildIndexes();
+            std::cout << "恢复：已重建表 " << name << " 的索引" << std::endl;
+        }
     }
 
-    // Undo 最后一个未提交事务（如果有）
-    if (!currentTxn.empty()) {
-        undoOperations(currentTxn);
-        logRollback();
+    std::lock_guard<std::recursive_mutex> lock(logMutex);
+    for (uint64_t id : unfinished) {
+        currentTransactionId = id;
+        appendRecord(LogType::ROLLBACK, nullptr, "", 0);
     }
+    currentTransactionId = 0;
+    flushBuffer();
 }
 
-// 执行 redo 操作：将日志中的操作再次执行（用于提交成功的事务）
+// 执行 redo 操作：将日志中的操作再次执行（用于提交成功的事务）。
+// 日志按表分区，各表在工作线程池上并行重做，同一张表内保持 LSN 顺序
 void LogManager::redoOperations(const std::vector<LogEntry>& entries) {
+    if (entries.empty()) return;
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::string> tables;
+    std::vector<std::vector<const LogEntry*>> partitions;
+    std::unordered_map<std::string, size_t> partitionOf;
     for (const auto& log : entries) {
-        Record record;
-        record.set_table_name(log.tableName);
-        if (log.type == LogType::INSERT) {
-            record.insertByRowid(log.rowId, log.newValues);
+        auto [it, added] = partitionOf.emplace(log.tableName, partitions.size());
+        if (added) {
+            tables.push_back(log.tableName);
+            partitions.emplace_back();
         }
-        else if (log.type == LogType::UPDATE) {
-            record.updateByRowid(log.rowId, log.newValues);
+        partitions[it->second].push_back(&log);
+    }
+
+    // 表对象、堆文件在串行阶段取得：数据库中的查找表不是线程安全的，并行阶段只使用取得的对象
+    struct RedoTarget {
+        std::shared_ptr<const TableSchema> schema;
+        Table* table = nullptr;
+        HeapFile* heap = nullptr;
+    };
+    Database* db = dbManager::getInstance().get_current_database();
+    std::vector<RedoTarget> targets(partitions.size());
+    for (size_t i = 0; i < partitions.size(); i++) {
+        targets[i].schema = db->getCatalog().find(tables[i]);
+        if (!targets[i].schema) continue;   // 表已删除
+        targets[i].table = db->getTable(tables[i]);
+        targets[i].heap = &Record::heap_file(tables[i], targets[i].schema->fields);
+    }
+
+    unsigned workers = static_cast<unsigned>(std::min<size_t>(
+        std::max(1u, WorkerPool::maxParallelWorkers()), partitions.size()));
+    std::cout << "恢复：重做 " << entries.size() << " 条日志，涉及 " << partitions.size()
+        << " 张表，使用 " << workers << " 个线程" << std::endl;
+
+    std::mutex progressMutex;
+    size_t doneTables = 0, doneLogs = 0;
+    WorkerPool::instance().runAll(partitions.size(), workers, [&](size_t i) {
+        const RedoTarget& target = targets[i];
+        if (target.heap) {
+            redoTable(*target.schema, *target.heap, *target.table, partitions[i]);
         }
-        else if (log.type == LogType::DELETE) {
-            record.deleteByRowid(log.rowId);
+        std::lock_guard<std::mutex> lock(progressMutex);
+        doneTables++;
+        doneLogs += partitions[i].size();
+        std::cout << "恢复进度：" << doneTables << "/" << partitions.size() << " 张表，"
+            << doneLogs << "/" << entries.size() << " 条日志（" << tables[i] << " 完成）" << std::endl;
+        });
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "重做完成：" << entries.size() << " 条日志，耗时 " << std::fixed << std::setprecision(3) << seconds
+        << " 秒（" << static_cast<uint64_t>(seconds > 0 ? entries.size() / seconds : 0) << " 条/秒）" << std::endl;
+    std::cout.unsetf(std::ios::fixed);
+}
+
+// 在一张表上按顺序重做：与 Record::insertByRowid / updateByRowid / deleteByRowid 的效果相同，
+// 但修改留在缓冲池中，整张表做完后才写回一次
+void LogManager::redoTable(const TableSchema& schema, HeapFile& heap, Table& table,
+    const std::vector<const LogEntry*>& logs) {
+    const std::vector<FieldBlock>& fields = schema.fields;
+    std::unordered_map<std::string, std::string> record;
+    std::string raw;
+    int inserted = 0;
+
+    for (const LogEntry* log : logs) {
+        try {
+            if (log->type == LogType::INSERT) {
+                // 已存在则覆盖
+                record.clear();
+                for (const auto& [col, val] : log->newValues) {
+                    record[col] = val;
+                }
+                bool existed = heap.contains(log->rowId);
+                heap.insertWithRowId(Record::encode_record(log->rowId, 0, fields, record));
+                if (!existed) inserted++;
+            }
+            else if (log->type == LogType::UPDATE) {
+                if (!heap.read(log->rowId, raw)) {
+                    throw std::runtime_error("记录 row_id = " + std::to_string(log->rowId) + " 不存在，无法更新");
+                }
+                uint64_t storedRowId = 0;
+                Record::decode_record(raw.data(), fields, record, storedRowId, /*skip_deleted=*/false);
+                for (const auto& [col, val] : log->newValues) {
+                    record[col] = val;
+                }
+                heap.update(log->rowId, Record::encode_record(log->rowId, raw[HeapFile::DELETE_FLAG_OFFSET], fields, record));
+            }
+            else if (log->type == LogType::DELETE) {
+                char deleteFlag = 1;
+                if (!heap.write(log->rowId, HeapFile::DELETE_FLAG_OFFSET, &deleteFlag, sizeof(char))) {
+                    throw std::runtime_error("记录 row_id = " + std::to_string(log->rowId) + " 不存在，无法删除");
+                }
+            }
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Redo failed at LSN " << log->lsn << ": " << e.what() << std::endl;
         }
     }
-}
 
+    heap.flush();
+    if (inserted > 0) {
+        table.incrementRecordCount(inserted);
+    }
+    table.resetAutoIncrement();
+}
 
 // 执行 undo 操作：将日志中的操作反向撤销（用于未提交的事务）
 void LogManager::undoOperations(const std::vector<LogEntry>& entries) {
@@ -319,189 +1049,13 @@ void LogManager::undoOperations(const std::vector<LogEntry>& entries) {
     }
 }
 
-
-
-void LogManager::recoverUndo() {
-
-}
-
-
-// 从崩溃中恢复
-//bool LogManager::recoverFromCrash() {
-//    std::cout << "Starting crash recovery..." << std::endl;
-//
-//    // 解析日志文件
-//    std::vector<LogEntry> entries = parseLogFile();
-//
-//    if (entries.empty()) {
-//        std::cout << "No log entries found. Nothing to recover." << std::endl;
-//        return true;
-//    }
-//
-//    // 查找最后一个检查点位置
-//    size_t checkpointPos = entries.size();
-//    for (int i = entries.size() - 1; i >= 0; --i) {
-//        if (entries[i].type == LogType::CHECKPOINT) {
-//            checkpointPos = i;
-//            break;
-//        }
-//    }
-//
-//    // 从检查点位置开始恢复
-//    std::cout << "Performing REDO operations..." << std::endl;
-//    redoOperations(std::vector<LogEntry>(entries.begin() + checkpointPos, entries.end()));
-//
-//    // 处理未提交的事务
-//    std::cout << "Performing UNDO operations for uncommitted transactions..." << std::endl;
-//    undoOperations(entries);
-//
-//    std::cout << "Recovery completed successfully." << std::endl;
-//    return true;
-//}
-
-// 执行重做操作
-//void LogManager::redoOperations(const std::vector<LogEntry>& entries) {
-//    // 找出所有已提交的事务
-//    std::set<uint64_t> committedTxns;
-//    for (const auto& entry : entries) {
-//        if (entry.type == LogType::COMMIT) {
-//            committedTxns.insert(entry.transactionId);
-//        }
-//    }
-//
-//    Record record;
-//
-//    // 重做所有已提交事务的操作
-//    for (const auto& entry : entries) {
-//        if (committedTxns.find(entry.transactionId) == committedTxns.end()) {
-//            continue;  // 跳过未提交的事务
-//        }
-//
-//        switch (entry.type) {
-//        case LogType::INSERT:
-//            // 此处应该重做插入操作，但由于没有具体数据，只能示意
-//            std::cout << "REDO: INSERT into " << entry.tableName << " at RowID " << entry.rowId << std::endl;
-//            break;
-//
-//        case LogType::DELETE:
-//            // 重做删除操作
-//            std::cout << "REDO: DELETE from " << entry.tableName << " at RowID " << entry.rowId << std::endl;
-//            record.rollback_delete_by_rowid(entry.tableName, entry.rowId);
-//            break;
-//
-//        case LogType::UPDATE:
-//            // 重做更新操作
-//            if (!entry.newValues.empty()) {
-//                std::cout << "REDO: UPDATE " << entry.tableName << " at RowID " << entry.rowId << std::endl;
-//                record.rollback_update_by_rowid(entry.tableName, { {entry.rowId, entry.newValues} });
-//            }
-//            break;
-//
-//        default:
-//            break;
-//        }
-//    }
-//}
-//
-//// 执行撤销操作
-//void LogManager::undoOperations(const std::vector<LogEntry>& entries) {
-//    // 找出所有未提交的事务
-//    std::unordered_set<uint64_t> uncommittedTxns;
-//    std::unordered_set<uint64_t> allTxns;
-//    std::unordered_set<uint64_t> committedTxns;
-//
-//    for (const auto& entry : entries) {
-//        if (entry.type == LogType::BEGIN) {
-//            allTxns.insert(entry.transactionId);
-//            uncommittedTxns.insert(entry.transactionId);
-//        }
-//        else if (entry.type == LogType::COMMIT) {
-//            uncommittedTxns.erase(entry.transactionId);
-//            committedTxns.insert(entry.transactionId);
-//        }
-//        else if (entry.type == LogType::ROLLBACK) {
-//            uncommittedTxns.erase(entry.transactionId);
-//        }
-//    }
-//
-//    // 按照逆序处理未提交事务的操作
-//    Record record;
-//    std::unordered_map<uint64_t, std::vector<LogEntry>> txnOperations;
-//
-//    // 收集每个未提交事务的操作
-//    for (const auto& entry : entries) {
-//        if (uncommittedTxns.find(entry.transactionId) != uncommittedTxns.end()) {
-//            if (entry.type == LogType::INSERT || entry.type == LogType::DELETE || entry.type == LogType::UPDATE) {
-//                txnOperations[entry.transactionId].push_back(entry);
-//            }
-//        }
-//    }
-//
-//    // 对每个未提交事务执行撤销操作
-//    for (const auto& txnPair : txnOperations) {
-//        uint64_t txId = txnPair.first;
-//        const auto& ops = txnPair.second;
-//
-//        std::cout << "UNDO: Rolling back transaction " << txId << std::endl;
-//
-//        // 逆序遍历操作
-//        for (auto it = ops.rbegin(); it != ops.rend(); ++it) {
-//            const LogEntry& entry = *it;
-//
-//            switch (entry.type) {
-//            case LogType::INSERT:
-//                // 撤销插入 -> 删除
-//                std::cout << "UNDO: Removing inserted row from " << entry.tableName << " at RowID " << entry.rowId << std::endl;
-//                record.rollback_insert_by_rowid(entry.tableName, entry.rowId);
-//                break;
-//
-//            case LogType::DELETE:
-//                // 撤销删除 -> 恢复
-//                std::cout << "UNDO: Restoring deleted row in " << entry.tableName << " at RowID " << entry.rowId << std::endl;
-//                record.rollback_delete_by_rowid(entry.tableName, entry.rowId);
-//                break;
-//
-//            case LogType::UPDATE:
-//                // 撤销更新 -> 恢复旧值
-//                if (!entry.oldValues.empty()) {
-//                    std::cout << "UNDO: Reverting update in " << entry.tableName << " at RowID " << entry.rowId << std::endl;
-//                    record.rollback_update_by_rowid(entry.tableName, { {entry.rowId, entry.oldValues} });
-//                }
-//                break;
-//
-//            default:
-//                break;
-//            }
-//        }
-//
-//        // 记录回滚日志
-//        logRollback(txId);
-//    }
-//}
-
 // 检查系统是否崩溃
 bool LogManager::isSystemCrashed(const std::vector<LogEntry>& entries) {
     if (entries.empty()) {
         return false;
     }
 
-    // 检查最后一条日志
+    // 正常关闭（退出或切换数据库）时最后写一个检查点，此时没有未结束的事务，脏页也已写回
     const LogEntry& lastEntry = entries.back();
-
-    // 只有最后是 COMMIT 或 ROLLBACK 才说明事务正常结束
-    return !(lastEntry.type == LogType::COMMIT || lastEntry.type == LogType::ROLLBACK);
+    return !(lastEntry.type == LogType::CHECKPOINT && lastEntry.activeTransactions.empty());
 }
-
-// 获取当前时间戳
-std::string LogManager::getCurrentTimestamp() {
-    auto now = std::chrono::system_clock::now();
-    auto nowTime = std::chrono::system_clock::to_time_t(now);
-
-    std::tm localTime;
-    localtime_s(&localTime, &nowTime); // 使用 localtime_s 获取线程安全的本地时间
-
-    std::stringstream ss;
-    ss << std::put_time(&localTime, "%Y-%m-%d %H:%M:%S"); // 格式化时间戳
-
-    return ss.str();
-}
\ No newline at end of file
@@ -1,12 +1,16 @@
 // LogManager.h
-//TODO:
 #pragma once
 #include <string>
 #include <fstream>
 #include <vector>
 #include <chrono>
 #include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <atomic>
+#include <cstdio>
 #include <unordered_map>
+#include <map>
 #include <optional>
 #include "transaction/TransactionManager.h"
 #include "manager/dbManager.h"
@@ -18,34 +22,63 @@ enum class LogType {
     UPDATE,         // 更新操作 3
     COMMIT,         // 事务提交 4
     ROLLBACK,       // 事务回滚 5
+    CHECKPOINT,     // 检查点 6
 };
 
-// 日志项结构
+// 一组列值：字段名 -> 值（与记录解码后的字符串形式一致）
+using LogValues = std::vector<std::pair<std::string, std::string>>;
+
+// 日志项结构（解析日志文件得到）
 struct LogEntry {
+    uint64_t lsn = 0;               // 日志序列号：记录在日志流中的字节位置
+    uint64_t transactionId = 0;     // 事务ID
     LogType type;                   // 日志类型
-    //uint64_t transactionId;         // 事务ID
     std::string tableName;          // 表名
-    uint64_t rowId;                 // 行ID
-    std::vector<std::pair<std::string, std::string>> oldValues;  // 旧值
-    std::vector<std::pair<std::string, std::string>> newValues;  // 新值
-    std::string timestamp;          // 时间戳
+    uint64_t rowId = 0;             // 行ID
+    LogValues oldValues;            // 旧值
+    LogValues newValues;            // 新值
+    uint64_t redoLsn = 0;                       // 检查点：恢复从这里开始重做
+    std::vector<uint64_t> activeTransactions;   // 检查点：当时未结束的事务
 };
 
+struct TableSchema;
+class HeapFile;
+class Table;
+
+// 二进制预写日志。文件头为 8 字节魔数 + 8 字节起始 LSN，之后是连续的日志记录：
+//   长度(4) | CRC32C(4) | LSN(8) | 事务ID(8) | 行ID(8) | 类型(1) | 保留(1) | 表名长度(2) | 表名 | 列值...
+// CRC 覆盖 LSN 到记录末尾；列值为 列数(2) + 各列 [字段序号(2) | 种类(1) | 数据]，
+// 定长类型的数据与 .trd 中的字段编码相同，VARCHAR 只写实际长度。
+// 记录先追加到内存中的日志缓冲，由日志写线程成批写入文件并同步到磁盘（fsync）：
+// 提交的事务等待自己的提交记录落盘，同一时间等待的多个提交共用一次同步；
+// 数据页写回磁盘前等待描述它的日志同步到磁盘
 class LogManager {
 public:
     static LogManager& instance();  // 单例模式
 
-    // 初始化日志管理器
-    bool initialize(const std::string& 
-    );
+    // 初始化日志管理器，切换到另一个数据库时先关闭当前的日志
+    bool initialize(const std::string& dbName);
 
-    // 关闭日志管理器
+    // 关闭日志管理器：写出日志缓冲并关闭文件
     void shutdown();
 
+    // 日志缓冲的容量，超过后唤醒日志写线程
+    static constexpr size_t LOG_BUFFER_SIZE = 1 << 20;
+    // 没有提交等待时，日志写线程最多间隔这么久写出一次缓冲
+    static constexpr int WRITER_DELAY_MS = 10;
+
+    // synchronous_commit：开启时（默认）提交等待提交记录同步到磁盘；
+    // 关闭时提交立即返回，崩溃可能丢失最近 WRITER_DELAY_MS 内提交的事务，但不会破坏一致性
+    void setSynchronousCommit(bool on) { synchronousCommit = on; }
+    bool isSynchronousCommit() const { return synchronousCommit; }
+
 
     // 记录DML操作日志
     void logInsert(const std::string& tableName, uint64_t rowId, 
         const std::vector<std::pair<std::string, std::string>>& insertedValues);
+    // 多行插入的日志作为一组写入，只加锁和刷盘一次
+    void logInsertBatch(const std::string& tableName,
+        const std::vector<std::pair<uint64_t, LogValues>>& inserts);
 
     void logDelete(const std::string& tableName, uint64_t rowId,
         const std::vector<std::pair<std::string, std::string>>& values_to_delete); //实际上还未删除，只是把flag=1
@@ -60,8 +93,15 @@ public:
     // 记录事务回滚
     void logRollback();
 
-    // 创建检查点
+    // 创建检查点：回收删除标记积累较多的表，记下重做起点和未结束的事务，把缓冲池中的脏页写回，再写检查点记录。
+    // 写脏页期间不阻止追加日志（模糊检查点）；之后日志中重做起点和最早未结束事务之前的部分被截掉
     void createCheckpoint();
+    // 距上次检查点的日志量或时间是否已超过阈值，由提交时检查
+    bool checkpointDue();
+
+    // 两次检查点之间最多积累的日志量和间隔时间
+    static constexpr uint64_t CHECKPOINT_LOG_BYTES = 16u << 20;
+    static constexpr int CHECKPOINT_INTERVAL_SEC = 300;
 
     // 崩溃恢复
     void recoverFromCrash();
@@ -70,31 +110,73 @@ public:
 
 private:
     LogManager();  // 构造函数私有化
-
-    // 写入日志条目
-    void writeLogEntry(const LogEntry& entry);
-
-    // 从日志文件中解析日志条目
-    std::vector<LogEntry> parseLogFile();
+    ~LogManager();
+
+    // 把一条日志记录追加到日志缓冲，返回它的 LSN；schema 为空时不写列值
+    uint64_t appendRecord(LogType type, const TableSchema* schema, const std::string& tableName, uint64_t rowId,
+        const LogValues* oldValues = nullptr, const LogValues* newValues = nullptr, const std::string* payload = nullptr);
+    // DML 日志追加后调用：此前修改的数据页以当前日志末尾作为写回前要等待的位置
+    void pagesLogged();
+    // 截掉日志文件中 cutLsn 之前的部分：其后的记录复制到新文件再替换原文件
+    void truncateLog(uint64_t cutLsn);
+    // 在调用线程上把日志缓冲写入文件并同步，只在日志写线程未运行时使用；写入或同步失败时抛出异常
+    void flushBuffer();
+    // 请求日志写线程写出（durable 时还要同步）到 lsn 为止的日志，并等待完成；日志写入失败时抛出异常
+    void waitForLsn(std::unique_lock<std::recursive_mutex>& lock, uint64_t lsn, bool durable);
+    // 日志写线程：取走日志缓冲，写入文件后同步，唤醒等待的提交
+    void writerLoop();
+    void startWriter();
+    void stopWriter();
+    // 日志记录的列值编码与解码，解码失败（如表结构与日志不符）返回 false
+    static void encodeValues(std::string& out, const TableSchema& schema, const LogValues& values);
+    static bool decodeValues(const char*& p, const char* end, const TableSchema& schema, LogValues& values);
+
+    // 从日志文件中解析日志条目；validBytes 为最后一条完整记录的结束位置，
+    // 为 0 表示文件为空或是旧版本写的 JSON 行日志，需要重新建立
+    std::vector<LogEntry> parseLogFile(uint64_t& validBytes);
+    // 旧版本写的 JSON 行日志
+    std::vector<LogEntry> parseLegacyLogFile();
+    // 新建只有文件头的日志文件
+    bool createLogFile(uint64_t baseLsn);
+    // 从最后一个检查点的重做起点开始重做已提交的操作，撤销未结束的事务
+    void recover(const std::vector<LogEntry>& entries);
 
     // 执行redo操作
     void redoOperations(const std::vector<LogEntry>& entries);
+    // 重做一张表的日志，logs 按 LSN 排列
+    static void redoTable(const TableSchema& schema, HeapFile& heap, Table& table,
+        const std::vector<const LogEntry*>& logs);
 
     // 执行undo操作
     void undoOperations(const std::vector<LogEntry>& entries);
 
-    void recoverUndo();
-
-    // 获取当前时间戳
-    std::string getCurrentTimestamp();
-
-    // 检查系统是否崩溃
+    // 检查系统是否崩溃：正常关闭时日志以检查点结束
     bool isSystemCrashed(const std::vector<LogEntry>& entries);
 
     std::string dbName;              // 数据库名
     std::string logFilePath;         // 日志文件路径
-    std::ofstream logFile;           // 日志文件流
+    std::FILE* logFile;              // 日志文件
+    std::string logBuffer;           // 尚未写入文件的日志记录
+    std::string writeBuffer;         // 日志写线程正在写出的记录，与 logBuffer 交换使用
+    uint64_t baseLsn;                // 日志文件第一条记录的 LSN
+    uint64_t nextLsn;                // 下一条日志记录的 LSN
+    uint64_t writtenLsn;             // 此前的日志已写入文件
+    uint64_t durableLsn;             // 此前的日志已同步到磁盘
+    uint64_t writeRequestLsn;        // 等待写出到的位置
+    uint64_t syncRequestLsn;         // 等待同步到的位置
+    std::thread writer;              // 日志写线程
+    bool writerRunning;
+    bool writerStopping;
+    bool writeFailed;                // 日志写入或同步失败：之后的提交都失败，不再接受新的日志
+    std::condition_variable_any writerCv;    // 唤醒日志写线程
+    std::condition_variable_any flushedCv;   // 日志写出或同步后唤醒等待者
+    std::atomic<bool> synchronousCommit;
     uint64_t nextTransactionId;      // 下一个事务ID
-    std::mutex logMutex;             // 日志互斥锁，用于多客户端并发
+    uint64_t currentTransactionId;   // 当前事务ID，事务外为 0
+    std::map<uint64_t, uint64_t> activeTransactions;   // 未结束的事务ID -> BEGIN 记录的 LSN
+    uint64_t checkpointEndLsn;       // 上一个检查点记录之后的日志从这里开始
+    std::chrono::steady_clock::time_point lastCheckpointTime;
+    bool checkpointing;              // 正在做检查点，避免重入
+    std::recursive_mutex logMutex;   // 日志互斥锁，用于多客户端并发；恢复时重做操作写回数据页会再次进入
     bool initialized;                // 是否初始化
 };
\ No newline at end of file
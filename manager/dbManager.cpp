@@ -38,7 +38,8 @@ dbManager::dbManager() {
 }
 
 dbManager::~dbManager() {
-    
+    // 程序退出时卸载当前数据库，写回延迟保存的元数据和缓冲池中的脏页
+    unloadCurrentDatabase();
 }
 
 
@@ -288,6 +289,7 @@ void dbManager::useDatabase(const std::string& db_name) {
     }
 
     if (currentDB) {
+        LogManager::instance().createCheckpoint();  // 脏页写回后记下检查点，再次打开时不需要恢复
         delete currentDB;  // 卸载当前数据库
     }
 
@@ -4,6 +4,9 @@
 #include<sstream>
 #include<Windows.h>
 //#include <main.cpp>
+const std::string Parse::SELECT_PATTERN =
+    R"(^SELECT\s+(\*|[\w\s\(\)\*,\.]+)\s+FROM\s+([\w.,]+)((?:\s+JOIN\s+\w+\s+ON\s+[\w.]+\s*=\s*[\w\.]+)+)?(?:\s+WHERE\s+(.+?))?(?:\s+GROUP\s+BY\s+(.+?))?(?:\s+ORDER\s+BY\s+(.+?))?(?:\s+HAVING\s+(.+?))?(?:\s+LIMIT\s+(\d+)(?:\s+OFFSET\s+(\d+))?)?\s*;$)";
+
 Parse::Parse() : outputEdit(nullptr), mainWindow(nullptr), db(nullptr) {
     registerPatterns();
 }
@@ -63,6 +66,9 @@ std::string Parse::executeSQL(const std::string& sql)
         }
 
         // 执行SQL匹配和处理
+        if (matchInsertInto(upperSQL)) {
+            return output.str();
+        }
         for (const auto& p : patterns) {
             std::smatch match;
             if (std::regex_match(upperSQL, match, p.pattern)) {
@@ -173,13 +179,24 @@ void Parse::registerPatterns() {
     /*  DML  */
     //√
     patterns.push_back({
-     std::regex(R"(^INSERT\s+INTO\s+(\w+)\s*(?:\(([^)]+)\))?\s*VALUES\s*(.+);$)", std::regex::icase),
+     std::regex(R"(^INSERT\s+INTO\s+(\w+)\b\s*(?:\(([^)]+)\))?\s*VALUES\b\s*(.+);$)", std::regex::icase),
 
      [this](const std::smatch& m) {
          handleInsertInto(m);
      }
         });
 
+    patterns.push_back({
+    std::regex(R"(^LOAD\s+DATA\s+INFILE\s+'([^']+)'\s+INTO\s+TABLE\s+(\w+)(?:\s+FIELDS\s+TERMINATED\s+BY\s+'(.|\\t)')?(?:\s+IGNORE\s+(\d+)\s+(?:LINES|ROWS))?\s*;$)", std::regex::icase),
+    [this](const std::smatch& m) { handleLoadData(m); }
+        });
+
+    // COPY (SELECT ...) TO '文件' 或 COPY 表 TO '文件'，可选 FORMAT CSV|BINARY 和 HEADER（仅 CSV）
+    patterns.push_back({
+    std::regex(R"(^COPY\s+(?:\((SELECT\s+.+)\)|(\w+))\s+TO\s+'([^']+)'(?:\s+(?:WITH\s+)?FORMAT\s+(CSV|BINARY))?(\s+HEADER)?\s*;$)", std::regex::icase),
+    [this](const std::smatch& m) { handleCopy(m); }
+        });
+
 
 
     //√
@@ -195,6 +212,12 @@ void Parse::registerPatterns() {
         [this](const std::smatch& m) { handleDelete(m); }
         });
 
+    // VACUUM 表; 立即回收表中带删除标记的记录（平时在检查点时按比例自动回收）
+    patterns.push_back({
+        std::regex(R"(^VACUUM\s+(\w+)\s*;$)", std::regex::icase),
+        [this](const std::smatch& m) { handleVacuum(m); }
+        });
+
 
     /*  DQL  */
     //√
@@ -215,12 +238,48 @@ void Parse::registerPatterns() {
         [this](const std::smatch& m) { handleShowTables(m); }
         });
 
+    // SET max_parallel_workers = n; 单个查询并行扫描最多使用的线程数
+    patterns.push_back({
+        std::regex(R"(^SET\s+MAX_PARALLEL_WORKERS\s*(?:=|TO)\s*(\d+)\s*;$)", std::regex::icase),
+        [this](const std::smatch& m) { handleSetParallelWorkers(m); }
+        });
+
+    // SET buffer_pool_size = n [MB]; 缓冲池容量（MB），作用于当前数据库和之后打开的数据库
+    patterns.push_back({
+        std::regex(R"(^SET\s+BUFFER_POOL_SIZE\s*(?:=|TO)\s*(\d+)\s*(?:MB)?\s*;$)", std::regex::icase),
+        [this](const std::smatch& m) { handleSetBufferPoolSize(m); }
+        });
+
+    // CHECKPOINT; 立即做一次检查点并截断日志
+    patterns.push_back({
+        std::regex(R"(^CHECKPOINT\s*;$)", std::regex::icase),
+        [this](const std::smatch& m) { handleCheckpoint(m); }
+        });
+
+    // SET synchronous_commit = on|off; 提交是否等待日志同步到磁盘
+    patterns.push_back({
+        std::regex(R"(^SET\s+SYNCHRONOUS_COMMIT\s*(?:=|TO)\s*(ON|OFF)\s*;$)", std::regex::icase),
+        [this](const std::smatch& m) { handleSetSynchronousCommit(m); }
+        });
+
+    // SHOW BUFFER POOL; 查看缓冲池命中率
+    patterns.push_back({
+        std::regex(R"(^SHOW\s+BUFFER\s+POOL\s*;$)", std::regex::icase),
+        [this](const std::smatch& m) { handleShowBufferPool(m); }
+        });
+
     //√ 
     patterns.push_back({
-    std::regex(R"(^SELECT\s+(\*|[\w\s\(\)\*,\.]+)\s+FROM\s+([\w.,]+)((?:\s+JOIN\s+\w+\s+ON\s+[\w.]+\s*=\s*[\w\.]+)+)?(?:\s+WHERE\s+(.+?))?(?:\s+GROUP\s+BY\s+(.+?))?(?:\s+ORDER\s+BY\s+(.+?))?(?:\s+HAVING\s+(.+?))?\s*;$)", std::regex::icase),
+    std::regex(SELECT_PATTERN, std::regex::icase),
     [this](const std::smatch& m) { handleSelect(m); }
         });
 
+    // EXPLAIN [ANALYZE] SELECT ...; 输出查询计划，ANALYZE 时执行查询并给出各阶段的统计
+    patterns.push_back({
+    std::regex(R"(^EXPLAIN\s+(ANALYZE\s+)?(SELECT\s+.+;)$)", std::regex::icase),
+    [this](const std::smatch& m) { handleExplain(m); }
+        });
+
 
     /*  DCL  */
     //√
@@ -319,6 +378,9 @@ void Parse::execute(const QString& sql_qt) {
     }
 
     // 3. 遍历所有正则模式并匹配
+    if (matchInsertInto(upperSQL)) {
+        return;
+    }
     for (const auto& p : patterns) {
         std::smatch match;
 
@@ -49,6 +49,9 @@ private:
     std::vector<SqlPattern> patterns;
     void registerPatterns();
 
+    // SELECT 语句的正则，EXPLAIN 复用它解析被解释的查询
+    static const std::string SELECT_PATTERN;
+
     //utility
     QString cleanSQL(const QString& sql);//清理sql结构，去除多余空格/制表符等
     
@@ -63,11 +66,20 @@ private:
 
 
     //DQL(查询，显示）
-    void handleSelect(const std::smatch& m);
+    // profile 非空时只输出查询计划（或 EXPLAIN ANALYZE 的各阶段统计），不输出结果行
+    void handleSelect(const std::smatch& m, QueryProfile* profile = nullptr);
+    void handleExplain(const std::smatch& m);
+    // 由 SELECT 的 FROM 和 JOIN ... ON 部分得到参与的表和连接条件，并检查各表的访问权限；失败时已输出错误
+    bool resolveSelectTables(const std::smatch& m, JoinInfo& join_info, bool& use_join_info);
+    // COPY (SELECT ...) | 表 TO '文件' [FORMAT CSV|BINARY] [HEADER]：结果逐行写入文件，不经过输出窗口
+    void handleCopy(const std::smatch& m);
     void handleShowDatabases(const std::smatch& m);
     void handleShowTables(const std::smatch& m);
     void handleSelectDatabase();
     void handleShowColumns(const std::smatch& m);
+    void handleShowBufferPool(const std::smatch& m);
+    void handleSetParallelWorkers(const std::smatch& m);
+    void handleSetBufferPoolSize(const std::smatch& m);
 
     void handleCreateIndex(const std::smatch& m);
     void handleDropIndex(const std::smatch& m);
@@ -93,8 +105,17 @@ private:
 
     //DML
     void handleInsertInto(const std::smatch& m);
+    void insertInto(const std::string& table_name, std::string cols, const std::string& vals);
+    // INSERT 语句在 VALUES 处切开，只对语句头做正则匹配；
+    // 成千上万行的 VALUES 整句匹配时正则递归过深会栈溢出
+    bool matchInsertInto(const std::string& upperSQL);
+    // LOAD DATA INFILE '文件' INTO TABLE 表 [FIELDS TERMINATED BY 'c'] [IGNORE n LINES]
+    void handleLoadData(const std::smatch& m);
     void handleUpdate(const std::smatch& m);
     void handleDelete(const std::smatch& m);
+    void handleVacuum(const std::smatch& m);
+    void handleSetSynchronousCommit(const std::smatch& m);
+    void handleCheckpoint(const std::smatch& m);
 
     //DCL
     void handleUseDatabase(const std::smatch& m);
@@ -1,15 +1,31 @@
 #include "parse/parse.h"
+#include <iomanip>
 
 void Parse::handleInsertInto(const std::smatch& m) {
-    std::string table_name = m[1];
+    insertInto(m[1], m[2], m[3]);
+}
+
+bool Parse::matchInsertInto(const std::string& upperSQL) {
+    // 表名和 VALUES 都要求是完整的单词，表名或列名中含有 VALUES（如 MYVALUES）时不会从中间切开
+    static const std::regex head(R"(^INSERT\s+INTO\s+(\w+)\b\s*(?:\(([^)]+)\))?\s*VALUES\b)", std::regex::icase);
+    if (upperSQL.compare(0, 6, "INSERT") != 0 || upperSQL.back() != ';') return false;
+
+    // 只从语句开头匹配，不在后面成千上万行的值列表中逐位置查找
+    std::smatch m;
+    if (!std::regex_search(upperSQL, m, head, std::regex_constants::match_continuous)) return false;
+    size_t begin = static_cast<size_t>(m.position(0) + m.length(0));
+    insertInto(m[1], m[2], upperSQL.substr(begin, upperSQL.size() - 1 - begin));
+    return true;
+}
+
+void Parse::insertInto(const std::string& table_name, std::string cols, const std::string& vals) {
     std::string dbName = dbManager::getCurrentDBName();
     if (!(user::hasPermission("CONNECT", dbName, table_name) && user::hasPermission("RESOURCE", dbName, table_name))) {
         Output::printError(outputEdit, QString::fromStdString("权限不足，无法向表 " + table_name+ "插入数据。"));
         return;
     }
-    
-    std::string cols = m[2];  // 可为空
-    std::string vals = m[3];  // 可能是多个 (....), (....)
+
+    // cols 可为空；vals 可能是多个 (....), (....)
 
     // 去掉列名部分的括号（如果有）
     auto trimParens = [](std::string& s) {
@@ -44,17 +60,14 @@ void Parse::handleInsertInto(const std::smatch& m) {
             throw std::runtime_error("未检测到有效的 VALUES 数据");
         }
 
-        int count = 0;
+        // 各行作为一批插入：约束全部检查通过后一次写入
+        std::vector<std::string> valueLists;
+        valueLists.reserve(valueBlocks.size());
         for (const std::string& val_block : valueBlocks) {
-            std::string inner = val_block.substr(1, val_block.size() - 2); // 去掉 ()
-            Record r;
-            r.insert_record(table_name, cols, inner);
-            ++count;
-
-            if (count % 1000 == 0) {
-                qDebug() << "已插入" << count << "条...";
-            }
+            valueLists.push_back(val_block.substr(1, val_block.size() - 2)); // 去掉 ()
         }
+        Record r;
+        size_t count = r.insert_records(table_name, cols, valueLists);
 
         Output::printMessage(outputEdit, QString::fromStdString(
             "INSERT INTO 执行成功：已插入 " + std::to_string(count) + " 条记录。"
@@ -66,6 +79,39 @@ void Parse::handleInsertInto(const std::smatch& m) {
 }
 
 
+void Parse::handleLoadData(const std::smatch& m) {
+    std::string file_path = m[1];
+    std::string table_name = m[2];
+    std::string dbName = dbManager::getCurrentDBName();
+    if (!(user::hasPermission("CONNECT", dbName, table_name) && user::hasPermission("RESOURCE", dbName, table_name))) {
+        Output::printError(outputEdit, QString::fromStdString("权限不足，无法向表 " + table_name + "导入数据。"));
+        return;
+    }
+    char delimiter = ',';
+    if (m[3].matched) delimiter = m[3].str() == "\\t" ? '\t' : m[3].str()[0];
+    size_t skip_lines = m[4].matched ? std::stoul(m[4].str()) : 0;
+
+    try {
+        Record r;
+        LoadResult result = r.load_data(table_name, file_path, delimiter, skip_lines);
+        std::ostringstream msg;
+        msg << "LOAD DATA 完成：读取 " << result.lines << " 行，载入 " << result.loaded
+            << " 行，拒绝 " << result.rejected << " 行，耗时 " << std::fixed << std::setprecision(3)
+            << result.seconds << " 秒（" << static_cast<uint64_t>(result.seconds > 0 ? result.loaded / result.seconds : 0)
+            << " 行/秒）。";
+        Output::printMessage(outputEdit, QString::fromStdString(msg.str()));
+        for (const auto& error : result.errors) {
+            Output::printError(outputEdit, QString::fromStdString("拒绝 " + error));
+        }
+        if (result.rejected > result.errors.size()) {
+            Output::printError(outputEdit, QString::fromStdString("其余 " + std::to_string(result.rejected - result.errors.size()) + " 行的拒绝原因未列出。"));
+        }
+    }
+    catch (const std::exception& e) {
+        Output::printError(outputEdit, QString::fromStdString(e.what()));
+    }
+}
+
 
 
 void Parse::handleUpdate(const std::smatch& m) {
@@ -120,3 +166,45 @@ void Parse::handleDelete(const std::smatch& m) {
     }
 }
 
+void Parse::handleVacuum(const std::smatch& m) {
+    std::string table_name = m[1];
+    std::string dbName = dbManager::getCurrentDBName();
+    if (!(user::hasPermission("CONNECT", dbName, table_name) && user::hasPermission("RESOURCE", dbName, table_name))) {
+        Output::printError(outputEdit, QString::fromStdString("权限不足，无法整理表 " + table_name + "。"));
+        return;
+    }
+    // 未提交事务删除的记录也带删除标记，回收后就无法回滚
+    if (TransactionManager::instance().isActive()) {
+        Output::printError(outputEdit, "事务进行中，不能执行 VACUUM");
+        return;
+    }
+
+    try {
+        if (!Record::table_exists(table_name)) {
+            throw std::runtime_error("表 '" + table_name + "' 不存在。");
+        }
+        Record r;
+        int num = r.delete_by_flag(table_name);
+        Output::printMessage(outputEdit, QString::fromStdString("VACUUM 执行成功：已回收" + std::to_string(num) + "条已删除的记录。"));
+    }
+    catch (const std::exception& e) {
+        Output::printError(outputEdit, QString::fromStdString(e.what()));
+    }
+}
+
+
+void Parse::handleSetSynchronousCommit(const std::smatch& m) {
+    bool on = toUpper(m[1].str()) == "ON";
+    LogManager::instance().setSynchronousCommit(on);
+    Output::printMessage(outputEdit, QString("synchronous_commit 已设置为 ") + (on ? "on" : "off"));
+}
+
+void Parse::handleCheckpoint(const std::smatch& m) {
+    try {
+        LogManager::instance().createCheckpoint();
+        Output::printMessage(outputEdit, "检查点完成");
+    }
+    catch (const std::exception& e) {
+        Output::printError(outputEdit, "检查点失败: " + QString::fromStdString(e.what()));
+    }
+}
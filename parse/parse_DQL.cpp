@@ -1,5 +1,9 @@
 #include "parse/parse.h"
 #include <set>
+#include <sstream>
+#include <iomanip>
+#include "base/record/exportWriter.h"
+#include "base/record/workerPool.h"
 // 小写无关字符串比较，返回 true 则相同
 bool iequals(const std::string& a, const std::string& b) {
     return std::equal(a.begin(), a.end(), b.begin(), b.end(),
@@ -8,6 +12,14 @@ bool iequals(const std::string& a, const std::string& b) {
         });
 }
 
+// SELECT_PATTERN 第 8、9 组：LIMIT n [OFFSET m]
+bool limitClause(const std::smatch& m, LimitClause& limit) {
+    if (m.size() <= 8 || !m[8].matched) return false;
+    limit.count = std::stoull(m[8].str());
+    limit.offset = m.size() > 9 && m[9].matched ? std::stoull(m[9].str()) : 0;
+    return true;
+}
+
 void Parse::handleSelectDatabase() {
     try {
         std::string dbName = dbManager::getInstance().get_current_database()->getDBName();
@@ -41,114 +53,188 @@ void Parse::handleShowTables(const std::smatch& m) {
     }
 }
 
-#include <chrono>  // 加头文件
+void Parse::handleShowBufferPool(const std::smatch& m) {
+    try {
+        Database* db = dbManager::getInstance().get_current_database();
+        BufferPool::Stats stats = db->getBufferPool().getStats();
+
+        uint64_t total = stats.hits + stats.misses;
+        double hit_rate = total == 0 ? 0.0 : 100.0 * stats.hits / total;
+
+        std::ostringstream oss;
+        oss << "缓冲池状态（数据库 " << db->getDBName() << "）\n"
+            << "  命中: " << stats.hits << "\n"
+            << "  未命中: " << stats.misses << "\n"
+            << "  命中率: " << std::fixed << std::setprecision(2) << hit_rate << "%\n"
+            << "  淘汰: " << stats.evictions << "\n"
+            << "  写回: " << stats.flushes << "\n"
+            << "  常驻页: " << stats.resident << " / " << stats.capacity
+            << "（" << stats.capacity * BufferPool::PAGE_SIZE / (1024.0 * 1024) << " MB）\n"
+            << "  脏页: " << stats.dirty;
+        Output::printMessage(outputEdit, QString::fromStdString(oss.str()));
+    }
+    catch (const std::exception& e) {
+        Output::printError(outputEdit, "错误: " + QString::fromStdString(e.what()));
+    }
+}
 
-void Parse::handleSelect(const std::smatch& m) {
+void Parse::handleSetParallelWorkers(const std::smatch& m) {
     try {
-        // 开始计时
-        auto start_time = std::chrono::high_resolution_clock::now();
+        unsigned long workers = std::stoul(m[1].str());
+        WorkerPool::setMaxParallelWorkers(static_cast<unsigned>(std::min<unsigned long>(workers, 1u << 16)));
+        Output::printMessage(outputEdit, "max_parallel_workers 已设置为 " +
+            QString::number(WorkerPool::maxParallelWorkers()));
+    }
+    catch (const std::exception& e) {
+        Output::printError(outputEdit, "错误: " + QString::fromStdString(e.what()));
+    }
+}
 
-        std::string columns = m[1];
-        std::string table_part = m[2];
-        std::string join_part;
-        if (m.size() > 3 && m[3].matched) {
-            join_part = m[3].str();
+void Parse::handleSetBufferPoolSize(const std::smatch& m) {
+    try {
+        unsigned long long mb = std::min<unsigned long long>(std::stoull(m[1].str()), 1ull << 20);
+        size_t pages = static_cast<size_t>(mb * 1024 * 1024 / BufferPool::PAGE_SIZE);
+        BufferPool::setDefaultCapacity(pages);
+        if (!dbManager::getCurrentDBName().empty()) {
+            dbManager::getInstance().get_current_database()->getBufferPool().setCapacity(pages);
         }
-        std::string condition, group_by, order_by, having;
-        if (m.size() > 4 && m[4].matched) condition = m[4].str();
-        if (m.size() > 5 && m[5].matched) group_by = m[5].str();
-        if (m.size() > 6 && m[6].matched) order_by = m[6].str();
-        if (m.size() > 7 && m[7].matched) having = m[7].str();
+        size_t capacity = BufferPool::defaultCapacity();
+        Output::printMessage(outputEdit, "buffer_pool_size 已设置为 " +
+            QString::number(capacity * BufferPool::PAGE_SIZE / (1024.0 * 1024)) +
+            " MB（" + QString::number(static_cast<unsigned long long>(capacity)) + " 页）");
+    }
+    catch (const std::exception& e) {
+        Output::printError(outputEdit, "错误: " + QString::fromStdString(e.what()));
+    }
+}
 
-        // 解析 FROM 后面的所有表（初始表）
-        std::vector<std::string> tables;
-        {
-            std::stringstream ss(table_part);
-            std::string table;
-            while (std::getline(ss, table, ',')) {
-                table.erase(0, table.find_first_not_of(" \t"));
-                table.erase(table.find_last_not_of(" \t") + 1);
-                tables.push_back(table);
-            }
+#include <chrono>  // 加头文件
+
+bool Parse::resolveSelectTables(const std::smatch& m, JoinInfo& join_info, bool& use_join_info) {
+    std::string table_part = m[2];
+    std::string join_part;
+    if (m.size() > 3 && m[3].matched) {
+        join_part = m[3].str();
+    }
+
+    // 解析 FROM 后面的所有表（初始表）
+    std::vector<std::string> tables;
+    {
+        std::stringstream ss(table_part);
+        std::string table;
+        while (std::getline(ss, table, ',')) {
+            table.erase(0, table.find_first_not_of(" \t"));
+            table.erase(table.find_last_not_of(" \t") + 1);
+            tables.push_back(table);
         }
+    }
 
-        JoinInfo join_info;
-        join_info.tables = tables; // 初始加入 from 后所有表
+    join_info.tables = tables; // 初始加入 from 后所有表
+    use_join_info = false;
 
-        bool use_join_info = false;
+    // 解析 JOIN ... ON ... 部分
+    if (!join_part.empty()) {
+        use_join_info = true;
+        std::regex join_regex(R"(\s+JOIN\s+(\w+)\s+ON\s+([\w\.]+)\s*=\s*([\w\.]+))", std::regex::icase);
+        std::sregex_iterator it(join_part.begin(), join_part.end(), join_regex), end;
 
-        // 解析 JOIN ... ON ... 部分
-        if (!join_part.empty()) {
-            use_join_info = true;
-            std::regex join_regex(R"(\s+JOIN\s+(\w+)\s+ON\s+([\w\.]+)\s*=\s*([\w\.]+))", std::regex::icase);
-            std::sregex_iterator it(join_part.begin(), join_part.end(), join_regex), end;
+        for (; it != end; ++it) {
+            std::string right_table = (*it)[1];
+            std::string left_field = (*it)[2];
+            std::string right_field = (*it)[3];
 
-            for (; it != end; ++it) {
-                std::string right_table = (*it)[1];
-                std::string left_field = (*it)[2];
-                std::string right_field = (*it)[3];
+            size_t dot_pos1 = left_field.find('.');
+            size_t dot_pos2 = right_field.find('.');
 
-                size_t dot_pos1 = left_field.find('.');
-                size_t dot_pos2 = right_field.find('.');
+            if (dot_pos1 == std::string::npos || dot_pos2 == std::string::npos) {
+                Output::printError(outputEdit, "JOIN ON 子句字段格式错误，必须是表名.字段名");
+                return false;
+            }
 
-                if (dot_pos1 == std::string::npos || dot_pos2 == std::string::npos) {
-                    Output::printError(outputEdit, "JOIN ON 子句字段格式错误，必须是表名.字段名");
-                    return;
-                }
+            std::string left_table = left_field.substr(0, dot_pos1);
+            std::string left_col = left_field.substr(dot_pos1 + 1);
+            std::string right_tab = right_field.substr(0, dot_pos2);
+            std::string right_col = right_field.substr(dot_pos2 + 1);
 
-                std::string left_table = left_field.substr(0, dot_pos1);
-                std::string left_col = left_field.substr(dot_pos1 + 1);
-                std::string right_tab = right_field.substr(0, dot_pos2);
-                std::string right_col = right_field.substr(dot_pos2 + 1);
-
-                // 检查如果 right_table 没有在 tables 中，则补充进去
-                bool exists_r = false;
-                for (const auto& t : join_info.tables) {
-                    if (iequals(t, right_table)) {
-                        exists_r = true;
-                        break;
-                    }
+            // 检查如果 right_table 没有在 tables 中，则补充进去
+            bool exists_r = false;
+            for (const auto& t : join_info.tables) {
+                if (iequals(t, right_table)) {
+                    exists_r = true;
+                    break;
                 }
-                if (!exists_r) join_info.tables.push_back(right_table);
+            }
+            if (!exists_r) join_info.tables.push_back(right_table);
 
-                // 加入一组 JoinPair
-                JoinPair jp;
-                jp.left_table = left_table;
-                jp.right_table = right_tab;
-                jp.conditions.push_back({ left_col, right_col });
+            // 加入一组 JoinPair
+            JoinPair jp;
+            jp.left_table = left_table;
+            jp.right_table = right_tab;
+            jp.conditions.push_back({ left_col, right_col });
 
-                join_info.joins.push_back(jp);
-            }
+            join_info.joins.push_back(jp);
         }
+    }
 
-        if (join_info.tables.size() > 1) {
-            use_join_info = true;
-        }
+    if (join_info.tables.size() > 1) {
+        use_join_info = true;
+    }
 
-        // --- 权限检查：所有参与表必须有 CONNECT 权限 ---
-        std::string dbName = dbManager::getInstance().get_current_database()->getDBName();
-        for (const auto& tableName : join_info.tables) {
-            if (!user::hasPermission("CONNECT", dbName, tableName)) {
-                Output::printError(outputEdit, QString::fromStdString("没有权限访问表 " + tableName + "，查询被拒绝"));
-                return;
-            }
+    // --- 权限检查：所有参与表必须有 CONNECT 权限 ---
+    std::string dbName = dbManager::getInstance().get_current_database()->getDBName();
+    for (const auto& tableName : join_info.tables) {
+        if (!user::hasPermission("CONNECT", dbName, tableName)) {
+            Output::printError(outputEdit, QString::fromStdString("没有权限访问表 " + tableName + "，查询被拒绝"));
+            return false;
         }
+    }
+    return true;
+}
 
+void Parse::handleSelect(const std::smatch& m, QueryProfile* profile) {
+    try {
+        // 开始计时
+        auto start_time = std::chrono::high_resolution_clock::now();
 
-        std::vector<Record> records;
-        if (use_join_info) {
-            records = Record::select(columns, join_info.tables[0], condition, group_by, order_by, having, &join_info);
-        }
-        else {
-            records = Record::select(columns, join_info.tables[0], condition, group_by, order_by, having, nullptr);
+        std::string columns = m[1];
+        std::string condition, group_by, order_by, having;
+        if (m.size() > 4 && m[4].matched) condition = m[4].str();
+        if (m.size() > 5 && m[5].matched) group_by = m[5].str();
+        if (m.size() > 6 && m[6].matched) order_by = m[6].str();
+        if (m.size() > 7 && m[7].matched) having = m[7].str();
+
+        JoinInfo join_info;
+        bool use_join_info = false;
+        if (!resolveSelectTables(m, join_info, use_join_info)) return;
+
+        const JoinInfo* joins = use_join_info ? &join_info : nullptr;
+        LimitClause limit_clause;
+        const LimitClause* limit = limitClause(m, limit_clause) ? &limit_clause : nullptr;
+        auto elapsed_ms = [&]() {
+            auto end_time = std::chrono::high_resolution_clock::now();
+            auto duration_micro = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+            return duration_micro / 1000.0;  // 微秒转毫秒，保留小数
+        };
+
+        if (profile) {
+            Record::select(columns, join_info.tables[0], condition, group_by, order_by, having, joins, limit, profile);
+            Output::printSelectResult(outputEdit, profile->toResultSet(), elapsed_ms());
+            return;
         }
-        // 结束计时
-        auto end_time = std::chrono::high_resolution_clock::now();
-        auto duration_micro = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
-        double duration_milli = duration_micro / 1000.0;  // 微秒转毫秒，保留小数
 
-        if (!records.empty()) {
-            Output::printSelectResult(outputEdit, records,duration_milli);
+        // 结果按批到达就输出，不等整个查询结束
+        std::vector<std::string> result_columns;
+        size_t row_count = 0;
+        Record::select_each(columns, join_info.tables[0], condition, group_by, order_by, having, joins, limit,
+            [&](const RowSchema& schema) { result_columns = schema.names; },
+            [&](const RowBatch& batch) {
+                Output::printSelectRows(outputEdit, result_columns, batch, row_count == 0);
+                row_count += batch.size();
+                return true;
+            });
+
+        if (row_count > 0) {
+            Output::printSelectEnd(outputEdit, row_count, elapsed_ms());
         }
         else {
             Table* table = dbManager::getInstance().get_current_database()->getTable(join_info.tables[0]);
@@ -160,3 +246,66 @@ void Parse::handleSelect(const std::smatch& m) {
         Output::printError(outputEdit, "查询失败: " + QString::fromStdString(e.what()));
     }
 }
+
+void Parse::handleExplain(const std::smatch& m) {
+    QueryProfile profile(m[1].matched);
+    std::string select = m[2];
+
+    std::smatch select_match;
+    if (!std::regex_match(select, select_match, std::regex(SELECT_PATTERN, std::regex::icase))) {
+        Output::printError(outputEdit, "EXPLAIN 只支持 SELECT 语句");
+        return;
+    }
+    handleSelect(select_match, &profile);
+}
+
+void Parse::handleCopy(const std::smatch& m) {
+    std::string select = m[1].matched ? m[1].str() + ";" : "SELECT * FROM " + m[2].str() + ";";
+    std::string file_path = m[3];
+    ExportFormat format = m[4].matched && m[4].str() == "BINARY" ? ExportFormat::BINARY : ExportFormat::CSV;
+    bool header = m[5].matched;
+
+    std::smatch select_match;
+    if (!std::regex_match(select, select_match, std::regex(SELECT_PATTERN, std::regex::icase))) {
+        Output::printError(outputEdit, "COPY 只支持 SELECT 查询");
+        return;
+    }
+
+    try {
+        auto start_time = std::chrono::steady_clock::now();
+        std::string columns = select_match[1];
+        std::string condition, group_by, order_by, having;
+        if (select_match[4].matched) condition = select_match[4].str();
+        if (select_match[5].matched) group_by = select_match[5].str();
+        if (select_match[6].matched) order_by = select_match[6].str();
+        if (select_match[7].matched) having = select_match[7].str();
+
+        JoinInfo join_info;
+        bool use_join_info = false;
+        if (!resolveSelectTables(select_match, join_info, use_join_info)) return;
+
+        LimitClause limit;
+        bool has_limit = limitClause(select_match, limit);
+
+        // 行从扫描直接进入写出缓冲，结果集不在内存中物化
+        std::unique_ptr<ExportWriter> writer;
+        Record::select_each(columns, join_info.tables[0], condition, group_by, order_by, having,
+            use_join_info ? &join_info : nullptr, has_limit ? &limit : nullptr,
+            [&](const RowSchema& schema) { writer = ExportWriter::open(file_path, format, schema, header); },
+            [&](const RowBatch& batch) {
+                for (const auto& row : batch) writer->write(row);
+                return true;
+            });
+        writer->close();
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        std::ostringstream msg;
+        msg << "COPY 完成：导出 " << writer->rows() << " 行到 " << file_path << "（"
+            << writer->bytes() << " 字节），耗时 " << std::fixed << std::setprecision(3) << seconds << " 秒（"
+            << static_cast<uint64_t>(seconds > 0 ? writer->rows() / seconds : 0) << " 行/秒）。";
+        Output::printMessage(outputEdit, QString::fromStdString(msg.str()));
+    }
+    catch (const std::exception& e) {
+        Output::printError(outputEdit, "导出失败: " + QString::fromStdString(e.what()));
+    }
+}
@@ -21,27 +21,36 @@ void TransactionManager::begin() {
 }
 
 void TransactionManager::commit() {
-    
-    std::unordered_set<std::string> affectedTables;
-    for (const auto& op : undoStack) {
-        affectedTables.insert(op.tableName);
-    }
+    // 提交只写提交日志（刷盘后即持久），被删除的记录保留删除标记，不在提交时改写表文件；
+    // 标记删除的记录积累到一定比例后由检查点统一回收，提交耗时只与事务本身的大小有关
+    LogManager::instance().logCommit();
 
-    Record record;
-    for (const auto& table_name : affectedTables) {
-        record.delete_by_flag(table_name);  // 删除 delete_flag == 1 的记录
+    std::unordered_map<std::string, int> deletedRows;
+    for (const auto& op : undoStack) {
+        deletedRows[op.tableName] += op.type == DmlType::DELETE ? 1 : 0;
     }
-	
 
     active = false;
     autoCommit = lastAutoCommit.value();
-    undoStack.clear();  // 提交事务时清空UNDO栈;将标识为1的数据真正删除
-    LogManager::instance().logCommit();  // 记录事务开始日志
+    undoStack.clear();  // 提交事务时清空UNDO栈
+
+    Database* db = dbManager::getInstance().get_current_database();
+    for (const auto& [table_name, count] : deletedRows) {
+        if (count == 0 || !Record::table_exists(table_name)) continue;   // 事务中已删除的表
+        db->getTable(table_name)->incrementRecordCount(-count);
+        vacuumCandidates.insert(table_name);
+    }
+
+    // 日志积累到一定量后做检查点，限制崩溃恢复要重做的日志
+    if (LogManager::instance().checkpointDue()) {
+        LogManager::instance().createCheckpoint();
+    }
 }
 
 int TransactionManager::rollback() {
     // 遍历undoStack逆序回滚
     int rollback_count = 0;
+    std::unordered_map<std::string, int> rangeRows;  // 各表按范围删除的行数
     for (auto it = undoStack.rbegin(); it != undoStack.rend(); ++it) {
         const UndoOperation& op = *it;
         Record record;
@@ -67,17 +76,35 @@ int TransactionManager::rollback() {
 			rollback_count += affectedRows;
             break;
         }
+        case DmlType::INSERT_RANGE:
+        {
+            // 批量导入的行直接释放槽位，索引在最后按回滚后的表重建
+            int affectedRows = record.rollback_insert_range(op.tableName, op.rowId, op.rowCount);
+            rangeRows[op.tableName] += affectedRows;
+            rollback_count += affectedRows;
+            break;
+        }
         }
     }
 
-    std::unordered_set<std::string> affectedTables;
+    // 回滚的插入带着删除标记，它们的索引项要立即删除，因此回收受影响的表中所有带标记的记录
+    std::unordered_map<std::string, int> insertedRows;
     for (const auto& op : undoStack) {
-        affectedTables.insert(op.tableName);
+        insertedRows[op.tableName] += op.type == DmlType::INSERT ? 1 : 0;
     }
 
+    Database* db = dbManager::getInstance().get_current_database();
     Record record;
-    for (const auto& table_name : affectedTables) {
-        record.delete_by_flag(table_name);  // 删除 delete_flag == 1 的记录
+    for (const auto& [table_name, count] : insertedRows) {
+        if (!Record::table_exists(table_name)) continue;
+        Table* table = db->getTable(table_name);
+        auto range = rangeRows.find(table_name);
+        int removed = count + (range != rangeRows.end() ? range->second : 0);
+        if (removed > 0) table->incrementRecordCount(-removed);
+        record.delete_by_flag(table_name);  // 回收 delete_flag == 1 的记录
+        if (range != rangeRows.end()) table->rebuildIndexes();
+        // 撤销的修改不写日志：回滚记录之前先写回，回滚记录落盘后恢复时不再撤销这个事务
+        Record::heap_file(table_name, db->getTable(table_name)->getFields()).flush();
     }
 
     undoStack.clear();  // 完成回滚，清空UNDO栈
@@ -88,6 +115,18 @@ int TransactionManager::rollback() {
 	return rollback_count;  // 返回回滚的记录数
 }
 
+void TransactionManager::reclaimDeleted() {
+    // 未提交事务删除的记录也带删除标记，回收后就无法回滚
+    if (active) return;
+    Record record;
+    for (const auto& table_name : vacuumCandidates) {
+        if (Record::table_exists(table_name) && Record::needs_vacuum(table_name)) {
+            record.delete_by_flag(table_name);  // 回收 delete_flag == 1 的记录
+        }
+    }
+    vacuumCandidates.clear();
+}
+
 void TransactionManager::beginImplicitTransaction() {
     if (autoCommit && !active) {
         begin(); //因为复用，所以会把autoCommit设为false;
@@ -119,6 +158,27 @@ void TransactionManager::addUndo(DmlType type, const std::string& tableName, uin
     //commitImplicitTransaction();
 }
 
+void TransactionManager::addInsertRange(const std::string& tableName, uint64_t firstRowId, uint64_t count) {
+    beginImplicitTransaction();
+    if (!active || count == 0) return;
+
+    if (!undoStack.empty()) {
+        UndoOperation& last = undoStack.back();
+        if (last.type == DmlType::INSERT_RANGE && last.tableName == tableName && last.rowId + last.rowCount == firstRowId) {
+            last.rowCount += count;
+            return;
+        }
+    }
+
+    UndoOperation op;
+    op.type = DmlType::INSERT_RANGE;
+    op.tableName = tableName;
+    op.rowId = firstRowId;
+    op.rowCount = count;
+
+    undoStack.push_back(op);
+}
+
 void TransactionManager::addUndo(DmlType type, const std::string& tableName, uint64_t rowId,
     const std::vector<std::pair<std::string, std::string>>& oldValues) {
     beginImplicitTransaction();
@@ -4,6 +4,7 @@
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <stdexcept>
 #include"base/record/Record.h"
 #include"manager/dbManager.h"
@@ -13,13 +14,15 @@
 enum class DmlType {
     INSERT,
     DELETE,
-    UPDATE
+    UPDATE,
+    INSERT_RANGE    // 批量导入：从 rowId 起连续的 rowCount 行
 };
 
 struct UndoOperation {
     DmlType type;
     std::string tableName;
     uint64_t rowId;  // 改为 uint64_t
+    uint64_t rowCount = 1;  // INSERT_RANGE 的行数
     std::vector<std::pair<std::string, std::string>> oldValues;
 };
 
@@ -39,12 +42,17 @@ public:
     void addUndo(DmlType type, const std::string& tableName, uint64_t rowId, const std::vector<std::pair<std::string, std::string>>& oldValues);
     
     void addUndo(DmlType type, const std::string& tableName, uint64_t rowId);//对于INSERT和DELETE操作
+    // 批量导入的连续 row_id 只记一项，与上一项相接时合并；回滚时一次删除这些行，再重建表的索引
+    void addInsertRange(const std::string& tableName, uint64_t firstRowId, uint64_t count);
 
     bool isActive() const;  // 判断事务是否正在进行
 	bool isAutoCommit() const;  // 判断是否启用自动提交
 
     void setAutoCommit(bool flag);
 
+    // 回收提交后积累了足够多删除标记的表，由检查点在事务之外调用，不占用提交的时间
+    void reclaimDeleted();
+
     //uint64_t getTransactionId() const; // 
 
    
@@ -54,6 +62,7 @@ private:
     bool autoCommit;  // 是否启用自动提交
     std::optional<bool> lastAutoCommit;
     std::vector<UndoOperation> undoStack;  // 存储UNDO操作
+    std::unordered_set<std::string> vacuumCandidates;  // 提交过删除、还没有检查是否该回收的表
    
    // uint64_t transactionId;      // 当前事务ID
     //static uint64_t nextTransactionId; // 静态ID生成器
@@ -1,8 +1,10 @@
 #include "output.h"
 #include <QDateTime>
+#include <QCoreApplication>
 #include <iostream>
 int Output::mode = 1; // 默认为GUI模式
 std::ostream* Output::outputStream = nullptr;
+std::vector<size_t> Output::streamWidths;
 
 // 获取当前时间戳字符串
 static QString currentTimestamp() {
@@ -12,11 +14,11 @@ static QString currentTimestamp() {
 // GUI 模式输出函数
 //===========================================
 
-void Output::printSelectResult(QTextEdit* outputEdit, const std::vector<Record>& results, double duration_ms) {
+void Output::printSelectResult(QTextEdit* outputEdit, const ResultSet& results, double duration_ms) {
     if (mode == 0) printSelectResult_Cli(results,duration_ms);
     if (!outputEdit) return;
    
-    const auto& columns = results[0].get_columns();
+    const auto& columns = results.columns;
 
     QString html;
     html += "<style>"
@@ -36,11 +38,10 @@ void Output::printSelectResult(QTextEdit* outputEdit, const std::vector<Record>&
     html += "</tr>";
 
     // 数据行
-    for (const auto& record : results) {
-        const auto& values = record.get_values();
+    for (const auto& row : results.rows) {
         html += "<tr>";
-        for (const auto& val : values) {
-            html += "<td>" + QString::fromStdString(val) + "</td>";
+        for (const auto& val : row.values) {
+            html += "<td>" + QString::fromStdString(val.toString()) + "</td>";
         }
         html += "</tr>";
     }
@@ -53,6 +54,50 @@ void Output::printSelectResult(QTextEdit* outputEdit, const std::vector<Record>&
     outputEdit->append(""); // 添加空行
 }
 
+void Output::printSelectRows(QTextEdit* outputEdit, const std::vector<std::string>& columns,
+    const std::vector<Row>& rows, bool first) {
+    if (mode == 0) printSelectRows_Cli(columns, rows, first);
+    if (!outputEdit) return;
+
+    QString html;
+    if (first) {
+        html += "<style>"
+            "table { border-collapse: collapse; width: 100%; font-family: Consolas, monospace; }"
+            "th, td { border: 1px solid #888; padding: 6px 10px; text-align: left; }"
+            "th { background-color: #f0f0f0; }"
+            "tr:nth-child(even) { background-color: #fafafa; }"
+            "</style>";
+    }
+    html += "<table>";
+    if (first) {
+        html += "<tr>";
+        for (const auto& col : columns) {
+            html += "<th>" + QString::fromStdString(col) + "</th>";
+        }
+        html += "</tr>";
+    }
+    for (const auto& row : rows) {
+        html += "<tr>";
+        for (const auto& val : row.values) {
+            html += "<td>" + QString::fromStdString(val.toString()) + "</td>";
+        }
+        html += "</tr>";
+    }
+    html += "</table>";
+
+    if (first) outputEdit->append(currentTimestamp() + "查询结果：");
+    outputEdit->append(html);
+    // 让界面在查询继续执行时先显示已到达的行
+    QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+}
+
+void Output::printSelectEnd(QTextEdit* outputEdit, size_t row_count, double duration_ms) {
+    if (mode == 0) printSelectEnd_Cli(row_count, duration_ms);
+    if (!outputEdit) return;
+    outputEdit->append("共 " + QString::number(row_count) + " 行，查询耗时：" + QString::number(duration_ms) + " ms");
+    outputEdit->append(""); // 添加空行
+}
+
 void Output::printMessage(QTextEdit* outputEdit, const QString& message) {
     if (mode == 0) printMessage_Cli(message.toStdString());
     if (!outputEdit) return;
@@ -216,21 +261,30 @@ void Output::printSelectResultEmpty_Cli(const std::vector<std::string>& cols) {
 }
 
 // CLI Select 输出
-void Output::printSelectResult_Cli(const std::vector<Record>& results, double duration_ms) {
+void Output::printSelectResult_Cli(const ResultSet& results, double duration_ms) {
     if (!outputStream || results.empty()) return;
 
-    const auto& columns = results[0].get_columns();
-    const int col_count = columns.size();
+    const auto& columns = results.columns;
+    const size_t col_count = columns.size();
 
     std::vector<size_t> col_widths(col_count);
     for (size_t i = 0; i < col_count; ++i) {
         col_widths[i] = columns[i].size();
     }
 
+    // 值只在输出时转换为字符串
+    std::vector<std::vector<std::string>> text_rows;
+    text_rows.reserve(results.size());
+    for (const auto& row : results.rows) {
+        std::vector<std::string> values;
+        values.reserve(row.values.size());
+        for (const auto& val : row.values) values.push_back(val.toString());
+        text_rows.push_back(std::move(values));
+    }
+
     // 计算每列最大宽度
-    for (const auto& record : results) {
-        const auto& values = record.get_values();
-        for (size_t i = 0; i < values.size(); ++i) {
+    for (const auto& values : text_rows) {
+        for (size_t i = 0; i < values.size() && i < col_count; ++i) {
             col_widths[i] = std::max(col_widths[i], values[i].size());
         }
     }
@@ -250,10 +304,9 @@ void Output::printSelectResult_Cli(const std::vector<Record>& results, double du
     *outputStream << std::endl << line << std::endl;
 
     // 打印数据行
-    for (const auto& record : results) {
-        const auto& values = record.get_values();
+    for (const auto& values : text_rows) {
         *outputStream << "| ";
-        for (size_t i = 0; i < values.size(); ++i) {
+        for (size_t i = 0; i < values.size() && i < col_count; ++i) {
             *outputStream << std::left << std::setw(col_widths[i] + 1) << values[i] << "| ";
         }
         *outputStream << std::endl;
@@ -263,3 +316,50 @@ void Output::printSelectResult_Cli(const std::vector<Record>& results, double du
     *outputStream << "查询耗时：" << duration_ms << " ms" << std::endl << std::endl;
 }
 
+void Output::printSelectRows_Cli(const std::vector<std::string>& columns, const std::vector<Row>& rows, bool first) {
+    if (!outputStream) return;
+    const size_t col_count = columns.size();
+
+    if (first) {
+        // 列宽按表头和第一批行确定，之后更宽的值直接撑开该格
+        streamWidths.assign(col_count, 0);
+        for (size_t i = 0; i < col_count; ++i) {
+            streamWidths[i] = columns[i].size();
+        }
+        for (const auto& row : rows) {
+            for (size_t i = 0; i < row.values.size() && i < col_count; ++i) {
+                streamWidths[i] = std::max(streamWidths[i], row.values[i].toString().size());
+            }
+        }
+
+        *outputStream << currentTimestamp().toStdString() + "查询结果：" << std::endl;
+        std::string line = "+";
+        for (const auto& width : streamWidths) {
+            line += std::string(width + 2, '-') + "+";
+        }
+        *outputStream << line << std::endl << "| ";
+        for (size_t i = 0; i < col_count; ++i) {
+            *outputStream << std::left << std::setw(streamWidths[i] + 1) << columns[i] << "| ";
+        }
+        *outputStream << std::endl << line << std::endl;
+    }
+
+    for (const auto& row : rows) {
+        *outputStream << "| ";
+        for (size_t i = 0; i < row.values.size() && i < col_count; ++i) {
+            *outputStream << std::left << std::setw(streamWidths[i] + 1) << row.values[i].toString() << "| ";
+        }
+        *outputStream << '\n';
+    }
+    outputStream->flush();
+}
+
+void Output::printSelectEnd_Cli(size_t row_count, double duration_ms) {
+    if (!outputStream) return;
+    std::string line = "+";
+    for (const auto& width : streamWidths) {
+        line += std::string(width + 2, '-') + "+";
+    }
+    *outputStream << line << std::endl;
+    *outputStream << "共 " << row_count << " 行，查询耗时：" << duration_ms << " ms" << std::endl << std::endl;
+}
@@ -9,7 +9,12 @@ class Output {
 public:
     // 打印 SELECT 查询结果
 	static void printSelectResultEmpty(QTextEdit* outputEdit,const std::vector<std::string> &cols);
-    static void printSelectResult(QTextEdit* outputEdit, const std::vector<Record>& results, double duration_ms);
+    static void printSelectResult(QTextEdit* outputEdit, const ResultSet& results, double duration_ms);
+    // 流式输出 SELECT 结果：first 为 true 时先输出表头，之后各批直接追加，最后由 printSelectEnd 输出耗时；
+    // 每批行到达就显示，不等查询结束
+    static void printSelectRows(QTextEdit* outputEdit, const std::vector<std::string>& columns,
+        const std::vector<Row>& rows, bool first);
+    static void printSelectEnd(QTextEdit* outputEdit, size_t row_count, double duration_ms);
     static void printDatabaseList(QTextEdit* outputEdit, const std::vector<std::string>& dbs);
     static void printTableList(QTextEdit* outputEdit, const std::vector<std::string>& tables);
 
@@ -28,11 +33,17 @@ public:
     static void printDatabaseList_Cli(const std::vector<std::string>& dbs);
     static void printTableList_Cli(const std::vector<std::string>& tables);
     static void printSelectResultEmpty_Cli(const std::vector<std::string>& cols);
-    static void printSelectResult_Cli(const std::vector<Record>& results, double duration_ms);
+    static void printSelectResult_Cli(const ResultSet& results, double duration_ms);
+    static void printSelectRows_Cli(const std::vector<std::string>& columns, const std::vector<Row>& rows, bool first);
+    static void printSelectEnd_Cli(size_t row_count, double duration_ms);
     
     //当前模式
     static  int mode; 
     static std::ostream* outputStream;
+
+private:
+    // 流式输出时各列的宽度，按表头和第一批行确定
+    static std::vector<size_t> streamWidths;
  
 };
    